@@ -0,0 +1,194 @@
+/**
+ * @file aligned_allocator.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Allocators of the numeric containers
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+#include "types.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Allocator returning memory aligned on Alignment bytes (a cache line by default),
+ * so that vector loads of the first elements never straddle two cache lines
+ */
+template<class T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+public:
+  typedef T value_type;
+
+  template<class U>
+  struct rebind
+  {
+    typedef AlignedAllocator<U, Alignment> other;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template<class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+  T* allocate(const std::size_t n)
+  {
+    return static_cast<T*>(allocate_bytes(n * sizeof(T), Alignment));
+  }
+
+  void deallocate(T* pointer, std::size_t) noexcept
+  {
+    std::free(pointer);
+  }
+
+private:
+  static void* allocate_bytes(const std::size_t bytes, const std::size_t alignment)
+  {
+    if (bytes == 0) { return nullptr; }
+    void* pointer = nullptr;
+    if (posix_memalign(&pointer, alignment, bytes) != 0)
+    {
+      throw std::bad_alloc();
+    }
+    return pointer;
+  }
+};
+
+template<class T, class U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept
+{
+  return true;
+}
+
+template<class T, class U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept
+{
+  return false;
+}
+
+/**
+ * @brief Aligned allocator leaving the values default initialized, which leaves the scalars uninitialized
+ *
+ * The pages of a large scratch buffer are then first touched by the threads which fill it rather than
+ * by the allocating thread: they are placed on the NUMA nodes of the threads using them.
+ */
+template<class T, std::size_t Alignment = 64>
+class UninitializedAllocator : public AlignedAllocator<T, Alignment>
+{
+public:
+  template<class U>
+  struct rebind
+  {
+    typedef UninitializedAllocator<U, Alignment> other;
+  };
+
+  UninitializedAllocator() noexcept = default;
+  template<class U>
+  UninitializedAllocator(const UninitializedAllocator<U, Alignment>&) noexcept {}
+
+  template<class U>
+  void construct(U* pointer)
+  {
+    ::new(static_cast<void*>(pointer)) U;
+  }
+
+  template<class U, class... Args>
+  void construct(U* pointer, Args&&... args)
+  {
+    ::new(static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+  }
+};
+
+template<class T, class U, std::size_t Alignment>
+bool operator==(const UninitializedAllocator<T, Alignment>&, const UninitializedAllocator<U, Alignment>&) noexcept
+{
+  return true;
+}
+
+template<class T, class U, std::size_t Alignment>
+bool operator!=(const UninitializedAllocator<T, Alignment>&, const UninitializedAllocator<U, Alignment>&) noexcept
+{
+  return false;
+}
+
+/**
+ * @brief Allocator of the large precomputed tables
+ *
+ * Allocations of at least one huge page are aligned on the huge page size and advised to be backed
+ * by transparent huge pages (MADV_HUGEPAGE), which cuts the TLB misses of the scans over the tables.
+ * Smaller allocations are only aligned on a cache line.
+ */
+template<class T>
+class HugePageAllocator
+{
+public:
+  typedef T value_type;
+
+  static const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  HugePageAllocator() noexcept = default;
+  template<class U>
+  HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+  T* allocate(const std::size_t n)
+  {
+    const std::size_t bytes = n * sizeof(T);
+    if (bytes == 0) { return nullptr; }
+    if (bytes < HUGE_PAGE_SIZE)
+    {
+      return AlignedAllocator<T>().allocate(n);
+    }
+
+    // Rounded up to whole huge pages so that the last one can be backed by a huge page as well
+    const std::size_t rounded_bytes = ((bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+    void* pointer = nullptr;
+    if (posix_memalign(&pointer, HUGE_PAGE_SIZE, rounded_bytes) != 0)
+    {
+      throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    // Only a hint: the table stays usable with regular pages
+    madvise(pointer, rounded_bytes, MADV_HUGEPAGE);
+#endif
+    return static_cast<T*>(pointer);
+  }
+
+  void deallocate(T* pointer, std::size_t) noexcept
+  {
+    std::free(pointer);
+  }
+};
+
+template<class T, class U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) noexcept
+{
+  return true;
+}
+
+template<class T, class U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) noexcept
+{
+  return false;
+}
+
+/** Storage of the numeric containers */
+template<class T>
+using aligned_vector = std::vector<T, AlignedAllocator<T>>;
+
+/** Storage of the scratch buffers, first touched by their users */
+template<class T>
+using uninitialized_vector = std::vector<T, UninitializedAllocator<T>>;
+
+/** Storage of the large precomputed tables of the plans */
+template<class T>
+using huge_page_vector = std::vector<T, HugePageAllocator<T>>;
+
+}
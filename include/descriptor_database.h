@@ -0,0 +1,128 @@
+/**
+ * @file descriptor_database.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Append only store of descriptors with similarity search
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "types.h"
+#include "mapped_file.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Similarity of two descriptors
+ */
+enum class Metric
+{
+  L2,          /*!< squared euclidean distance, the smallest first */
+  InnerProduct /*!< inner product, the largest first */
+};
+
+/**
+ * @brief Entry found by a search
+ */
+typedef struct
+{
+  natural_t index; /*!< position of the descriptor in the database */
+  float score;     /*!< squared distance or inner product (see Metric) */
+} SearchResult;
+
+/**
+ * @brief Packed matrix of float descriptors (e.g. HyperSpharm::descriptors) stored in a memory mapped file
+ *
+ * Layout (header fields little-endian):
+ *  - 0: magic "HSDB", 4: uint16 version
+ *  - 8: uint64 dimension, 16: uint64 row stride (floats), 24: uint64 number of descriptors
+ *  - 64: the descriptors, one row of row_stride floats each (zero padded to a multiple of 64 bytes)
+ *
+ * The descriptors are appended after the last row, then the count of the header is updated:
+ * a partially written append is ignored when the file is reopened.
+ *
+ * The searches scan the mapping by shards of SHARD_SIZE rows in parallel, every row being compared
+ * with all the queries while it is in cache. Each thread keeps the best k entries of every query,
+ * the thread results are merged at the end.
+ */
+class DescriptorDatabase
+{
+public:
+  static const natural_t VERSION;
+  static const natural_t HEADER_SIZE;
+  /** Rows scanned by a thread at once */
+  static const natural_t SHARD_SIZE;
+
+  /**
+   * Creates an empty database (the file is replaced)
+   * @param path
+   * @param dimension number of floats of a descriptor
+   * @throw runtime_error if the file cannot be written
+   */
+  static DescriptorDatabase create(const std::string& path, natural_t dimension);
+  /**
+   * Opens an existing database
+   * @param path
+   * @throw runtime_error if the file cannot be mapped or is not a database
+   */
+  explicit DescriptorDatabase(const std::string& path);
+
+  natural_t dimension() const;
+  /** Number of descriptors */
+  natural_t size() const;
+  /** Distance in floats between two rows, multiple of 16 */
+  natural_t row_stride() const;
+  /** Returns the dimension() values of the descriptor (valid until the next append) */
+  const float* row(natural_t index) const;
+
+  /**
+   * Appends descriptors to the file and remaps it
+   * @param descriptors count x dimension() row major matrix
+   * @param count
+   * @throw runtime_error if the file cannot be written
+   */
+  void append(const float* descriptors, natural_t count);
+
+  /**
+   * Returns the min(k, size()) best entries for the query, the best first
+   * @param query dimension() values
+   * @param k
+   * @param metric
+   */
+  std::vector<SearchResult> search(const float* query, natural_t k, Metric metric) const;
+  /**
+   * Same as above for a batch of queries sharing the scan of the database
+   * @param queries query_nb x dimension() row major matrix
+   * @param query_nb
+   * @param k
+   * @param metric
+   * @param out query_nb x min(k, size()) row major matrix receiving the results
+   * @return min(k, size()), the number of results per query
+   */
+  natural_t search_batch(const float* queries, natural_t query_nb, natural_t k, Metric metric,
+                         SearchResult* out) const;
+
+private:
+  std::string path_;
+  MappedFile file_;
+  natural_t dimension_;
+  natural_t row_stride_;
+  natural_t size_;
+
+  void read_header();
+
+  /** Ranking key of a row: the smaller the better */
+  static inline float get_key(const float* row, const float* query, natural_t row_stride, Metric metric);
+  /** Inserts the candidate in the max heap (on the key) holding the best capacity entries */
+  static void push(std::vector<SearchResult>& heap, natural_t capacity, const SearchResult& candidate);
+  /** Orders the entries by key, then by index */
+  static bool is_better(const SearchResult& left, const SearchResult& right);
+  static natural_t get_row_stride(natural_t dimension);
+};
+
+}
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <complex>
 #include <iostream>
 #include "types.h"
 
@@ -15,9 +16,32 @@ namespace hyperspharm
 {
 
 bool is_power_of_two(natural_t value);
-void separate (complex_t* array, natural_t size);
-bool fft (complex_t* array, natural_t size);
-bool ifft (complex_t* array, natural_t size);
-void unsafe_fft (complex_t* array, natural_t size);
+
+/**
+ * The transforms are instantiated for std::complex<float> and std::complex<double> (complex_t)
+ */
+template<class T> void separate (std::complex<T>* array, natural_t size);
+template<class T> bool fft (std::complex<T>* array, natural_t size);
+template<class T> bool ifft (std::complex<T>* array, natural_t size);
+template<class T> void unsafe_fft (std::complex<T>* array, natural_t size);
+
+/**
+ * Same as above with a caller provided scratch buffer of at least size / 2 values: no heap allocation
+ */
+template<class T> void separate (std::complex<T>* array, natural_t size, std::complex<T>* scratch);
+template<class T> bool fft (std::complex<T>* array, natural_t size, std::complex<T>* scratch);
+template<class T> bool ifft (std::complex<T>* array, natural_t size, std::complex<T>* scratch);
+template<class T> void unsafe_fft (std::complex<T>* array, natural_t size, std::complex<T>* scratch);
+
+/**
+ * Fft of real values (r2c): the size / 2 + 1 first coefficients, the others being their conjugates.
+ * The real values are read in place and packed as size / 2 complex values transformed by a half size fft.
+ * @param input size real values
+ * @param size power of two
+ * @param output receives size / 2 + 1 coefficients
+ * @param scratch buffer of at least size / 4 values
+ * @return true if size is a power of two
+ */
+template<class T> bool rfft (const T* input, natural_t size, std::complex<T>* output, std::complex<T>* scratch);
 
 }
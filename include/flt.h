@@ -0,0 +1,104 @@
+/**
+ * @file flt.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Fast Legendre transform helpers: compression of the Legendre matrices used by the spherical transforms
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "utils.h"
+#include "types.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Legendre matrix compressed with interpolative decompositions
+ *
+ * The R x C matrix is split in tiles whose sizes are chosen so that the product of their
+ * degree range and latitude range stays small (butterfly admissibility): such tiles are
+ * numerically low rank. Each tile M is stored as M[:, J] * T where J are r skeleton columns
+ * (interpolative decomposition), or kept dense when its rank is too high to pay off.
+ *
+ * Applying the matrix then costs sum(r * (rows + cols)) over the tiles instead of R * C.
+ */
+class CompressedLegendreMatrix
+{
+public:
+  CompressedLegendreMatrix();
+
+  /**
+   * Compresses the matrix
+   * @param values row major matrix (rows x cols)
+   * @param rows number of rows (degrees)
+   * @param cols number of columns (latitudes)
+   * @param tolerance relative tolerance of the decompositions (relative to the largest column norm)
+   */
+  CompressedLegendreMatrix(const real_t* values, natural_t rows, natural_t cols, real_t tolerance);
+
+  /**
+   * Computes y += A x for a batch of vectors
+   * @param x cols x batch matrix (row major)
+   * @param y rows x batch matrix (row major)
+   * @param batch number of vectors
+   */
+  void apply(const complex_t* x, complex_t* y, natural_t batch) const;
+  /**
+   * Same as above with a scratch buffer of at least max_rank() * batch values (no heap allocation)
+   */
+  void apply(const complex_t* x, complex_t* y, natural_t batch, complex_t* scratch) const;
+
+  /**
+   * Computes x += A^T y for a batch of vectors
+   * @param y rows x batch matrix (row major)
+   * @param x cols x batch matrix (row major)
+   * @param batch number of vectors
+   */
+  void apply_transpose(const complex_t* y, complex_t* x, natural_t batch) const;
+  /**
+   * Same as above with a scratch buffer of at least max_rank() * batch values (no heap allocation)
+   */
+  void apply_transpose(const complex_t* y, complex_t* x, natural_t batch, complex_t* scratch) const;
+
+  natural_t rows() const;
+  natural_t cols() const;
+  /** Number of multiplications needed to apply the matrix to one vector */
+  natural_t cost() const;
+  /** Largest rank of the tiles (number of columns for the dense ones) */
+  natural_t max_rank() const;
+
+private:
+  typedef struct
+  {
+    natural_t first_row;
+    natural_t row_nb;
+    natural_t first_col;
+    natural_t col_nb;
+    natural_t rank;                   /*!< number of skeleton columns, col_nb if the tile is dense */
+    bool dense;
+    std::vector<natural_t> skeleton;  /*!< columns (relative to first_col) kept by the decomposition */
+    std::vector<real_t> columns;      /*!< dense: row_nb x col_nb, otherwise M[:, skeleton] (row_nb x rank) */
+    std::vector<real_t> interpolation;/*!< T (rank x col_nb) */
+  } Tile;
+
+  static const natural_t MIN_TILE_SIZE;
+
+  natural_t rows_;
+  natural_t cols_;
+  natural_t cost_;
+  natural_t max_rank_;
+  std::vector<Tile> tiles_;
+
+  static Tile compress_tile(const real_t* values, natural_t cols,
+                            natural_t first_row, natural_t row_nb,
+                            natural_t first_col, natural_t col_nb,
+                            real_t absolute_tolerance);
+};
+
+}
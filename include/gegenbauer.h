@@ -9,24 +9,29 @@
 #pragma once
 
 #include <cstdint>
+#include <stdexcept>
 #include <vector>
 #include "utils.h"
 #include "types.h"
+#include "aligned_allocator.h"
 
 namespace hyperspharm
 {
 
 class GegenbauerPoly;
 
-class GegenbauerArray
+template<class Alloc = AlignedAllocator<real_t>>
+class BasicGegenbauerArray
 {
   friend GegenbauerPoly;
 
 public:
-  explicit GegenbauerArray(const natural_t l_max);
+  typedef Alloc allocator_type;
 
-  GegenbauerArray (GegenbauerArray&& other) noexcept;
-  GegenbauerArray& operator= (GegenbauerArray&& other) noexcept;
+  explicit BasicGegenbauerArray(const natural_t l_max);
+
+  BasicGegenbauerArray (BasicGegenbauerArray&& other) noexcept;
+  BasicGegenbauerArray& operator= (BasicGegenbauerArray&& other) noexcept;
 
   /**
    * Get the value for order (l, m)
@@ -61,14 +66,16 @@ public:
    */
   void unsafe_set(natural_t l, natural_t m, real_t x);
   
-  std::vector<std::vector<real_t>>& values();
+  std::vector<std::vector<real_t, Alloc>>& values();
 
   natural_t l_max() const;
 private:
   natural_t l_max_;
-  std::vector<std::vector<real_t>> values_;
+  std::vector<std::vector<real_t, Alloc>> values_;
 };
 
+typedef BasicGegenbauerArray<> GegenbauerArray;
+
 
 
 class GegenbauerPoly
@@ -106,7 +113,81 @@ private:
   static std::vector<std::vector<GegenbauerPoly::coeff>> coeffs_;
 };
 
+template<class Alloc>
+BasicGegenbauerArray<Alloc>::BasicGegenbauerArray(const natural_t l_max) :
+  l_max_(l_max)
+{
+  values_.resize(l_max + 1);
+  for (auto& value : values_)
+  {
+    value.resize(l_max + 1);
+  }
+}
+
+template<class Alloc>
+real_t BasicGegenbauerArray<Alloc>::get(const natural_t l, const natural_t m) const
+{
+  if(l > l_max_)
+  {
+    // TODO improve error message
+    throw std::invalid_argument( "Gegenbauer array index out of range" );
+  }
+
+  return values_[m][l];
+}
+
+template<class Alloc>
+real_t BasicGegenbauerArray<Alloc>::unsafe_get(const natural_t l, const natural_t m) const
+{
+  return values_[m][l];
+}
+
+template<class Alloc>
+void BasicGegenbauerArray<Alloc>::set(const natural_t l, const natural_t m, const real_t x)
+{
+  if((m > l_max_) || (l > l_max_))
+  {
+    // TODO improve error message
+    throw std::invalid_argument( "Gegenbauer array index out of range" );
+  }
+
+  values_[m][l] =  x;
 }
 
+template<class Alloc>
+void BasicGegenbauerArray<Alloc>::unsafe_set(const natural_t l, const natural_t m, const real_t x)
+{
+  values_[m][l] =  x;
+}
+
+template<class Alloc>
+BasicGegenbauerArray<Alloc>::BasicGegenbauerArray(BasicGegenbauerArray &&other) noexcept :
+  l_max_(other.l_max_)
+{
+  values_ = std::move(other.values_);
+}
+
+template<class Alloc>
+BasicGegenbauerArray<Alloc> &BasicGegenbauerArray<Alloc>::operator=(BasicGegenbauerArray &&other) noexcept
+{
+  if (this != &other)
+  {
+    l_max_ = other.l_max_;
+    values_ = std::move(other.values_);
+  }
+  return *this;
+}
 
+template<class Alloc>
+natural_t BasicGegenbauerArray<Alloc>::l_max() const
+{
+  return l_max_;
+}
 
+template<class Alloc>
+std::vector<std::vector<real_t, Alloc>>& BasicGegenbauerArray<Alloc>::values()
+{
+  return values_;
+}
+
+}
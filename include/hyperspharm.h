@@ -16,16 +16,76 @@
 #include "fft.h"
 #include "utils.h"
 #include "types.h"
+#include "aligned_allocator.h"
 #include "legendre.h"
+#include "gegenbauer.h"
+#include "quadrature.h"
+#include "spharms.h"
+#include "mapped_file.h"
 
 namespace hyperspharm
 {
 
-class HyperSphericalSurface
+/**
+ * @brief Non owning view of a hypersphere
+ *
+ * theta_nb x psi_nb x phi_nb values laid out like a HyperSphericalSurface.
+ * The viewed values must outlive the view.
+ */
+class HyperSphericalSurfaceView
+{
+public:
+  HyperSphericalSurfaceView(const real_t* data, natural_t theta_nb, natural_t psi_nb, natural_t phi_nb,
+                            GridType grid = GridType::Equiangular) :
+    data_(data), theta_nb_(theta_nb), psi_nb_(psi_nb), phi_nb_(phi_nb), grid_(grid)
+  {
+  }
+
+  inline real_t get(const natural_t theta_i, const natural_t psi_i, const natural_t phi_i) const
+  {
+    return data_[(((theta_i * psi_nb_) + psi_i) * phi_nb_) + phi_i];
+  }
+
+  /** Returns a view of the psi_nb x phi_nb values of the hyperangle */
+  SphericalSurfaceView slice(const natural_t theta_i) const
+  {
+    return SphericalSurfaceView(data_ + (theta_i * psi_nb_ * phi_nb_), psi_nb_, phi_nb_, phi_nb_, grid_);
+  }
+
+  const real_t* data() const { return data_; }
+  natural_t theta_nb() const { return theta_nb_; }
+  natural_t psi_nb() const { return psi_nb_; }
+  natural_t phi_nb() const { return phi_nb_; }
+  GridType grid() const { return grid_; }
+
+private:
+  const real_t* data_;
+  natural_t theta_nb_;
+  natural_t psi_nb_;
+  natural_t phi_nb_;
+  GridType grid_;
+};
+
+/**
+ * @brief Hypersphere Container
+ *
+ * Contains the radii for the angles theta_i (hyperangle beta in (0, pi)), psi_i (inclination in [0, pi])
+ * and phi_i (azimuth in [0, 2pi)), stored theta major.
+ * The hyperangles are the Gauss-Chebyshev nodes of the second kind (see Quadrature::gauss_chebyshev),
+ * the inclinations are sampled according to the grid type (equiangular by default).
+ * The radii are allocated by Alloc (64-byte aligned by default, HugePageAllocator for the large surfaces)
+ */
+template<class Alloc = AlignedAllocator<real_t>>
+class BasicHyperSphericalSurface
 {
 public:
-  HyperSphericalSurface(natural_t theta_nb, natural_t psi_nb, natural_t phi_nb);
-  HyperSphericalSurface(natural_t theta_nb, natural_t psi_nb, natural_t phi_nb, real_t init_val);
+  typedef Alloc allocator_type;
+
+  BasicHyperSphericalSurface(natural_t theta_nb, natural_t psi_nb, natural_t phi_nb);
+  BasicHyperSphericalSurface(natural_t theta_nb, natural_t psi_nb, natural_t phi_nb, real_t init_val);
+  BasicHyperSphericalSurface(natural_t theta_nb, natural_t psi_nb, natural_t phi_nb, GridType grid);
+  BasicHyperSphericalSurface(natural_t theta_nb, natural_t psi_nb, natural_t phi_nb, real_t init_val,
+                             GridType grid);
 
   real_t get(natural_t theta_i, natural_t psi_i, natural_t phi_i) const;
   void set(natural_t theta_i, natural_t psi_i, natural_t phi_i, real_t radius);
@@ -33,35 +93,324 @@ public:
   natural_t theta_nb() const;
   natural_t psi_nb() const;
   natural_t phi_nb() const;
+  /** Grid type of the inclinations psi */
+  GridType grid() const;
 
   std::vector<real_t> thetas() const;
   std::vector<real_t> psis() const;
   std::vector<real_t> phis() const;
 
+  /** The std::function maps call func sequentially, in storage order */
   void map(std::function<real_t ()>);
   void map(std::function<real_t (real_t old_val)>);
   void map(std::function<real_t (natural_t theta_i, natural_t psi_i, natural_t phi_i, real_t old_val)>);
 
+  /**
+   * Sets every value to func(theta, psi, phi, old_val), theta, psi and phi being the angles of the sample.
+   * The (theta, psi) rows are processed in parallel: func must be safe to call concurrently.
+   * @param func any callable, inlined in the loops
+   */
+  template<class F>
+  void parallel_map(F func)
+  {
+    const auto theta_values = thetas();
+    const auto psi_values = psis();
+    const auto phi_values = phis();
+    const natural_t psi_nb = psi_nb_;
+    const natural_t phi_nb = phi_nb_;
+    real_t* values = values_.data();
+#pragma omp parallel for collapse(2) schedule(static)
+    for (natural_t theta_i = 0; theta_i < theta_nb_; ++theta_i)
+    {
+      for (natural_t psi_i = 0; psi_i < psi_nb; ++psi_i)
+      {
+        const real_t theta = theta_values[theta_i];
+        const real_t psi = psi_values[psi_i];
+        real_t* row = values + (((theta_i * psi_nb) + psi_i) * phi_nb);
+        for (natural_t phi_i = 0; phi_i < phi_nb; ++phi_i)
+        {
+          row[phi_i] = func(theta, psi, phi_values[phi_i], row[phi_i]);
+        }
+      }
+    }
+  }
+
   std::string to_string() const;
 
   inline natural_t get_index(natural_t theta_i, natural_t psi_i, natural_t phi_i) const
   {
     return (theta_i * (psi_nb_ * phi_nb_)) + (psi_i * phi_nb_) + phi_i;
   }
-  std::vector<real_t>& values();
+  std::vector<real_t, Alloc>& values();
+  const std::vector<real_t, Alloc>& values() const;
+  /**
+   * Returns a view of the psi_nb x phi_nb values of the hyperangle, without copying them
+   * (valid while the surface is alive and not resized)
+   */
+  SphericalSurfaceView slice(natural_t theta_i) const;
+  /** Returns a view of the surface (valid while the surface is alive and not resized) */
+  HyperSphericalSurfaceView view() const;
 private:
   natural_t theta_nb_;
   natural_t psi_nb_;
   natural_t phi_nb_;
-  std::vector<real_t> values_;
+  GridType grid_;
+  std::vector<real_t, Alloc> values_;
 };
 
-class HyperSphericalCoeffs
+template<class Alloc>
+BasicHyperSphericalSurface<Alloc>::BasicHyperSphericalSurface(const natural_t theta_nb, const natural_t psi_nb,
+                                                              const natural_t phi_nb):
+  theta_nb_(theta_nb), psi_nb_(psi_nb), phi_nb_(phi_nb), grid_(GridType::Equiangular),
+  values_(theta_nb * psi_nb * phi_nb)
+{
+
+}
+
+
+template<class Alloc>
+BasicHyperSphericalSurface<Alloc>::BasicHyperSphericalSurface(const natural_t theta_nb, const natural_t psi_nb,
+                                                              const natural_t phi_nb, const real_t init_val):
+    theta_nb_(theta_nb), psi_nb_(psi_nb),
+    phi_nb_(phi_nb), grid_(GridType::Equiangular), values_(theta_nb * psi_nb * phi_nb, init_val)
+{
+
+}
+
+template<class Alloc>
+BasicHyperSphericalSurface<Alloc>::BasicHyperSphericalSurface(const natural_t theta_nb, const natural_t psi_nb,
+                                                              const natural_t phi_nb, const GridType grid):
+    theta_nb_(theta_nb), psi_nb_(psi_nb),
+    phi_nb_(phi_nb), grid_(grid), values_(theta_nb * psi_nb * phi_nb)
+{
+
+}
+
+template<class Alloc>
+BasicHyperSphericalSurface<Alloc>::BasicHyperSphericalSurface(const natural_t theta_nb, const natural_t psi_nb,
+                                                              const natural_t phi_nb, const real_t init_val,
+                                                              const GridType grid):
+    theta_nb_(theta_nb), psi_nb_(psi_nb),
+    phi_nb_(phi_nb), grid_(grid), values_(theta_nb * psi_nb * phi_nb, init_val)
+{
+
+}
+
+template<class Alloc>
+real_t BasicHyperSphericalSurface<Alloc>::get(natural_t theta_i, natural_t psi_i, natural_t phi_i) const
+{
+  return values_[get_index(theta_i, psi_i, phi_i)];
+}
+
+template<class Alloc>
+void BasicHyperSphericalSurface<Alloc>::set(natural_t theta_i, natural_t psi_i, natural_t phi_i, real_t radius)
+{
+  // TODO Check could be added (and then an unsafe method)
+  values_[get_index(theta_i, psi_i, phi_i)] = radius;
+}
+
+template<class Alloc>
+natural_t BasicHyperSphericalSurface<Alloc>::theta_nb() const
+{
+  return theta_nb_;
+}
+
+template<class Alloc>
+natural_t BasicHyperSphericalSurface<Alloc>::psi_nb() const
+{
+  return psi_nb_;
+}
+
+template<class Alloc>
+natural_t BasicHyperSphericalSurface<Alloc>::phi_nb() const
+{
+  return phi_nb_;
+}
+
+template<class Alloc>
+GridType BasicHyperSphericalSurface<Alloc>::grid() const
+{
+  return grid_;
+}
+
+template<class Alloc>
+std::vector<real_t> BasicHyperSphericalSurface<Alloc>::thetas() const
+{
+  if (theta_nb_ == 0) { return std::vector<real_t>(); }
+  return Quadrature::gauss_chebyshev(theta_nb_).thetas;
+}
+
+template<class Alloc>
+std::vector<real_t> BasicHyperSphericalSurface<Alloc>::psis() const
+{
+  return Quadrature::get_thetas(grid_, psi_nb_);
+}
+
+template<class Alloc>
+std::vector<real_t> BasicHyperSphericalSurface<Alloc>::phis() const
+{
+  std::vector<real_t> result;
+  result.reserve(phi_nb_);
+  for (natural_t phi_i = 0; phi_i < phi_nb_; ++phi_i)
+  {
+    result.push_back(2.0 * M_PI * static_cast<real_t>(phi_i) / static_cast<real_t>(phi_nb_));
+  }
+  return result;
+}
+
+template<class Alloc>
+void BasicHyperSphericalSurface<Alloc>::map(std::function<real_t()> func)
+{
+  for(auto& value : values_)
+  {
+    value = func();
+  }
+}
+
+template<class Alloc>
+void BasicHyperSphericalSurface<Alloc>::map(std::function<real_t(real_t)> func)
+{
+  for(auto& value : values_)
+  {
+    value = func(value);
+  }
+}
+
+template<class Alloc>
+void BasicHyperSphericalSurface<Alloc>::map(std::function<real_t(natural_t, natural_t,
+                                                                 natural_t, real_t)> func)
+{
+  for (natural_t theta_i = 0; theta_i < theta_nb_; ++theta_i)
+  {
+    for (natural_t psi_i = 0; psi_i < psi_nb_; ++psi_i)
+    {
+      real_t* row = values_.data() + get_index(theta_i, psi_i, 0);
+      for (natural_t phi_i = 0; phi_i < phi_nb_; ++phi_i)
+      {
+        row[phi_i] = func(theta_i, psi_i, phi_i, row[phi_i]);
+      }
+    }
+  }
+}
+
+template<class Alloc>
+std::string BasicHyperSphericalSurface<Alloc>::to_string() const
+{
+  return "TODO";
+}
+
+template<class Alloc>
+std::vector<real_t, Alloc> &BasicHyperSphericalSurface<Alloc>::values()
+{
+  return values_;
+}
+
+template<class Alloc>
+const std::vector<real_t, Alloc> &BasicHyperSphericalSurface<Alloc>::values() const
+{
+  return values_;
+}
+
+template<class Alloc>
+SphericalSurfaceView BasicHyperSphericalSurface<Alloc>::slice(const natural_t theta_i) const
+{
+  return SphericalSurfaceView(values_.data() + (theta_i * psi_nb_ * phi_nb_), psi_nb_, phi_nb_, phi_nb_, grid_);
+}
+
+template<class Alloc>
+HyperSphericalSurfaceView BasicHyperSphericalSurface<Alloc>::view() const
+{
+  return HyperSphericalSurfaceView(values_.data(), theta_nb_, psi_nb_, phi_nb_, grid_);
+}
+
+typedef BasicHyperSphericalSurface<> HyperSphericalSurface;
+
+/**
+ * @brief Storage of the hyperspherical coefficients
+ */
+enum class CoeffsLayout
+{
+  Cube,       /*!< n_max x l_max x m_max values, including the ones with l > n or m > l */
+  Tetrahedral /*!< only the n_max (n_max + 1) (n_max + 2) / 6 values with n >= l >= m */
+};
+
+class HyperSphericalCoeffsView;
+
+/**
+ * @brief Hyperspherical Coefficients Container
+ *
+ * Contains the coefficients f_nlm for n < n_max, l < l_max and m < m_max.
+ * With the tetrahedral layout, l_max = m_max = n_max and the values are packed n major:
+ * index = n (n + 1) (n + 2) / 6 + l (l + 1) / 2 + m. get returns 0 and set is ignored for l > n or m > l.
+ * The values are allocated by Alloc (64-byte aligned by default).
+ */
+template<class Alloc = AlignedAllocator<complex_t>>
+class BasicHyperSphericalCoeffs
 {
 public:
-  explicit HyperSphericalCoeffs(natural_t n_max, natural_t l_max, natural_t m_max);
-  explicit HyperSphericalCoeffs(natural_t n_max, natural_t l_max,
-                                natural_t m_max, complex_t init_val);
+  /**
+   * Iterator over the coefficients with n >= l >= m, n major then l then m (the order of the
+   * tetrahedral storage)
+   */
+  template<class Coeffs, class Value>
+  class Iterator
+  {
+  public:
+    Iterator(Coeffs* coeffs, const natural_t n) :
+      coeffs_(coeffs), n_(n), l_(0), m_(0)
+    {
+    }
+
+    natural_t n() const { return n_; }
+    natural_t l() const { return l_; }
+    natural_t m() const { return m_; }
+
+    Value& operator*() const
+    {
+      return coeffs_->values()[coeffs_->get_index(n_, l_, m_)];
+    }
+
+    Iterator& operator++()
+    {
+      ++m_;
+      if ((m_ > l_) || (m_ >= coeffs_->m_max()))
+      {
+        m_ = 0;
+        ++l_;
+        if ((l_ > n_) || (l_ >= coeffs_->l_max()))
+        {
+          l_ = 0;
+          ++n_;
+        }
+      }
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const
+    {
+      return (n_ == other.n_) && (l_ == other.l_) && (m_ == other.m_);
+    }
+
+    bool operator!=(const Iterator& other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    Coeffs* coeffs_;
+    natural_t n_;
+    natural_t l_;
+    natural_t m_;
+  };
+  typedef Iterator<BasicHyperSphericalCoeffs, complex_t> iterator;
+  typedef Iterator<const BasicHyperSphericalCoeffs, const complex_t> const_iterator;
+  typedef Alloc allocator_type;
+
+  explicit BasicHyperSphericalCoeffs(natural_t n_max, natural_t l_max, natural_t m_max);
+  explicit BasicHyperSphericalCoeffs(natural_t n_max, natural_t l_max,
+                                     natural_t m_max, complex_t init_val);
+  BasicHyperSphericalCoeffs(natural_t n_max, CoeffsLayout layout);
+  BasicHyperSphericalCoeffs(natural_t n_max, CoeffsLayout layout, complex_t init_val);
 
   // TODO: Add possibility to input m negative
   complex_t get(natural_t n, natural_t l, natural_t m) const;
@@ -70,31 +419,555 @@ public:
   natural_t n_max() const;
   natural_t l_max() const;
   natural_t m_max() const;
+  CoeffsLayout layout() const;
 
+  /** The std::function maps call func sequentially, in storage order */
   void map(std::function<complex_t ()>);
   void map(std::function<complex_t (complex_t old_val)>);
   void map(std::function<complex_t (natural_t n, natural_t l, natural_t m, complex_t old_val)>);
 
+  /**
+   * Sets every stored value to func(n, l, m, old_val) (only n >= l >= m with the tetrahedral layout).
+   * The degrees n are processed in parallel: func must be safe to call concurrently.
+   * @param func any callable, inlined in the loops
+   */
+  template<class F>
+  void parallel_map(F func)
+  {
+    const bool tetrahedral = (layout_ == CoeffsLayout::Tetrahedral);
+#pragma omp parallel for schedule(dynamic)
+    for (natural_t n = 0; n < n_max_; ++n)
+    {
+      const natural_t l_nb = tetrahedral ? (n + 1) : l_max_;
+      for (natural_t l = 0; l < l_nb; ++l)
+      {
+        // The orders of a degree are contiguous in both layouts
+        const natural_t m_nb = tetrahedral ? (l + 1) : m_max_;
+        complex_t* orders = values_.data() + get_index(n, l, 0);
+        for (natural_t m = 0; m < m_nb; ++m)
+        {
+          orders[m] = func(n, l, m, orders[m]);
+        }
+      }
+    }
+  }
+
+  iterator begin();
+  iterator end();
+  const_iterator begin() const;
+  const_iterator end() const;
 
   std::string to_string();
 
   inline natural_t get_index(natural_t n, natural_t l, natural_t m) const
   {
-    return (n * (m_max_ * l_max_)) + (l * m_max_) + m;
+    return get_index(layout_, l_max_, m_max_, n, l, m);
   }
-  std::vector<complex_t>& values();
+  static inline natural_t get_index(CoeffsLayout layout, natural_t l_max, natural_t m_max,
+                                    natural_t n, natural_t l, natural_t m)
+  {
+    if (layout == CoeffsLayout::Tetrahedral)
+    {
+      return ((n * (n + 1) * (n + 2)) / 6) + ((l * (l + 1)) / 2) + m;
+    }
+    return (n * (m_max * l_max)) + (l * m_max) + m;
+  }
+  /** Number of stored values of the layout */
+  static natural_t get_size(CoeffsLayout layout, natural_t n_max, natural_t l_max, natural_t m_max);
+  std::vector<complex_t, Alloc>& values();
+  const std::vector<complex_t, Alloc>& values() const;
+  /** Returns a view of the coefficients (valid while the container is alive and not resized) */
+  HyperSphericalCoeffsView view() const;
 private:
   natural_t n_max_;
   natural_t l_max_;
   natural_t m_max_;
-  std::vector<complex_t> values_;
+  CoeffsLayout layout_;
+  std::vector<complex_t, Alloc> values_;
 };
 
-class HyperSpharm
+typedef BasicHyperSphericalCoeffs<> HyperSphericalCoeffs;
+
+/**
+ * @brief Non owning view of hyperspherical coefficients
+ *
+ * Values laid out like a HyperSphericalCoeffs with the same dimensions and layout.
+ * The viewed values must outlive the view.
+ */
+class HyperSphericalCoeffsView
 {
-  HyperSphericalCoeffs transform(HyperSphericalSurface surface);
-  HyperSphericalSurface transform(HyperSphericalCoeffs coeffs);
+public:
+  HyperSphericalCoeffsView(const complex_t* data, natural_t n_max, natural_t l_max, natural_t m_max,
+                           CoeffsLayout layout) :
+    data_(data), n_max_(n_max), l_max_(l_max), m_max_(m_max), layout_(layout)
+  {
+  }
+
+  /** Returns 0 for l > n or m > l with the tetrahedral layout */
+  inline complex_t get(const natural_t n, const natural_t l, const natural_t m) const
+  {
+    if ((layout_ == CoeffsLayout::Tetrahedral) && ((n >= n_max_) || (l > n) || (m > l)))
+    {
+      return {0, 0};
+    }
+    return data_[HyperSphericalCoeffs::get_index(layout_, l_max_, m_max_, n, l, m)];
+  }
+
+  const complex_t* data() const { return data_; }
+  natural_t n_max() const { return n_max_; }
+  natural_t l_max() const { return l_max_; }
+  natural_t m_max() const { return m_max_; }
+  CoeffsLayout layout() const { return layout_; }
+  /** Number of viewed values */
+  natural_t size() const { return HyperSphericalCoeffs::get_size(layout_, n_max_, l_max_, m_max_); }
+
+private:
+  const complex_t* data_;
+  natural_t n_max_;
+  natural_t l_max_;
+  natural_t m_max_;
+  CoeffsLayout layout_;
 };
 
+template<class Alloc>
+BasicHyperSphericalCoeffs<Alloc>::BasicHyperSphericalCoeffs(natural_t n_max, natural_t l_max, natural_t m_max):
+  n_max_(n_max), l_max_(l_max), m_max_(m_max), layout_(CoeffsLayout::Cube), values_(n_max * l_max * m_max)
+{
+}
+
+template<class Alloc>
+BasicHyperSphericalCoeffs<Alloc>::BasicHyperSphericalCoeffs(natural_t n_max, natural_t l_max,
+                                                            natural_t m_max, complex_t init_val):
+    n_max_(n_max), l_max_(l_max), m_max_(m_max), layout_(CoeffsLayout::Cube),
+    values_(n_max * l_max * m_max, init_val)
+{
+}
+
+template<class Alloc>
+BasicHyperSphericalCoeffs<Alloc>::BasicHyperSphericalCoeffs(natural_t n_max, CoeffsLayout layout):
+    BasicHyperSphericalCoeffs(n_max, layout, {0, 0})
+{
+}
+
+template<class Alloc>
+BasicHyperSphericalCoeffs<Alloc>::BasicHyperSphericalCoeffs(natural_t n_max, CoeffsLayout layout,
+                                                            complex_t init_val):
+    n_max_(n_max), l_max_(n_max), m_max_(n_max), layout_(layout),
+    values_(get_size(layout, n_max, n_max, n_max), init_val)
+{
+}
+
+template<class Alloc>
+complex_t BasicHyperSphericalCoeffs<Alloc>::get(natural_t n, natural_t l, natural_t m) const
+{
+  if ((layout_ == CoeffsLayout::Tetrahedral) && ((n >= n_max_) || (l > n) || (m > l)))
+  {
+    return {0, 0};
+  }
+  return values_[get_index(n, l, m)];
+}
+
+template<class Alloc>
+void BasicHyperSphericalCoeffs<Alloc>::set(natural_t n, natural_t l, natural_t m, complex_t value)
+{
+  if ((layout_ == CoeffsLayout::Tetrahedral) && ((n >= n_max_) || (l > n) || (m > l)))
+  {
+    return;
+  }
+  values_[get_index(n, l, m)] = value;
+}
+
+template<class Alloc>
+natural_t BasicHyperSphericalCoeffs<Alloc>::n_max() const
+{
+  return n_max_;
+}
+
+template<class Alloc>
+natural_t BasicHyperSphericalCoeffs<Alloc>::l_max() const
+{
+  return l_max_;
+}
+
+template<class Alloc>
+natural_t BasicHyperSphericalCoeffs<Alloc>::m_max() const
+{
+  return m_max_;
+}
+
+template<class Alloc>
+CoeffsLayout BasicHyperSphericalCoeffs<Alloc>::layout() const
+{
+  return layout_;
+}
+
+template<class Alloc>
+void BasicHyperSphericalCoeffs<Alloc>::map(std::function<complex_t()> func)
+{
+  for(auto& value : values_)
+  {
+    value = func();
+  }
+}
+
+template<class Alloc>
+void BasicHyperSphericalCoeffs<Alloc>::map(std::function<complex_t(complex_t)> func)
+{
+  for(auto& value : values_)
+  {
+    value = func(value);
+  }
+}
+
+template<class Alloc>
+void BasicHyperSphericalCoeffs<Alloc>::map(std::function<complex_t(natural_t, natural_t,
+                                                                   natural_t, complex_t)> func)
+{
+  const bool tetrahedral = (layout_ == CoeffsLayout::Tetrahedral);
+  for (natural_t n = 0; n < n_max_; ++n)
+  {
+    for (natural_t l = 0; l < (tetrahedral ? (n + 1) : l_max_); ++l)
+    {
+      complex_t* orders = values_.data() + get_index(n, l, 0);
+      for (natural_t m = 0; m < (tetrahedral ? (l + 1) : m_max_); ++m)
+      {
+        orders[m] = func(n, l, m, orders[m]);
+      }
+    }
+  }
+}
+
+template<class Alloc>
+std::string BasicHyperSphericalCoeffs<Alloc>::to_string()
+{
+  return "TODO";
+}
+
+template<class Alloc>
+typename BasicHyperSphericalCoeffs<Alloc>::iterator BasicHyperSphericalCoeffs<Alloc>::begin()
+{
+  return iterator(this, 0);
+}
+
+template<class Alloc>
+typename BasicHyperSphericalCoeffs<Alloc>::iterator BasicHyperSphericalCoeffs<Alloc>::end()
+{
+  return iterator(this, n_max_);
 }
 
+template<class Alloc>
+typename BasicHyperSphericalCoeffs<Alloc>::const_iterator BasicHyperSphericalCoeffs<Alloc>::begin() const
+{
+  return const_iterator(this, 0);
+}
+
+template<class Alloc>
+typename BasicHyperSphericalCoeffs<Alloc>::const_iterator BasicHyperSphericalCoeffs<Alloc>::end() const
+{
+  return const_iterator(this, n_max_);
+}
+
+template<class Alloc>
+std::vector<complex_t, Alloc>& BasicHyperSphericalCoeffs<Alloc>::values()
+{
+  return values_;
+}
+
+template<class Alloc>
+const std::vector<complex_t, Alloc>& BasicHyperSphericalCoeffs<Alloc>::values() const
+{
+  return values_;
+}
+
+template<class Alloc>
+HyperSphericalCoeffsView BasicHyperSphericalCoeffs<Alloc>::view() const
+{
+  return HyperSphericalCoeffsView(values_.data(), n_max_, l_max_, m_max_, layout_);
+}
+
+template<class Alloc>
+natural_t BasicHyperSphericalCoeffs<Alloc>::get_size(const CoeffsLayout layout, const natural_t n_max,
+                                                     const natural_t l_max, const natural_t m_max)
+{
+  if (layout == CoeffsLayout::Tetrahedral)
+  {
+    return (n_max * (n_max + 1) * (n_max + 2)) / 6;
+  }
+  return n_max * l_max * m_max;
+}
+
+/**
+ * @brief Precomputed data shared by the hyperspherical transforms of all the surfaces with the same grid
+ *
+ * Holds the hyperangle quadrature (measure sin^2(beta)), the spherical plan of the beta slices
+ * (inclination quadrature, Legendre tables) and the tables of the hyperangle functions
+ * sin^l(beta) NG^{l+1}_{n-l}(cos(beta)), stored contiguously for each (l, n): [l][n - l][beta].
+ *
+ * The hyperangles are symmetric about pi / 2 and NG^{l+1}_{n-l}(-x) = (-1)^(n-l) NG^{l+1}_{n-l}(x):
+ * the tables only hold the first half_theta_nb() hyperangles, the transforms fold the mirrored
+ * hyperangles (pi - beta) into even and odd sums.
+ */
+class HyperSpharmPlan
+{
+public:
+  /**
+   * @param theta_nb number of hyperangles beta of the surfaces
+   * @param psi_nb number of inclinations theta of the surfaces
+   * @param phi_nb number of azimuths phi of the surfaces (power of two)
+   * @param n_max the transforms compute the coefficients with n < n_max (at most theta_nb)
+   */
+  HyperSpharmPlan(natural_t theta_nb, natural_t psi_nb, natural_t phi_nb, natural_t n_max);
+  HyperSpharmPlan(natural_t theta_nb, natural_t psi_nb, natural_t phi_nb, natural_t n_max, GridType grid);
+
+  natural_t theta_nb() const;
+  natural_t psi_nb() const;
+  natural_t phi_nb() const;
+  natural_t n_max() const;
+  GridType grid() const;
+  /** Number of hyperangles in [0, pi / 2]: (theta_nb + 1) / 2 */
+  natural_t half_theta_nb() const;
+  /** Number of degrees l computed by the transforms */
+  natural_t l_nb() const;
+  /** Number of orders m computed by the transforms */
+  natural_t m_nb() const;
+
+  const std::vector<real_t>& betas() const;
+  /** Quadrature weights of the hyperangles, including sin^2(beta) */
+  const std::vector<real_t>& beta_weights() const;
+  const SpharmPlan& sphere_plan() const;
+
+  /**
+   * Returns sin^l(beta) NG^{l+1}_{n-l}(cos(beta)) at the hyperangles beta <= pi / 2.
+   * The value at the mirrored hyperangle theta_nb - 1 - beta_i is (-1)^(n-l) times the one at beta_i
+   * @param l degree, l < l_nb()
+   * @param n degree, n in [l, n_max())
+   * @return pointer to half_theta_nb() contiguous values
+   */
+  inline const real_t* gegenbauer(natural_t l, natural_t n) const
+  {
+    return gegenbauer_.data() + gegenbauer_offsets_[l] + ((n - l) * half_theta_nb_);
+  }
+
+private:
+  natural_t theta_nb_;
+  natural_t psi_nb_;
+  natural_t phi_nb_;
+  natural_t n_max_;
+  GridType grid_;
+  natural_t half_theta_nb_;
+  std::vector<real_t> betas_;
+  std::vector<real_t> beta_weights_;
+  SpharmPlan sphere_plan_;
+  natural_t l_nb_;
+  std::vector<natural_t> gegenbauer_offsets_;
+  huge_page_vector<real_t> gegenbauer_;
+};
+
+/**
+ * @brief Hyperspherical harmonics transforms
+ *
+ * The hyperspherical harmonics are Z_nlm(beta, theta, phi) = sin^l(beta) NG^{l+1}_{n-l}(cos(beta)) Y_lm(theta, phi)
+ * for n >= l >= |m|, orthonormal with respect to the measure sin^2(beta) sin(theta) dbeta dtheta dphi.
+ *
+ * The transforms are separable: fft along phi, Legendre contraction along theta (a spherical
+ * transform of every beta slice), then Gegenbauer contraction along beta. They cost O(N^4)
+ * instead of the O(N^6) of the integration of every basis function over the whole grid.
+ *
+ * Every stage runs in parallel: the ffts over the (beta, theta) rows, the Legendre stage over
+ * (m, beta) and the Gegenbauer stage over (l, m).
+ */
+class HyperSpharm
+{
+public:
+  /**
+   * Computes the coefficients f_nlm (m >= 0) of the real function sampled by the surface,
+   * for n < surface.theta_nb().
+   * The spherical stage is exact for l < psi_nb / 2 on the equiangular grid, l < psi_nb on the Gauss-Legendre one.
+   * @param surface
+   * @return HyperSphericalCoeffs with the tetrahedral layout and n_max = theta_nb
+   */
+  static HyperSphericalCoeffs transform(const HyperSphericalSurface& surface);
+  /**
+   * Same as above with the tables of the plan
+   * @param plan
+   * @param surface
+   * @return HyperSphericalCoeffs with the tetrahedral layout and n_max = plan.n_max()
+   * @throw invalid_argument if the surface does not have the size and grid of the plan
+   */
+  static HyperSphericalCoeffs transform(const HyperSpharmPlan& plan, const HyperSphericalSurface& surface);
+  /**
+   * Same as above for viewed values (e.g. a surface mapped from a file, read in place)
+   * @param plan
+   * @param surface
+   * @return HyperSphericalCoeffs with the tetrahedral layout and n_max = plan.n_max()
+   * @throw invalid_argument if the surface does not have the size and grid of the plan
+   */
+  static HyperSphericalCoeffs transform(const HyperSpharmPlan& plan, const HyperSphericalSurfaceView& surface);
+  /**
+   * Size of the workspace needed by the transforms and descriptors_batch with the plan
+   */
+  static natural_t required_bytes(const HyperSpharmPlan& plan);
+  /**
+   * Same as above for the out of core transform with the given memory budget
+   */
+  static natural_t required_bytes(const HyperSpharmPlan& plan, natural_t memory_budget);
+  /**
+   * Same as above with the scratch buffers (slice coefficients included) carved from the workspace:
+   * no heap allocation when out already has the layout and n_max of the result
+   * @param plan
+   * @param surface
+   * @param out receives the coefficients
+   * @param workspace of at least required_bytes(plan)
+   * @throw invalid_argument if the surface does not have the size and grid of the plan
+   */
+  static void transform(const HyperSpharmPlan& plan, const HyperSphericalSurfaceView& surface,
+                        HyperSphericalCoeffs& out, Workspace& workspace);
+  /**
+   * Out of core version of the above for a surface stored in a file: the raw real_t values
+   * (HyperSphericalSurface order) starting at offset.
+   *
+   * The surface is streamed by slabs of consecutive hyperangles whose working set fits in the memory budget.
+   * The next slab is prefetched while the current one is transformed, and the processed slabs are released.
+   * The Gegenbauer contractions of the slabs are accumulated into the coefficients.
+   * @param plan
+   * @param file
+   * @param offset position of the first value in the file, in bytes (multiple of sizeof(real_t))
+   * @param memory_budget bytes available for a slab (at least one hyperangle is always processed)
+   * @return HyperSphericalCoeffs with the tetrahedral layout and n_max = plan.n_max()
+   * @throw invalid_argument if the file is too small for the plan or the offset is not aligned
+   */
+  static HyperSphericalCoeffs transform(const HyperSpharmPlan& plan, const MappedFile& file,
+                                        natural_t offset, natural_t memory_budget);
+  /**
+   * Same as above with the scratch buffers carved from a workspace of at least required_bytes(plan, memory_budget)
+   */
+  static void transform(const HyperSpharmPlan& plan, const MappedFile& file, natural_t offset,
+                        natural_t memory_budget, HyperSphericalCoeffs& out, Workspace& workspace);
+
+  /**
+   * Number of rotation invariant descriptors of a shape: one per (n, l) with l <= n < plan.n_max()
+   */
+  static natural_t descriptor_size(const HyperSpharmPlan& plan);
+  /**
+   * Index of the descriptor of (n, l) in a descriptor row: n (n + 1) / 2 + l
+   */
+  static inline natural_t descriptor_index(const natural_t n, const natural_t l)
+  {
+    return ((n * (n + 1)) / 2) + l;
+  }
+  /**
+   * Computes the rotation invariant energies E_nl = sum_{m = -l}^{l} |f_nlm|^2 of the real function
+   * sampled by the surface (|f_nl-m| = |f_nlm|).
+   *
+   * The energies are accumulated inside the Gegenbauer contraction: the coefficients are never stored.
+   * @param plan
+   * @param surface
+   * @return descriptor_size(plan) energies (see descriptor_index)
+   * @throw invalid_argument if the surface does not have the size and grid of the plan
+   */
+  static std::vector<float> descriptors(const HyperSpharmPlan& plan, const HyperSphericalSurface& surface);
+  /**
+   * Same as above for a batch of shapes: the spherical stage of the shapes is batched and the
+   * Gegenbauer stage is parallel over (shape, l)
+   * @param plan
+   * @param surfaces array of count surfaces
+   * @param count number of surfaces
+   * @param out count x descriptor_size(plan) row major matrix receiving the descriptors
+   * @throw invalid_argument if a surface does not have the size and grid of the plan
+   */
+  static void descriptors_batch(const HyperSpharmPlan& plan, const HyperSphericalSurface* surfaces,
+                                natural_t count, float* out);
+  /**
+   * Same as above with the scratch buffers carved from a workspace of at least required_bytes(plan)
+   */
+  static void descriptors_batch(const HyperSpharmPlan& plan, const HyperSphericalSurface* surfaces,
+                                natural_t count, float* out, Workspace& workspace);
+  /**
+   * Synthesizes the real function described by the coefficients f_nlm (m >= 0) on the grid of
+   * n_max hyperangles and 2 * n_max inclinations and azimuths (rounded up to a power of two):
+   * Gegenbauer sum over n, Legendre sum over l, then inverse fft over phi.
+   * @param coeffs
+   * @return HyperSphericalSurface on the equiangular grid
+   */
+  static HyperSphericalSurface transform(const HyperSphericalCoeffs& coeffs);
+  /**
+   * Synthesizes the surface described by the plan from the coefficients with n < plan.n_max()
+   * @param plan
+   * @param coeffs
+   * @return HyperSphericalSurface of size plan.theta_nb() x plan.psi_nb() x plan.phi_nb()
+   */
+  static HyperSphericalSurface transform(const HyperSpharmPlan& plan, const HyperSphericalCoeffs& coeffs);
+  /**
+   * Same as above with the scratch buffers carved from a workspace of at least required_bytes(plan):
+   * no heap allocation when out already has the size and grid of the plan
+   */
+  static void transform(const HyperSpharmPlan& plan, const HyperSphericalCoeffs& coeffs,
+                        HyperSphericalSurface& out, Workspace& workspace);
+
+private:
+  /** Number of shapes whose spherical stages are batched together by descriptors_batch */
+  static const natural_t DESCRIPTOR_BLOCK_SIZE;
+
+  typedef struct
+  {
+    natural_t l;
+    natural_t m;
+  } Order;
+
+  /**
+   * Returns the number of (l, m) computed with the plan
+   */
+  static natural_t get_order_nb(const HyperSpharmPlan& plan);
+  /**
+   * Returns the (l, m) computed with the plan, the work items of the Gegenbauer stage, carved from the workspace
+   */
+  static Order* get_orders(const HyperSpharmPlan& plan, Workspace& workspace);
+
+  /**
+   * Throws invalid_argument if the surface does not have the size and grid of the plan
+   */
+  static void check_surface(const HyperSpharmPlan& plan, const HyperSphericalSurfaceView& surface);
+
+  /**
+   * Returns views of count consecutive hyperangle slices of raw values (HyperSphericalSurface order),
+   * carved from the workspace
+   */
+  static SphericalSurfaceView* get_slices(const HyperSpharmPlan& plan, const real_t* values, natural_t count,
+                                          Workspace& workspace);
+  /**
+   * Returns the number of spherical coefficients of a slice (SphericalHarmonics of degree sphere_plan().l_max())
+   */
+  static natural_t get_slice_coeffs_size(const HyperSpharmPlan& plan);
+  /**
+   * Returns the workspace bytes of count slice views and of their spherical coefficients
+   */
+  static natural_t get_slices_bytes(const HyperSpharmPlan& plan, natural_t count);
+  /**
+   * Returns the workspace bytes of descriptors_batch for blocks of block_size shapes
+   */
+  static natural_t get_descriptors_bytes(const HyperSpharmPlan& plan, natural_t block_size);
+  /**
+   * Gives the coefficients the layout and n_max of the plan, all set to 0 (reallocated only if needed)
+   */
+  static void prepare_coeffs(const HyperSpharmPlan& plan, HyperSphericalCoeffs& coeffs);
+
+  /**
+   * Adds the Gegenbauer contraction of the hyperangles [first, first + count) to the coefficients
+   * @param plan
+   * @param slice_harmonics spherical coefficients of the count hyperangles (see get_slice_coeffs_size)
+   * @param first index of the first hyperangle
+   * @param count
+   * @param coeffs
+   * @param workspace
+   */
+  static void accumulate_gegenbauer(const HyperSpharmPlan& plan, const complex_t* slice_harmonics,
+                                    natural_t first, natural_t count, HyperSphericalCoeffs& coeffs,
+                                    Workspace& workspace);
+
+  /**
+   * Returns the number of hyperangles of the out of core slabs fitting in the memory budget
+   */
+  static natural_t get_slab_size(const HyperSpharmPlan& plan, natural_t memory_budget);
+};
+
+}
@@ -0,0 +1,89 @@
+/**
+ * @file hypersphere_mapping.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Mapping of 3D data (voxel grids, point clouds) onto the 3-sphere
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "types.h"
+#include "hyperspharm.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Non owning view of a voxel grid
+ */
+typedef struct
+{
+  const real_t* values; /*!< x_nb * y_nb * z_nb samples, x fastest: values[(z * y_nb + y) * x_nb + x] */
+  natural_t x_nb;
+  natural_t y_nb;
+  natural_t z_nb;
+} VolumeView;
+
+/**
+ * @brief Resampling of the voxel grids
+ */
+enum class Interpolation
+{
+  Nearest,  /*!< value of the closest voxel */
+  Trilinear /*!< trilinear interpolation of the 8 surrounding voxels */
+};
+
+/**
+ * @brief Maps 3D data onto the hyperspherical grid, the radius being the hyperangle beta
+ *
+ * The point at distance r from the center in the direction (psi, phi) is sampled at the
+ * hyperangle beta = pi r / radius: the center of the ball maps to the north pole of the 3-sphere,
+ * its boundary to the south pole.
+ */
+class HyperSphereMapping
+{
+public:
+  /**
+   * Resamples the ball inscribed in the volume (centered on the center of the grid, with a radius of
+   * (min(x_nb, y_nb, z_nb) - 1) / 2 voxels) at every point of the surface, writing into its values.
+   *
+   * The surface is processed by tiles of hyperangles x inclinations (in parallel), the directions of a
+   * tile being reused for all its hyperangles.
+   * @param volume
+   * @param surface receives the resampled values
+   * @param interpolation
+   * @throw invalid_argument if the volume is empty
+   */
+  static void map_volume(const VolumeView& volume, HyperSphericalSurface& surface,
+                         Interpolation interpolation = Interpolation::Trilinear);
+
+  /**
+   * Adds the weight of every point to the closest sample of the surface (nearest binning, in parallel).
+   * The points farther than radius from the origin are ignored.
+   * @param points count x 3 coordinates (x, y, z) relative to the center of the ball
+   * @param weights count weights, or nullptr to count the points
+   * @param count number of points
+   * @param radius radius of the ball mapped onto the 3-sphere
+   * @param surface histogram receiving the weights
+   * @throw invalid_argument if radius is not positive
+   */
+  static void bin_points(const real_t* points, const real_t* weights, natural_t count, real_t radius,
+                         HyperSphericalSurface& surface);
+
+private:
+  static const natural_t BETA_BLOCK_SIZE;
+  static const natural_t PSI_BLOCK_SIZE;
+
+  /**
+   * Returns the index of the closest value in the sorted values
+   */
+  static natural_t get_closest(const std::vector<real_t>& values, real_t value);
+};
+
+}
@@ -9,16 +9,20 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 #include "utils.h"
 #include "types.h"
+#include "aligned_allocator.h"
 
 
 namespace hyperspharm
 {
 
-class NormalizedLegendreArray;
+template<class Alloc = AlignedAllocator<real_t>>
+class BasicNormalizedLegendreArray;
+typedef BasicNormalizedLegendreArray<> NormalizedLegendreArray;
 
 class LegendrePoly
 {
@@ -42,6 +46,24 @@ public:
   static NormalizedLegendreArray get_norm_array(const real_t normalization_coeff,
                                                 const natural_t l_max,
                                                 const real_t x);
+  /**
+   * Same as get_norm_array but only the orders m <= m_max are computed, the others are left to 0
+   */
+  static NormalizedLegendreArray get_norm_array(const real_t normalization_coeff,
+                                                const natural_t l_max,
+                                                const natural_t m_max,
+                                                const real_t x);
+
+  /**
+   * Computes the normalized values of the single order m at x, for l in [m, l_max] (out receives
+   * l_max - m + 1 values). Same values as get_norm_array without the O(l_max^2) table.
+   * The first call for a given l_max computes the shared recurrence coefficients: it must not run concurrently.
+   */
+  static void get_norm_order(const real_t normalization_coeff,
+                             const natural_t l_max,
+                             const natural_t m,
+                             const real_t x,
+                             real_t* out);
 
   static NormalizedLegendreArray get_fully_norm_array(const natural_t l_max,
                                                       const real_t x);
@@ -54,15 +76,18 @@ private:
   static std::vector<std::vector<LegendrePoly::coeff>> coeffs_;
 };
 
-class NormalizedLegendreArray
+template<class Alloc>
+class BasicNormalizedLegendreArray
 {
 friend LegendrePoly;
 
 public:
-  explicit NormalizedLegendreArray(const natural_t l_max);
+  typedef Alloc allocator_type;
 
-  NormalizedLegendreArray (NormalizedLegendreArray&& other) noexcept;
-  NormalizedLegendreArray& operator= (NormalizedLegendreArray&& other) noexcept;
+  explicit BasicNormalizedLegendreArray(const natural_t l_max);
+
+  BasicNormalizedLegendreArray (BasicNormalizedLegendreArray&& other) noexcept;
+  BasicNormalizedLegendreArray& operator= (BasicNormalizedLegendreArray&& other) noexcept;
 
   real_t get(const natural_t l, const integer_t m) const;
   real_t unsafe_get(const natural_t l, const natural_t m) const;
@@ -72,7 +97,82 @@ public:
   natural_t l_max() const;
 private:
   natural_t l_max_;
-  std::vector<std::vector<real_t>> values_;
+  std::vector<std::vector<real_t, Alloc>> values_;
 };
 
+template<class Alloc>
+BasicNormalizedLegendreArray<Alloc>::BasicNormalizedLegendreArray(const natural_t l_max) :
+  l_max_(l_max)
+{
+  values_.resize(l_max + 1);
+  for (auto& value : values_)
+  {
+    value.resize(l_max + 1);
+  }
+}
+
+template<class Alloc>
+real_t BasicNormalizedLegendreArray<Alloc>::get(const natural_t l, const integer_t m) const
+{
+  if((static_cast<natural_t>(std::abs(m)) > l )|| l > l_max_)
+  {
+    return 0;
+  }
+
+  return ((m >= 0) || is_even(m)) ? values_[m][l] : -values_[m][l];
+}
+
+template<class Alloc>
+real_t BasicNormalizedLegendreArray<Alloc>::unsafe_get(const natural_t l, const natural_t m) const
+{
+  return values_[m][l];
+}
+
+template<class Alloc>
+void BasicNormalizedLegendreArray<Alloc>::set(const natural_t l, const integer_t m, const real_t x)
+{
+  if((static_cast<natural_t>(std::abs(m)) > l )|| l > l_max_)
+  {
+    return;
+  }
+  if (m >= 0)
+  {
+    values_[m][l] =  x;
+  }
+  else
+  {
+    values_[m][l] =  is_even(m) ? x : -x;
+  }
+}
+
+template<class Alloc>
+void BasicNormalizedLegendreArray<Alloc>::unsafe_set(const natural_t l, const natural_t m, const real_t x)
+{
+  values_[m][l] =  x;
+}
+
+template<class Alloc>
+BasicNormalizedLegendreArray<Alloc>::BasicNormalizedLegendreArray(BasicNormalizedLegendreArray &&other) noexcept :
+  l_max_(other.l_max_)
+{
+  values_ = std::move(other.values_);
+}
+
+template<class Alloc>
+BasicNormalizedLegendreArray<Alloc> &BasicNormalizedLegendreArray<Alloc>::operator=(BasicNormalizedLegendreArray &&other) noexcept
+{
+  if (this != &other)
+  {
+    l_max_ = other.l_max_;
+    values_ = std::move(other.values_);
+  }
+  return *this;
+}
+
+template<class Alloc>
+natural_t BasicNormalizedLegendreArray<Alloc>::l_max() const
+{
+  return l_max_;
+}
+
 }
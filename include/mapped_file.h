@@ -0,0 +1,65 @@
+/**
+ * @file mapped_file.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Read only memory mapping of a file
+ */
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include "types.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Read only memory mapping of a whole file
+ *
+ * The pages are only loaded when accessed: will_need and dont_need let the streaming
+ * algorithms prefetch the next chunk and release the processed ones.
+ */
+class MappedFile
+{
+public:
+  /**
+   * Maps the file
+   * @param path
+   * @throw runtime_error if the file cannot be opened or mapped
+   */
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  const char* data() const;
+  natural_t size() const;
+
+  /**
+   * Asks the kernel to read the range ahead (asynchronously)
+   * @param offset in bytes
+   * @param length in bytes
+   */
+  void will_need(natural_t offset, natural_t length) const;
+  /**
+   * Releases the pages of the range from the process (they are reloaded from the file if accessed again).
+   * A partial last page is kept (it may hold the start of the next range)
+   * @param offset in bytes
+   * @param length in bytes
+   */
+  void dont_need(natural_t offset, natural_t length) const;
+
+private:
+  char* data_;
+  natural_t size_;
+
+  void advise(natural_t offset, natural_t length, int advice) const;
+};
+
+}
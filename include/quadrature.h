@@ -0,0 +1,112 @@
+/**
+ * @file quadrature.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Quadrature rules over the inclination theta
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "fft.h"
+#include "utils.h"
+#include "types.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Sampling of the inclination theta in [0, pi]
+ */
+enum class GridType
+{
+  Equiangular,    /*!< theta_k = pi * k / n, k in [0, n) (Driscoll-Healy) */
+  ClenshawCurtis, /*!< theta_k = pi * k / (n - 1), k in [0, n) (both poles included) */
+  GaussLegendre   /*!< cos(theta_k) are the roots of P_n */
+};
+
+/**
+ * @brief Nodes and weights of a quadrature rule
+ *
+ * \int_0^\pi f(theta) sin(theta) dtheta ~= \sum_k weights[k] * f(thetas[k])
+ * The thetas are sorted in increasing order.
+ */
+typedef struct
+{
+  std::vector<real_t> thetas;
+  std::vector<real_t> weights;
+} QuadratureRule;
+
+class Quadrature
+{
+public:
+  /**
+   * Returns the quadrature rule of the grid type with n nodes
+   * @param type
+   * @param n number of nodes
+   * @return QuadratureRule
+   * @throw invalid_argument if n is too small for the grid type
+   */
+  static QuadratureRule get(GridType type, natural_t n);
+
+  /**
+   * Returns the nodes of the grid type without computing the weights
+   * @param type
+   * @param n number of nodes
+   * @return thetas sorted in increasing order
+   */
+  static std::vector<real_t> get_thetas(GridType type, natural_t n);
+
+  /**
+   * Driscoll-Healy rule (http://dx.doi.org/10.1006/aama.1994.1008), exact for the
+   * spherical harmonics of degree l < n / 2.
+   * The weights are computed in O(n log(n)) with an inverse fft when n is a power of two.
+   */
+  static QuadratureRule equiangular(natural_t n);
+
+  /**
+   * Clenshaw-Curtis rule, exact for the polynomials in cos(theta) of degree <= n - 1.
+   * The weights are computed in O(n log(n)) with an fft when n - 1 is a power of two.
+   * @throw invalid_argument if n < 2
+   */
+  static QuadratureRule clenshaw_curtis(natural_t n);
+
+  /**
+   * Gauss-Legendre rule, exact for the polynomials in cos(theta) of degree <= 2n - 1.
+   * The nodes are found with Newton iterations on P_n.
+   * @throw invalid_argument if n < 1
+   */
+  static QuadratureRule gauss_legendre(natural_t n);
+
+  /**
+   * Gauss-Chebyshev rule of the second kind over the hyperangle beta with the measure sin^2(beta):
+   * \int_0^\pi f(beta) sin^2(beta) dbeta ~= \sum_k weights[k] * f(betas[k]) with betas[k] = pi * (k + 1) / (n + 1).
+   * Exact for the polynomials in cos(beta) of degree <= 2n - 1. The nodes are symmetric about pi / 2.
+   * @throw invalid_argument if n < 1
+   */
+  static QuadratureRule gauss_chebyshev(natural_t n);
+
+private:
+  static const natural_t NEWTON_MAX_ITERATIONS;
+
+  /**
+   * Computes (4 / pi) \sum_{l < n/2} sin((2l + 1) theta_k) / (2l + 1) for theta_k = pi * k / n
+   * @param n
+   * @return Chebychev weights
+   */
+  static std::vector<real_t> compute_cheb_weights(natural_t n);
+
+  /**
+   * Computes \sum_{j=1}^{N/2} b_j cos(2 pi j k / N) / (4j^2 - 1) for k in [0, N]
+   * with b_j = 1 if j == N / 2, 2 otherwise
+   * @param N number of intervals
+   */
+  static std::vector<real_t> compute_clenshaw_curtis_sums(natural_t N);
+};
+
+}
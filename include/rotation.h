@@ -0,0 +1,116 @@
+/**
+ * @file rotation.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Rotations of spherical harmonics in the spectral domain
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "types.h"
+#include "spharms.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Wigner small d matrices d^l_{m m'}(beta) for l <= l_max
+ *
+ * The values are computed with the three term recurrence in l (stable, O(l_max^3) in total),
+ * started from the closed forms at l = max(|m|, |m'|) evaluated in log space.
+ * The matrices of every degree are stored contiguously, row major: [m + l][m' + l].
+ *
+ * Convention: D^l_{m m'}(alpha, beta, gamma) = e^{-i m alpha} d^l_{m m'}(beta) e^{-i m' gamma}
+ * with d^1_{1 0}(beta) = -sin(beta) / sqrt(2).
+ */
+class WignerD
+{
+public:
+  /** Number of tables kept by get */
+  static const natural_t CACHE_SIZE;
+
+  WignerD(natural_t l_max, real_t beta);
+
+  /**
+   * Returns the tables of (l_max, beta), computed on the first call and then shared (thread safe)
+   * @param l_max
+   * @param beta
+   */
+  static std::shared_ptr<const WignerD> get(natural_t l_max, real_t beta);
+
+  /** Returns d^l_{m m'}(beta), |m| <= l and |m'| <= l */
+  inline real_t get(const natural_t l, const integer_t m, const integer_t m_prime) const
+  {
+    return matrix(l)[((m + static_cast<integer_t>(l)) * static_cast<integer_t>((2 * l) + 1)) +
+                     m_prime + static_cast<integer_t>(l)];
+  }
+  /** Returns the (2 l + 1) x (2 l + 1) matrix of the degree */
+  inline const real_t* matrix(const natural_t l) const
+  {
+    return values_.data() + offsets_[l];
+  }
+
+  natural_t l_max() const;
+  real_t beta() const;
+
+private:
+  natural_t l_max_;
+  real_t beta_;
+  std::vector<natural_t> offsets_;
+  aligned_vector<real_t> values_;
+
+  /** d^l_{m m'}(beta) at l = max(|m|, |m'|) */
+  static real_t get_seed(integer_t m, integer_t m_prime, real_t log_cos, real_t log_sin, bool zero_cos,
+                         bool zero_sin);
+};
+
+/**
+ * @brief Method used by the rotations
+ */
+enum class RotationMethod
+{
+  Direct,      /*!< with d(beta), whose tables are cached per (l_max, beta) */
+  QuarterTurns /*!< two 90 degree turns about y: d^l_{m m'}(beta) = i^(m - m') sum_k Delta_{k m} Delta_{k m'} e^{-i k beta}
+                    with Delta = d(pi / 2), whose tables only depend on l_max */
+};
+
+/**
+ * @brief Rotations of the spherical harmonics of real functions
+ *
+ * The rotated function is f'(x) = f(R^{-1} x) with R = R_z(alpha) R_y(beta) R_z(gamma) (z-y-z Euler angles):
+ * f'_lm = sum_{m'} D^l_{m m'}(alpha, beta, gamma) f_lm', the coefficients of the negative orders being
+ * f_l-m = (-1)^m conj(f_lm).
+ * A rotation costs O(l_max^3), without resampling the function.
+ */
+class SpharmRotation
+{
+public:
+  /**
+   * Returns the harmonics of the rotated function
+   * @param harmonics
+   * @param alpha
+   * @param beta
+   * @param gamma
+   * @param method
+   */
+  template<class T>
+  static BasicSphericalHarmonics<T> rotate(const BasicSphericalHarmonics<T>& harmonics, real_t alpha, real_t beta,
+                                           real_t gamma, RotationMethod method = RotationMethod::Direct);
+
+private:
+  /** Coefficients g_m of all the orders m in [-l, l] of the degree, times e^{-i m gamma} */
+  template<class T>
+  static void get_orders(const BasicSphericalHarmonics<T>& harmonics, natural_t l, real_t gamma, complex_t* orders);
+  /** Returns i^power */
+  static inline complex_t get_i_power(const integer_t power)
+  {
+    static const complex_t powers[4] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+    return powers[((power % 4) + 4) % 4];
+  }
+};
+
+}
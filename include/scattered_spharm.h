@@ -0,0 +1,155 @@
+/**
+ * @file scattered_spharm.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Spherical harmonics expansions at scattered points
+ */
+
+#pragma once
+
+#include <vector>
+#include "types.h"
+#include "aligned_allocator.h"
+#include "spharms.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Precomputed data shared by the evaluations at the same points
+ *
+ * The points are sorted by inclination theta and the points of the same latitude (equal theta) are grouped:
+ * the Legendre sums of a latitude are shared by its points.
+ * Also holds the coefficients of the recurrence of the spharm normalized Legendre functions
+ * P_l^m(x) = a_lm x P_{l-1}^m(x) - b_lm P_{l-2}^m(x), used by the Clenshaw sums.
+ */
+class ScatteredSpharmPlan
+{
+public:
+  /**
+   * @param thetas inclinations of the points, in [0, pi]
+   * @param psis azimuths of the points
+   * @param count number of points
+   * @param l_max largest degree of the expansions
+   */
+  ScatteredSpharmPlan(const real_t* thetas, const real_t* psis, natural_t count, natural_t l_max);
+
+  natural_t count() const;
+  natural_t l_max() const;
+  natural_t latitude_nb() const;
+
+  /** Position of the sorted point in the input */
+  inline natural_t point_index(const natural_t sorted_i) const { return order_[sorted_i]; }
+  /** Azimuth of the sorted point */
+  inline real_t psi(const natural_t sorted_i) const { return psis_[sorted_i]; }
+  /** The points of the latitude are the sorted points [latitude_begin(i), latitude_begin(i + 1)) */
+  inline natural_t latitude_begin(const natural_t latitude_i) const { return latitude_offsets_[latitude_i]; }
+  inline real_t latitude_cos(const natural_t latitude_i) const { return cos_thetas_[latitude_i]; }
+  inline real_t latitude_sin(const natural_t latitude_i) const { return sin_thetas_[latitude_i]; }
+
+  /** Recurrence coefficients, l in [m + 1, l_max + 2] */
+  inline real_t a(const natural_t l, const natural_t m) const { return a_[(m * (l_max_ + 3)) + l]; }
+  inline real_t b(const natural_t l, const natural_t m) const { return b_[(m * (l_max_ + 3)) + l]; }
+
+private:
+  natural_t count_;
+  natural_t l_max_;
+  std::vector<natural_t> order_;
+  aligned_vector<real_t> psis_;
+  std::vector<natural_t> latitude_offsets_;
+  aligned_vector<real_t> cos_thetas_;
+  aligned_vector<real_t> sin_thetas_;
+  aligned_vector<real_t> a_;
+  aligned_vector<real_t> b_;
+};
+
+/**
+ * @brief Evaluation of spherical harmonics expansions of real functions at arbitrary points
+ *
+ * f(theta, psi) = sum_l f_l0 Y_l0 + 2 Re(sum_{m > 0} f_lm Y_lm), Y_lm = P_l^m(cos(theta)) e^{i m psi}
+ * (spharm normalized Legendre functions, see LegendrePoly::get_spharm_normalized).
+ *
+ * The latitudes are processed by blocks of LATITUDE_BLOCK in parallel. For every order m, the Legendre sums
+ * S_m(theta) = sum_l f_lm P_l^m(cos(theta)) of the block are computed together by Clenshaw recurrences (vectorized
+ * over the latitudes), then the sums over m of every latitude are vectorized over its points.
+ * Evaluating P points on Q latitudes costs O(Q l_max^2 + P l_max), and so does the adjoint.
+ */
+class ScatteredSpharm
+{
+public:
+  /** Latitudes whose Legendre sums are computed together */
+  static const natural_t LATITUDE_BLOCK;
+
+  /**
+   * Evaluates the expansion at the points of the plan
+   * @param plan
+   * @param harmonics degrees above plan.l_max() are ignored
+   * @param out receives plan.count() values, in the order of the input points
+   */
+  static void evaluate(const ScatteredSpharmPlan& plan, const SphericalHarmonics& harmonics, real_t* out);
+  /**
+   * Same as above with a plan built for the points
+   * @param harmonics
+   * @param thetas
+   * @param psis
+   * @return the values at the points
+   * @throw invalid_argument if thetas and psis do not have the same size
+   */
+  static std::vector<real_t> evaluate(const SphericalHarmonics& harmonics, const std::vector<real_t>& thetas,
+                                      const std::vector<real_t>& psis);
+  /**
+   * Adjoint of evaluate for the real parameters of the expansion (Re(f_l0), Re(f_lm) and Im(f_lm) for m > 0):
+   * c_lm = sum_p values_p P_l^m(cos(theta_p)) e^{-i m psi_p}, the result holds Re(c_l0) and 2 c_lm for m > 0
+   * @param plan
+   * @param values plan.count() values, in the order of the input points
+   */
+  static SphericalHarmonics adjoint(const ScatteredSpharmPlan& plan, const real_t* values);
+
+  /**
+   * Least squares fit of the expansion of degree plan.l_max() to the samples:
+   * minimizes sum_p (f(theta_p, psi_p) - values_p)^2 + regularization ||f||^2 (L2 norm on the sphere).
+   * Conjugate gradients on the normal equations, every iteration applying evaluate and adjoint once
+   * (the normal matrix is never formed), preconditioned by the diagonal of the normal matrix of uniform samples.
+   * @param plan
+   * @param values plan.count() samples, in the order of the input points
+   * @param regularization >= 0, makes the fit well posed when the points do not determine all the coefficients
+   * @param max_iterations
+   * @param tolerance stops when the residual of the normal equations is reduced by this factor
+   * @throw invalid_argument if regularization is negative
+   */
+  static SphericalHarmonics fit(const ScatteredSpharmPlan& plan, const real_t* values, real_t regularization = 0.0,
+                                natural_t max_iterations = FIT_MAX_ITERATIONS, real_t tolerance = FIT_TOLERANCE);
+  /**
+   * Same as above with a plan built for the points
+   * @throw invalid_argument if thetas, psis and values do not have the same size or regularization is negative
+   */
+  static SphericalHarmonics fit(const std::vector<real_t>& thetas, const std::vector<real_t>& psis,
+                                const std::vector<real_t>& values, natural_t l_max, real_t regularization = 0.0);
+
+  /** Default iteration limit of fit */
+  static const natural_t FIT_MAX_ITERATIONS;
+  /** Default residual reduction of fit */
+  static const real_t FIT_TOLERANCE;
+
+private:
+  /**
+   * Computes the Legendre sums S_m of the latitudes [first, first + nb) for m <= l_max
+   * @param sums receives (l_max + 1) x LATITUDE_BLOCK values [m][latitude - first]
+   */
+  static void compute_legendre_sums(const ScatteredSpharmPlan& plan, const SphericalHarmonics& harmonics,
+                                    natural_t first, natural_t nb, complex_t* sums);
+  /**
+   * Transpose of compute_legendre_sums: coefficients[l (l + 1) / 2 + m] += sum_latitude P_l^m(cos(theta)) sums[m][latitude - first]
+   */
+  static void add_legendre_products(const ScatteredSpharmPlan& plan, natural_t first, natural_t nb,
+                                    const complex_t* sums, complex_t* coefficients);
+  /** Loads cos(theta), sin(theta) of the block (padded with its last latitude) and P_0^0 */
+  static void get_block(const ScatteredSpharmPlan& plan, natural_t first, natural_t nb,
+                        real_t* x, real_t* sin_theta, real_t* seed);
+  /** Real inner product of the parameters of the expansions (Re(f_l0), Re(f_lm) and Im(f_lm) for m > 0) */
+  static real_t get_dot(const SphericalHarmonics& left, const SphericalHarmonics& right);
+};
+
+}
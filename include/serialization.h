@@ -0,0 +1,143 @@
+/**
+ * @file serialization.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Binary file format of the surfaces and coefficient sets
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "types.h"
+#include "spharms.h"
+#include "hyperspharm.h"
+#include "mapped_file.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Container stored in a binary file
+ */
+enum class ContainerType : uint8_t
+{
+  SphericalSurface = 1,
+  SphericalHarmonics = 2,
+  HyperSphericalSurface = 3,
+  HyperSphericalCoeffs = 4
+};
+
+/**
+ * @brief Type of the stored values
+ */
+enum class ScalarType : uint8_t
+{
+  Float32 = 1,
+  Float64 = 2,
+  Complex64 = 3,  /*!< std::complex<float> */
+  Complex128 = 4  /*!< std::complex<double> */
+};
+
+/**
+ * @brief Decoded header of a binary file
+ */
+typedef struct
+{
+  natural_t version;
+  ContainerType type;
+  ScalarType scalar;
+  GridType grid;       /*!< surfaces only */
+  CoeffsLayout layout; /*!< hyperspherical coefficients only */
+  natural_t dims[3];   /*!< rows, cols | l_max | theta_nb, psi_nb, phi_nb | n_max, l_max, m_max */
+  natural_t payload_offset; /*!< in bytes, multiple of BinaryFile::PAYLOAD_ALIGNMENT */
+  natural_t payload_bytes;
+} BinaryHeader;
+
+/**
+ * @brief Binary file holding one container, read through a memory mapping
+ *
+ * Layout (every field little-endian):
+ *  - 0: magic "HSPH"
+ *  - 4: uint16 version
+ *  - 6: uint8 container type, 7: uint8 scalar type, 8: uint8 grid type, 9: uint8 coefficients layout
+ *  - 16, 24, 32: uint64 dimensions (see BinaryHeader)
+ *  - 40: uint64 payload offset, 48: uint64 payload size in bytes
+ *  - payload: the values in the storage order of the container, aligned on PAYLOAD_ALIGNMENT bytes
+ *
+ * The views returned by the loaders point into the mapping (no copy, the pages are only read when
+ * accessed): they are valid while the BinaryFile is alive.
+ * The payload is stored with the native layout of the values, the files can only be written and
+ * mapped on little-endian hosts.
+ */
+class BinaryFile
+{
+public:
+  static const natural_t VERSION;
+  static const natural_t HEADER_SIZE;
+  static const natural_t PAYLOAD_ALIGNMENT;
+
+  /**
+   * Maps the file and checks its header
+   * @param path
+   * @throw runtime_error if the file cannot be mapped or is not a valid binary file
+   */
+  explicit BinaryFile(const std::string& path);
+
+  const BinaryHeader& header() const;
+  ContainerType type() const;
+  ScalarType scalar() const;
+  /** The mapping, e.g. for HyperSpharm::transform(plan, file, payload_offset(), memory_budget) */
+  const MappedFile& file() const;
+  natural_t payload_offset() const;
+
+  /**
+   * Loaders returning a view of the payload
+   * @throw runtime_error if the file does not hold this container with this scalar type
+   */
+  template<class T>
+  BasicSphericalSurfaceView<T> spherical_surface() const;
+  template<class T>
+  BasicSphericalHarmonicsView<T> spherical_harmonics() const;
+  HyperSphericalSurfaceView hyperspherical_surface() const;
+  HyperSphericalCoeffsView hyperspherical_coeffs() const;
+
+  /**
+   * Writers (the file is replaced)
+   * @throw runtime_error if the file cannot be written
+   */
+  template<class T>
+  static void save(const std::string& path, const BasicSphericalSurface<T>& surface);
+  template<class T>
+  static void save(const std::string& path, const BasicSphericalHarmonics<T>& harmonics);
+  static void save(const std::string& path, const HyperSphericalSurface& surface);
+  static void save(const std::string& path, const HyperSphericalCoeffs& coeffs);
+
+  static bool is_little_endian();
+  /** Little-endian encoding of the header fields (bytes <= 8) */
+  static void store(char* destination, natural_t value, natural_t bytes);
+  static natural_t load(const char* source, natural_t bytes);
+
+private:
+  MappedFile file_;
+  BinaryHeader header_;
+
+  const char* payload(ContainerType type, ScalarType scalar) const;
+
+  static BinaryHeader make_header(ContainerType type, ScalarType scalar, GridType grid, CoeffsLayout layout,
+                                  natural_t dim0, natural_t dim1, natural_t dim2, natural_t payload_bytes);
+  static void write(const std::string& path, const BinaryHeader& header, const void* payload);
+  static BinaryHeader read_header(const MappedFile& file, const std::string& path);
+  /** Number of values of the payload described by the header, false if it overflows natural_t */
+  static bool get_value_nb(const BinaryHeader& header, natural_t& value_nb);
+  static natural_t get_scalar_size(ScalarType scalar);
+  /** Scalar types of the values T and std::complex<T> (float or double) */
+  template<class T>
+  static ScalarType get_real_scalar();
+  template<class T>
+  static ScalarType get_complex_scalar();
+};
+
+}
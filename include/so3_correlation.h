@@ -0,0 +1,90 @@
+/**
+ * @file so3_correlation.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Rotational alignment of spherical functions
+ */
+
+#pragma once
+
+#include "types.h"
+#include "aligned_allocator.h"
+#include "spharms.h"
+#include "rotation.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Rotation found by an alignment: g rotated by (alpha, beta, gamma) (see SpharmRotation) matches f
+ */
+typedef struct
+{
+  real_t alpha;
+  real_t beta;       /*!< in [0, pi] */
+  real_t gamma;
+  real_t correlation;
+} RotationMatch;
+
+/**
+ * @brief Correlation C(R) = integral of f(x) g(R^{-1} x) over the sphere, for every rotation R
+ *
+ * With the two quarter turns decomposition of the Wigner d matrices (see RotationMethod::QuarterTurns),
+ * C(alpha, beta, gamma) = sum_{m, k, m'} T(m, k, m') e^{i (m alpha + k beta + m' gamma)} with
+ * T(m, k, m') = sum_l i^(m' - m) Delta^l_{k m} Delta^l_{k m'} f_lm conj(g_lm').
+ * The correlation at the size^3 angles (2 pi a / size, 2 pi b / size, 2 pi c / size) is obtained by an
+ * inverse 3D fft of T: O(l_max^4) for T and O(l_max^3 log(l_max)) for the fft, instead of O(l_max^6)
+ * for a rotation and a comparison per angle.
+ */
+class SO3Correlation
+{
+public:
+  /** Number of angles of the grid per dimension: the power of two >= 2 l_max + 1 */
+  static natural_t get_grid_size(natural_t l_max);
+
+  /**
+   * Returns the correlation of f and g rotated by (alpha, beta, gamma)
+   * @param f
+   * @param g
+   * @param alpha
+   * @param beta
+   * @param gamma
+   */
+  static real_t correlation(const SphericalHarmonics& f, const SphericalHarmonics& g,
+                            real_t alpha, real_t beta, real_t gamma);
+  /**
+   * Returns the correlations on the grid of get_grid_size(l_max)^3 angles, stored [alpha][beta][gamma].
+   * The betas cover [0, 2 pi): (alpha, beta, gamma) and (alpha + pi, 2 pi - beta, gamma + pi) are the same rotation.
+   * @param f
+   * @param g
+   * @param l_max degrees used, at most the ones of f and g (the grid holds O(l_max^3) values)
+   */
+  static aligned_vector<real_t> correlation_grid(const SphericalHarmonics& f, const SphericalHarmonics& g,
+                                                 natural_t l_max);
+  /**
+   * Returns the rotation maximizing the correlation on the grid, optionally refined by a local search
+   * on the exact correlation
+   * @param f
+   * @param g
+   * @param refine
+   */
+  static RotationMatch best_rotation(const SphericalHarmonics& f, const SphericalHarmonics& g, bool refine = true);
+  /**
+   * Same as above with the grid of the degrees l <= l_max (the refinement uses all the degrees)
+   */
+  static RotationMatch best_rotation(const SphericalHarmonics& f, const SphericalHarmonics& g, natural_t l_max,
+                                     bool refine);
+
+  /** Smallest step (in radians) of the local search */
+  static const real_t REFINE_TOLERANCE;
+
+private:
+  /** Inner product of the real functions (the negative orders included) */
+  static real_t inner_product(const SphericalHarmonics& f, const SphericalHarmonics& g);
+  /** Returns the same rotation with beta in [0, pi] and the angles in [0, 2 pi) */
+  static RotationMatch normalize(RotationMatch match);
+};
+
+}
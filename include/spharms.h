@@ -12,93 +12,712 @@
 #include <algorithm>
 #include <vector>
 #include <iomanip>
+#include <sstream>
 #include <cmath>
 #include <functional>
+#include <limits>
 #include "fft.h"
 #include "utils.h"
 #include "types.h"
+#include "aligned_allocator.h"
 #include "legendre.h"
+#include "quadrature.h"
+#include "flt.h"
+#include "workspace.h"
 
 
 namespace hyperspharm
 {
 
+/**
+ * @brief Non owning view of a sphere
+ *
+ * rows x cols values laid out like a SphericalSurface, with row_stride values between the starts of two rows.
+ * The viewed values must outlive the view.
+ */
+template<class T>
+class BasicSphericalSurfaceView
+{
+public:
+  typedef T scalar_t;
+
+  BasicSphericalSurfaceView(const T* data, natural_t rows, natural_t cols, natural_t row_stride,
+                            GridType grid = GridType::Equiangular) :
+    data_(data), rows_(rows), cols_(cols), row_stride_(row_stride), grid_(grid)
+  {
+  }
+
+  inline T get(const natural_t theta_n, const natural_t psi_m) const
+  {
+    return data_[(theta_n * row_stride_) + psi_m];
+  }
+
+  /** Returns the cols contiguous values of the row */
+  inline const T* row(const natural_t theta_n) const
+  {
+    return data_ + (theta_n * row_stride_);
+  }
+
+  const T* data() const { return data_; }
+  natural_t rows() const { return rows_; }
+  natural_t cols() const { return cols_; }
+  natural_t row_stride() const { return row_stride_; }
+  GridType grid() const { return grid_; }
+
+private:
+  const T* data_;
+  natural_t rows_;
+  natural_t cols_;
+  natural_t row_stride_;
+  GridType grid_;
+};
+
 /**
  * @brief Sphere Container 
  * 
  * Contains NxM values corresponding to the radius_nm for the different angles theta_n (inclination), psi_m (azimuth)
- * 
+ * The inclinations are sampled according to the grid type (equiangular by default)
+ * The radii are stored with the scalar type T (float or double), allocated by Alloc
+ * (64-byte aligned by default, HugePageAllocator for the large surfaces)
  */
-class SphericalSurface
+template<class T, class Alloc = AlignedAllocator<T>>
+class BasicSphericalSurface
 {
 public:
-  SphericalSurface(const natural_t rows, const natural_t cols);
-  SphericalSurface(const natural_t rows, const natural_t cols, const real_t init_val);
+  typedef T scalar_t;
+  typedef Alloc allocator_type;
+
+  BasicSphericalSurface(const natural_t rows, const natural_t cols);
+  BasicSphericalSurface(const natural_t rows, const natural_t cols, const T init_val);
+  BasicSphericalSurface(const natural_t rows, const natural_t cols, const GridType grid);
+  BasicSphericalSurface(const natural_t rows, const natural_t cols, const T init_val, const GridType grid);
   
-  real_t get(const natural_t theta_n, const natural_t psi_m) const;
-  void set(const natural_t theta_n, const natural_t psi_m, const real_t radius_nm);
+  T get(const natural_t theta_n, const natural_t psi_m) const;
+  void set(const natural_t theta_n, const natural_t psi_m, const T radius_nm);
 
   natural_t rows() const;
   natural_t cols() const;
+  GridType grid() const;
 
   std::vector<real_t> thetas() const;
   std::vector<real_t> psis() const;
 
-  std::vector<complex_t> get_psi_array(const natural_t theta_n) const;
-  void map(std::function<real_t ()>);
-  void map(std::function<real_t (const real_t old_val)>);
-  void map(std::function<real_t (const natural_t theta_n, const natural_t psi_m, const real_t old_val)>);
+  std::vector<std::complex<T>> get_psi_array(const natural_t theta_n) const;
+  /** Contiguous values of a latitude (cols values), valid while the surface is not resized */
+  inline T* row(const natural_t theta_n) { return values_.data() + (theta_n * cols_); }
+  inline const T* row(const natural_t theta_n) const { return values_.data() + (theta_n * cols_); }
+  /** Raw values, theta major (rows x cols) */
+  T* data() { return values_.data(); }
+  const T* data() const { return values_.data(); }
+  std::vector<T, Alloc>& values();
+  const std::vector<T, Alloc>& values() const;
+  /** Returns a view of the surface (valid while the surface is alive and not resized) */
+  BasicSphericalSurfaceView<T> view() const;
+  /** The std::function maps call func sequentially, in storage order */
+  void map(std::function<T ()>);
+  void map(std::function<T (const T old_val)>);
+  void map(std::function<T (const natural_t theta_n, const natural_t psi_m, const T old_val)>);
+
+  /**
+   * Sets every value to func(theta, psi, old_val), theta and psi being the angles of the sample.
+   * The rows are processed in parallel: func must be safe to call concurrently.
+   * @param func any callable, inlined in the loops
+   */
+  template<class F>
+  void parallel_map(F func)
+  {
+    const auto theta_values = thetas();
+    const auto psi_values = psis();
+    const natural_t cols = cols_;
+    T* values = values_.data();
+#pragma omp parallel for schedule(static)
+    for (natural_t theta_n = 0; theta_n < rows_; ++theta_n)
+    {
+      const real_t theta = theta_values[theta_n];
+      T* row = values + (theta_n * cols);
+      for (natural_t psi_m = 0; psi_m < cols; ++psi_m)
+      {
+        row[psi_m] = func(theta, psi_values[psi_m], row[psi_m]);
+      }
+    }
+  }
 
   std::string to_string();
 private:
   natural_t rows_;
   natural_t cols_;
-  std::vector<real_t> values_;
+  GridType grid_;
+  std::vector<T, Alloc> values_;
+};
+
+template<class T, class Alloc>
+BasicSphericalSurface<T, Alloc>::BasicSphericalSurface(const natural_t rows, const natural_t cols) :
+  rows_(rows), cols_(cols), grid_(GridType::Equiangular), values_(rows * cols)
+{
+}
+
+template<class T, class Alloc>
+BasicSphericalSurface<T, Alloc>::BasicSphericalSurface(const natural_t rows, const natural_t cols, const T init_val) :
+  rows_(rows), cols_(cols), grid_(GridType::Equiangular), values_(rows * cols, init_val)
+{
+}
+
+template<class T, class Alloc>
+BasicSphericalSurface<T, Alloc>::BasicSphericalSurface(const natural_t rows, const natural_t cols, const GridType grid) :
+  rows_(rows), cols_(cols), grid_(grid), values_(rows * cols)
+{
+}
+
+template<class T, class Alloc>
+BasicSphericalSurface<T, Alloc>::BasicSphericalSurface(const natural_t rows, const natural_t cols,
+                                                       const T init_val, const GridType grid) :
+  rows_(rows), cols_(cols), grid_(grid), values_(rows * cols, init_val)
+{
+}
+
+template<class T, class Alloc>
+T BasicSphericalSurface<T, Alloc>::get(natural_t theta_n, const natural_t psi_m) const
+{
+  return values_[cols_ * theta_n + psi_m];
+}
+
+template<class T, class Alloc>
+void BasicSphericalSurface<T, Alloc>::set(const natural_t theta_n, const natural_t psi_m, const T radius_nm)
+{
+  values_[cols_ * theta_n + psi_m] = radius_nm;
+}
+
+template<class T, class Alloc>
+std::vector<std::complex<T>> BasicSphericalSurface<T, Alloc>::get_psi_array(const natural_t theta_n) const
+{
+  const T* values = row(theta_n);
+  return std::vector<std::complex<T>>(values, values + cols_);
+}
+
+template<class T, class Alloc>
+std::vector<T, Alloc>& BasicSphericalSurface<T, Alloc>::values()
+{
+  return values_;
+}
+
+template<class T, class Alloc>
+const std::vector<T, Alloc>& BasicSphericalSurface<T, Alloc>::values() const
+{
+  return values_;
+}
+
+template<class T, class Alloc>
+BasicSphericalSurfaceView<T> BasicSphericalSurface<T, Alloc>::view() const
+{
+  return BasicSphericalSurfaceView<T>(values_.data(), rows_, cols_, cols_, grid_);
+}
+
+template<class T, class Alloc>
+natural_t BasicSphericalSurface<T, Alloc>::rows() const
+{
+  return rows_;
+}
+
+template<class T, class Alloc>
+natural_t BasicSphericalSurface<T, Alloc>::cols() const
+{
+  return cols_;
+}
+
+template<class T, class Alloc>
+GridType BasicSphericalSurface<T, Alloc>::grid() const
+{
+  return grid_;
+}
+
+template<class T, class Alloc>
+std::vector<real_t> BasicSphericalSurface<T, Alloc>::thetas() const
+{
+  return Quadrature::get_thetas(grid_, rows_);
+}
+
+template<class T, class Alloc>
+std::vector<real_t> BasicSphericalSurface<T, Alloc>::psis() const
+{
+  std::vector<real_t> result;
+  result.reserve(cols_);
+  for (natural_t psi_index = 0; psi_index < cols_; ++psi_index)
+  {
+    result.push_back(2.0 * M_PI * static_cast<real_t>(psi_index) / static_cast<real_t>(cols_));
+  }
+  return result;
+}
+
+template<class T, class Alloc>
+std::string BasicSphericalSurface<T, Alloc>::to_string()
+{
+  std::stringstream sstream;
+  sstream << std::scientific << std::setprecision(3) << std::left;
+  sstream << "Theta\\Psi";
+  for (unsigned int psi = 0; psi < cols_ ; ++psi)
+  {
+    sstream << std::setw(5) << std::right << (psi) << "/" <<
+               std::setw(3) << std::left << (cols_) << "pi";
+  }
+  sstream << std::endl;
+
+  for (unsigned int theta = 0; theta < rows_ ; ++theta)
+  {
+    sstream << std::setw(3) << std::right << (theta) << "/" <<
+               std::setw(3) << std::left << (rows_ - 1) << "pi : ";
+    for (unsigned int psi = 0; psi < cols_; ++psi)
+    {
+      sstream << std::setw(10) << get(theta, psi) << " ";
+    }
+    sstream << std::endl;
+  }
+  return sstream.str();
+}
+
+template<class T, class Alloc>
+void BasicSphericalSurface<T, Alloc>::map(std::function<T()> func)
+{
+  for(auto& value : values_)
+  {
+    value = func();
+  }
+}
+
+template<class T, class Alloc>
+void BasicSphericalSurface<T, Alloc>::map(std::function<T(const T old_val)> func)
+{
+  for(auto& value : values_)
+  {
+    value = func(value);
+  }
+}
+
+template<class T, class Alloc>
+void BasicSphericalSurface<T, Alloc>::map(std::function<T(const natural_t theta_n,
+                                                         const natural_t psi_m,
+                                                         const T old_val)> func)
+{
+  for (natural_t theta_n = 0; theta_n < rows_; ++theta_n)
+  {
+    T* row = values_.data() + (theta_n * cols_);
+    for (natural_t psi_m = 0; psi_m < cols_; ++psi_m)
+    {
+      row[psi_m] = func(theta_n, psi_m, row[psi_m]);
+    }
+  }
+}
+
+/**
+ * @brief Non owning view of spherical harmonics
+ *
+ * (l_max + 2) * (l_max + 1) / 2 coefficients laid out like a SphericalHarmonics.
+ * The viewed values must outlive the view.
+ */
+template<class T>
+class BasicSphericalHarmonicsView
+{
+public:
+  typedef T scalar_t;
+
+  BasicSphericalHarmonicsView(const std::complex<T>* data, natural_t l_max) :
+    data_(data), l_max_(l_max)
+  {
+  }
+
+  /** Returns 0 for l > l_max or m > l */
+  inline std::complex<T> get(const natural_t l, const natural_t m) const
+  {
+    if ((l > l_max_) || (m > l)) { return {0, 0}; }
+    return data_[(((l + 1) * l) / 2) + m];
+  }
+
+  const std::complex<T>* data() const { return data_; }
+  natural_t l_max() const { return l_max_; }
+
+private:
+  const std::complex<T>* data_;
+  natural_t l_max_;
 };
 
 /**
  * @brief Spherical Harmonics Container
  *
  * Contains (l_max + 2) * (l_max + 1)) / 2 values corresponding to all the spherical coefficients
- * of l order strictly smaller than l_max + 1
+ * of l order strictly smaller than l_max + 1, stored as std::complex<T> and allocated by Alloc
+ * (64-byte aligned by default)
  */
-class SphericalHarmonics
+template<class T, class Alloc = AlignedAllocator<std::complex<T>>>
+class BasicSphericalHarmonics
 {
 public:
-  explicit SphericalHarmonics(const natural_t l_max);
+  typedef T scalar_t;
+  typedef Alloc allocator_type;
+
+  explicit BasicSphericalHarmonics(const natural_t l_max);
 
   // TODO: Add possibility to input m negative
-  complex_t get(const natural_t l, const natural_t m) const;
-  void set(const natural_t l, const natural_t m, const complex_t value);
+  std::complex<T> get(const natural_t l, const natural_t m) const;
+  void set(const natural_t l, const natural_t m, const std::complex<T> value);
 
   natural_t l_max() const;
 
+  std::vector<std::complex<T>, Alloc>& values();
+  const std::vector<std::complex<T>, Alloc>& values() const;
+  /** Returns a view of the coefficients (valid while the container is alive and not resized) */
+  BasicSphericalHarmonicsView<T> view() const;
+
   std::string to_string();
 private:
   natural_t l_max_;
-  std::vector<complex_t> values_;
+  std::vector<std::complex<T>, Alloc> values_;
+};
+
+template<class T, class Alloc>
+BasicSphericalHarmonics<T, Alloc>::BasicSphericalHarmonics(const natural_t l_max) :
+  l_max_(l_max), values_(((l_max + 2)*(l_max + 1))/2)
+{
+}
+
+template<class T, class Alloc>
+std::complex<T> BasicSphericalHarmonics<T, Alloc>::get(const natural_t l, const natural_t m) const
+{
+  const size_t index = ((l+1) * l)/2 + m;
+  if(index >= values_.size())
+  {
+    return {0, 0};
+  }
+
+  return values_[index];
+}
+
+template<class T, class Alloc>
+void BasicSphericalHarmonics<T, Alloc>::set(const natural_t l, const natural_t m, const std::complex<T> value)
+{
+  const size_t index = ((l+1) * l)/2 + m;
+  if(index >= values_.size())
+  {
+    return;
+  }
+  values_[index] = value;
+}
+
+template<class T, class Alloc>
+natural_t BasicSphericalHarmonics<T, Alloc>::l_max() const
+{
+  return l_max_;
+}
+
+template<class T, class Alloc>
+std::vector<std::complex<T>, Alloc>& BasicSphericalHarmonics<T, Alloc>::values()
+{
+  return values_;
+}
+
+template<class T, class Alloc>
+const std::vector<std::complex<T>, Alloc>& BasicSphericalHarmonics<T, Alloc>::values() const
+{
+  return values_;
+}
+
+template<class T, class Alloc>
+BasicSphericalHarmonicsView<T> BasicSphericalHarmonics<T, Alloc>::view() const
+{
+  return BasicSphericalHarmonicsView<T>(values_.data(), l_max_);
+}
+
+template<class T, class Alloc>
+std::string BasicSphericalHarmonics<T, Alloc>::to_string()
+{
+  std::stringstream sstream;
+  sstream << std::scientific << std::setprecision(2);
+  sstream << " l\\m  ";
+  for (unsigned int m = 0; m < l_max_ ; ++m)
+  {
+    sstream << std::setw(11) << m << std::setw(9) << " ";
+  }
+  sstream << std::endl;
+
+  for (unsigned int l = 0; l < l_max_ ; ++l)
+  {
+    sstream << std::setw(3) << l << " : ";
+    for (unsigned int m = 0; m <= l; ++m)
+    {
+      sstream << std::setw(18) << get(l, m) << " ";
+    }
+    sstream << std::endl;
+  }
+  return sstream.str();
+}
+
+/**
+ * @brief Method used for the Legendre stage of the transforms
+ */
+enum class LegendreMethod
+{
+  Direct,   /*!< dense contraction with the Legendre tables */
+  Fast,     /*!< compressed Legendre matrices (fast Legendre transform) */
+  Automatic /*!< Fast when l_nb >= threshold, for the orders where the compression pays off */
+};
+
+/**
+ * @brief Options of the Legendre stage
+ */
+typedef struct
+{
+  LegendreMethod method;
+  real_t tolerance;    /*!< relative tolerance of the compressed Legendre matrices */
+  natural_t threshold; /*!< number of degrees from which LegendreMethod::Automatic compresses */
+} LegendreOptions;
+
+/**
+ * @brief Precomputed data shared by the transforms of all the surfaces with the same grid
+ *
+ * Holds the quadrature weights (including the fft normalization) and the spharm normalized
+ * Legendre values P_l^m(cos(theta)) of the northern half of the grid.
+ * The southern half is obtained through P_l^m(-x) = (-1)^(l+m) P_l^m(x).
+ *
+ * The Legendre values are stored contiguously for each m: [m][latitude][l - m]
+ *
+ * For large band limits, the Legendre matrices of each m (split by parity of l + m) can instead be
+ * compressed (see CompressedLegendreMatrix), which makes the Legendre stage cheaper than O(L^3).
+ * The compressed orders are built from the recurrence and have no dense table.
+ *
+ * The Legendre values are stored with the scalar type T: a float plan halves the memory traffic
+ * of the Legendre stage, the contraction sums being accumulated in double precision.
+ */
+template<class T>
+class BasicSpharmPlan
+{
+public:
+  /**
+   * Latitude of the northern half of the grid and its mirror (pi - theta) in the southern half
+   */
+  typedef struct
+  {
+    natural_t north;
+    natural_t south;
+    real_t north_weight;
+    real_t south_weight;
+  } Latitude;
+
+  static const natural_t NO_MIRROR;
+  /**
+   * Direct method: the benchmark (test_fast_legendre_transform) finds no band limit up to l_max = 1151
+   * from which the compressed matrices stay faster than the dense tables
+   */
+  static const LegendreOptions DEFAULT_LEGENDRE_OPTIONS;
+
+  BasicSpharmPlan(natural_t rows, natural_t cols);
+  /**
+   * Plan computing only the coefficients with l <= l_max and m <= m_max.
+   * The cost of the Legendre tables and of the contraction scales with the requested band limit.
+   * @param rows number of rows of the surfaces
+   * @param cols number of columns of the surfaces (power of two)
+   * @param l_max l_max of the resulting SphericalHarmonics (degrees above rows - 1 are left to 0)
+   * @param m_max maximum order computed
+   * @throw invalid_argument if cols is not a power of two
+   */
+  BasicSpharmPlan(natural_t rows, natural_t cols, natural_t l_max, natural_t m_max);
+  /**
+   * Same as above for surfaces sampled on the given grid type.
+   * A Gauss-Legendre grid only needs l_max + 1 rows where the equiangular one needs 2 * (l_max + 1)
+   */
+  BasicSpharmPlan(natural_t rows, natural_t cols, natural_t l_max, natural_t m_max, GridType grid);
+  BasicSpharmPlan(natural_t rows, natural_t cols, natural_t l_max, natural_t m_max, GridType grid,
+             const LegendreOptions& options);
+
+  natural_t rows() const;
+  natural_t cols() const;
+  natural_t l_max() const;
+  GridType grid() const;
+  /** Number of degrees l computed by the transforms */
+  natural_t l_nb() const;
+  /** Number of orders m computed by the transforms */
+  natural_t m_nb() const;
+
+  const std::vector<Latitude>& latitudes() const;
+  /**
+   * Returns the Legendre values P_l^m(cos(theta)) of the latitude for l in [m, l_nb)
+   * (only for the orders using the direct method, see compressed_plm)
+   * @param m order
+   * @param latitude_index index in latitudes()
+   * @return pointer to l_nb - m contiguous values
+   */
+  inline const T* plm(natural_t m, natural_t latitude_index) const
+  {
+    return plm_.data() + plm_offsets_[m] + (latitude_index * (l_nb_ - m));
+  }
+
+  /**
+   * Returns the compressed Legendre matrix of the order m for the degrees l with (l - m) % 2 == parity,
+   * or nullptr if the order uses the direct method.
+   * The matrix rows are the degrees l = m + parity + 2 * row, its columns the latitudes.
+   * @param m order
+   * @param parity 0 or 1
+   */
+  const CompressedLegendreMatrix* compressed_plm(natural_t m, natural_t parity) const;
+  /** Largest tile rank of the compressed Legendre matrices (0 without compression) */
+  natural_t compressed_rank() const;
+
+private:
+  natural_t rows_;
+  natural_t cols_;
+  natural_t l_max_;
+  natural_t l_nb_;
+  natural_t m_nb_;
+  GridType grid_;
+  std::vector<Latitude> latitudes_;
+  std::vector<natural_t> plm_offsets_;
+  huge_page_vector<T> plm_;
+  std::vector<CompressedLegendreMatrix> compressed_plm_;
+  std::vector<char> fast_orders_;
+  natural_t compressed_rank_;
+
+  /**
+   * Compresses the orders for which the options select the fast method, from the Legendre values at xs
+   * (cosines of the northern latitudes), and sets fast_orders_
+   */
+  void compress(const LegendreOptions& options, const std::vector<real_t>& xs);
 };
 
-class Spharm
+template<class T>
+class BasicSpharm
 {
 public:
+  typedef BasicSphericalSurface<T> SphericalSurface;
+  typedef BasicSphericalSurfaceView<T> SphericalSurfaceView;
+  typedef BasicSphericalHarmonics<T> SphericalHarmonics;
+  typedef BasicSphericalHarmonicsView<T> SphericalHarmonicsView;
+  typedef BasicSpharmPlan<T> SpharmPlan;
+
   static SphericalHarmonics spharm_transform(const SphericalSurface& spherical_surface);
+  /**
+   * Computes only the coefficients with l <= l_max and m <= m_max
+   * @param spherical_surface
+   * @param l_max band limit of the result
+   * @param m_max maximum order computed (defaults to l_max)
+   * @return SphericalHarmonics of size l_max
+   */
+  static SphericalHarmonics spharm_transform(const SphericalSurface& spherical_surface, natural_t l_max);
+  static SphericalHarmonics spharm_transform(const SphericalSurface& spherical_surface,
+                                             natural_t l_max, natural_t m_max);
+  static SphericalHarmonics spharm_transform(const SpharmPlan& plan, const SphericalSurface& spherical_surface);
+  /**
+   * Transforms the viewed values in place, without copying them into a SphericalSurface
+   * @param plan
+   * @param view
+   * @return SphericalHarmonics of size plan.l_max()
+   * @throw invalid_argument if the view does not have the size and grid of the plan
+   */
+  static SphericalHarmonics spharm_transform(const SpharmPlan& plan, const SphericalSurfaceView& view);
+  /**
+   * Synthesizes the surface from its coefficients on the equiangular grid of
+   * 2 * (l_max + 1) rows (rounded up to a power of two, as the number of columns)
+   * @param spherical_harmonics coefficients of a real function
+   * @return SphericalSurface
+   */
   static SphericalSurface ispharm_transform(const SphericalHarmonics& spherical_harmonics);
+  /**
+   * Synthesizes the surface described by the plan from the coefficients with l < l_nb and m < m_nb
+   * @param plan
+   * @param spherical_harmonics coefficients of a real function
+   * @return SphericalSurface of size plan.rows() x plan.cols()
+   */
+  static SphericalSurface ispharm_transform(const SpharmPlan& plan, const SphericalHarmonics& spherical_harmonics);
+
+  /**
+   * Transforms all the surfaces (which must share the same grid) with a single plan.
+   *
+   * The Legendre values of each latitude are loaded once and applied to the whole batch
+   * @param surfaces array of n surfaces
+   * @param n number of surfaces
+   * @param out array of n spherical harmonics receiving the results
+   * @throw invalid_argument if the surfaces do not have the same size and grid
+   */
+  static void spharm_transform_batch(const SphericalSurface* surfaces, natural_t n, SphericalHarmonics* out);
+  static void spharm_transform_batch(const SpharmPlan& plan, const SphericalSurface* surfaces,
+                                     natural_t n, SphericalHarmonics* out);
+  static void spharm_transform_batch(const SpharmPlan& plan, const SphericalSurfaceView* surfaces,
+                                     natural_t n, SphericalHarmonics* out);
+
+  /**
+   * Size of the workspace needed by the transforms below for up to n surfaces
+   * (with the current omp_get_max_threads())
+   * @param plan
+   * @param n number of surfaces transformed together
+   */
+  static natural_t required_bytes(const SpharmPlan& plan, natural_t n = 1);
+  /**
+   * Transforms taking their scratch buffers from the workspace (released on return) instead of the heap.
+   * The outputs are only reallocated when their size does not match the plan:
+   * steady state transforms perform no heap allocation.
+   * @throw invalid_argument if the surfaces do not match the plan or the workspace is too small
+   */
+  static void spharm_transform(const SpharmPlan& plan, const SphericalSurfaceView& view,
+                               SphericalHarmonics& out, Workspace& workspace);
+  static void spharm_transform_batch(const SpharmPlan& plan, const SphericalSurfaceView* surfaces,
+                                     natural_t n, SphericalHarmonics* out, Workspace& workspace);
+  static void ispharm_transform(const SpharmPlan& plan, const SphericalHarmonics& spherical_harmonics,
+                                SphericalSurface& out, Workspace& workspace);
+  /**
+   * Same as above with caller owned storage (e.g. carved from a workspace):
+   * out receives n x (plan.l_max() + 1) (plan.l_max() + 2) / 2 coefficients, each block laid out
+   * like a SphericalHarmonics of degree plan.l_max()
+   */
+  static void spharm_transform_batch(const SpharmPlan& plan, const SphericalSurfaceView* surfaces,
+                                     natural_t n, std::complex<T>* out, Workspace& workspace);
+  /**
+   * Same as above with caller owned storage: out receives the plan.rows() x plan.cols() values
+   * laid out like a SphericalSurface
+   */
+  static void ispharm_transform(const SpharmPlan& plan, const SphericalHarmonicsView& spherical_harmonics,
+                                T* out, Workspace& workspace);
 
 private:
-  static std::vector<std::vector<complex_t>> compute_fm_thetas(const SphericalSurface &spherical_surface);
+  static const natural_t BATCH_BLOCK_SIZE;
 
-  static std::vector<NormalizedLegendreArray>
-  compute_plm_weight_sin_thetas(const std::vector<real_t> &weights, const std::vector<real_t> &cos_thetas,
-                                const std::vector<real_t> &sin_thetas, const natural_t l_max,
-                                std::vector<natural_t> &plm_indexes);
+  /**
+   * Forward transform of the batch: the coefficients of the surface i are written at output(i),
+   * laid out like a SphericalHarmonics of degree plan.l_max() (the ones not computed are left untouched)
+   */
+  template<class Output>
+  static void compute_harmonics(const SpharmPlan& plan, const SphericalSurfaceView* surfaces, natural_t n,
+                                Output output, Workspace& workspace);
 
-  /*!
-   * Compute the Chebychev weights described in this document: http://dx.doi.org/10.1006/aama.1994.1008
-   * @param n
-   * @return Chebychev weights
+  /**
+   * Computes the fft of every row of the surfaces
+   * @param fm_thetas receives the coefficients stored as [theta][m][surface] for m in [0, m_nb)
+   * @param fft_buffers get_fft_buffer_size(plan) values per thread
    */
-  static std::vector<real_t> compute_cheb_weights(const natural_t n);
+  static void compute_fm_thetas(const SpharmPlan &plan, const SphericalSurfaceView* surfaces, natural_t n,
+                                std::complex<T>* fm_thetas, std::complex<T>* fft_buffers);
+
+  /**
+   * Resizes the coefficients to the plan, or clears the ones it does not compute
+   */
+  static void prepare_harmonics(const SpharmPlan& plan, SphericalHarmonics& harmonics);
+
+  /** Values of a thread fft buffer: the row and the fft scratch */
+  static natural_t get_fft_buffer_size(const SpharmPlan& plan);
+  /**
+   * Values of a thread Legendre buffer, per surface of a block:
+   * folded sums, coefficients and scratch of the compressed matrices
+   */
+  static natural_t get_legendre_buffer_size(const SpharmPlan& plan);
 };
 
+typedef BasicSphericalSurface<real_t> SphericalSurface;
+typedef BasicSphericalSurfaceView<real_t> SphericalSurfaceView;
+typedef BasicSphericalHarmonics<real_t> SphericalHarmonics;
+typedef BasicSphericalHarmonicsView<real_t> SphericalHarmonicsView;
+typedef BasicSpharmPlan<real_t> SpharmPlan;
+typedef BasicSpharm<real_t> Spharm;
+
+typedef BasicSphericalSurface<float> SphericalSurfaceF;
+typedef BasicSphericalSurfaceView<float> SphericalSurfaceViewF;
+typedef BasicSphericalHarmonics<float> SphericalHarmonicsF;
+typedef BasicSphericalHarmonicsView<float> SphericalHarmonicsViewF;
+typedef BasicSpharmPlan<float> SpharmPlanF;
+typedef BasicSpharm<float> SpharmF;
+
 }
@@ -0,0 +1,86 @@
+/**
+ * @file workspace.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Scratch memory of the transforms
+ */
+
+#pragma once
+
+#include <stdexcept>
+#include "types.h"
+#include "aligned_allocator.h"
+
+namespace hyperspharm
+{
+
+/**
+ * @brief Bump arena holding the scratch buffers of the transforms
+ *
+ * The buffers are carved out of a single preallocated block (aligned on ALIGNMENT bytes each) and are all
+ * released at once by reset(). A transform given a workspace of the size reported by its required_bytes
+ * query performs no heap allocation.
+ *
+ * A workspace is not thread safe: the transforms carve their per thread buffers before their parallel regions.
+ * The block is left uninitialized: its pages are first touched by the parallel loops filling the buffers.
+ */
+class Workspace
+{
+public:
+  static const natural_t ALIGNMENT = 64;
+
+  Workspace();
+  /**
+   * @param bytes capacity of the arena
+   */
+  explicit Workspace(natural_t bytes);
+
+  /**
+   * Returns an uninitialized buffer of count values, aligned on ALIGNMENT bytes
+   * @throw invalid_argument if the remaining capacity is too small
+   */
+  template<class T>
+  T* allocate(const natural_t count)
+  {
+    const natural_t bytes = aligned_size(count * sizeof(T));
+    if (bytes > (buffer_.size() - used_))
+    {
+      throw std::invalid_argument( "Workspace allocate: the workspace is too small (see required_bytes)" );
+    }
+    T* result = reinterpret_cast<T*>(buffer_.data() + used_);
+    used_ += bytes;
+    return result;
+  }
+
+  /**
+   * Releases all the buffers
+   */
+  void reset();
+  /**
+   * Releases the buffers allocated since used() returned mark
+   */
+  void rewind(natural_t mark);
+  /**
+   * Grows the capacity to at least bytes, which releases all the buffers
+   */
+  void reserve(natural_t bytes);
+
+  natural_t capacity() const;
+  natural_t used() const;
+
+  /**
+   * Size taken in the arena by a buffer of the given size
+   */
+  static inline natural_t aligned_size(const natural_t bytes)
+  {
+    return ((bytes + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+  }
+
+private:
+  uninitialized_vector<char> buffer_;
+  natural_t used_;
+};
+
+}
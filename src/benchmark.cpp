@@ -5,13 +5,19 @@
  * @brief Compare implementation speed against other implementations
  */
 
+#include <algorithm>
 #include <chrono>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <cstdlib>
 #include <vector>
 #include <random>
 #include <gsl/gsl_sf.h>
+#include <omp.h>
 #include "legendre.h"
+#include "spharms.h"
+#include "hyperspharm.h"
 
 
 struct legendre_test_value
@@ -162,9 +168,151 @@ void test_spharm_normalized_legendre_array()
             << " (" << (count * 100.0)/ nb_tests << "%)\n";
 }
 
+/**
+ * Returns the best wall time of a few runs (the first one also warms up the threads and the pages)
+ */
+double get_best_time(const std::function<void ()>& run)
+{
+  double best = std::numeric_limits<double>::max();
+  for (int repeat = 0; repeat < 3; ++repeat)
+  {
+    const auto start = std::chrono::high_resolution_clock::now();
+    run();
+    const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+void test_fast_legendre_transform()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_real_distribution<> coeff_dis(-1.0, 1.0);
+
+  const hyperspharm::LegendreOptions direct_options = {hyperspharm::LegendreMethod::Direct, 1e-12, 0};
+  const hyperspharm::LegendreOptions fast_options = {hyperspharm::LegendreMethod::Fast, 1e-12, 0};
+  // Sweep past the number of degrees from which LegendreMethod::Automatic compresses.
+  // The Gauss-Legendre grid halves the rows (and the dense Legendre tables) of the equiangular one.
+  const hyperspharm::natural_t threshold = hyperspharm::SpharmPlan::DEFAULT_LEGENDRE_OPTIONS.threshold;
+  hyperspharm::natural_t crossover = 0;
+  for (hyperspharm::natural_t l_max = 63; l_max < (threshold + 128);
+       l_max = (l_max < 511) ? ((2 * l_max) + 1) : (l_max + 128))
+  {
+    const hyperspharm::natural_t rows = l_max + 1;
+    hyperspharm::natural_t cols = 1;
+    while (cols < ((2 * l_max) + 1)) { cols *= 2; }
+    hyperspharm::SphericalHarmonics harmonics(l_max);
+    for (hyperspharm::natural_t l = 0; l <= l_max; ++l)
+    {
+      harmonics.set(l, 0, {coeff_dis(gen), 0.0});
+      for (hyperspharm::natural_t m = 1; m <= l; ++m)
+      {
+        harmonics.set(l, m, {coeff_dis(gen), coeff_dis(gen)});
+      }
+    }
+
+    // One plan alive at a time: the direct tables alone take several GB past l_max = 1023
+    hyperspharm::SphericalSurface surface(rows, cols);
+    double forward_direct, inverse_direct, forward_fast, inverse_fast;
+    double max_error = 0;
+    {
+      const hyperspharm::SpharmPlan direct_plan(rows, cols, l_max, l_max, hyperspharm::GridType::GaussLegendre,
+                                                direct_options);
+      hyperspharm::SphericalHarmonics result(l_max);
+      inverse_direct = get_best_time([&]() {
+        surface = hyperspharm::Spharm::ispharm_transform(direct_plan, harmonics);
+      });
+      forward_direct = get_best_time([&]() {
+        result = hyperspharm::Spharm::spharm_transform(direct_plan, surface);
+      });
+    }
+    {
+      const hyperspharm::SpharmPlan fast_plan(rows, cols, l_max, l_max, hyperspharm::GridType::GaussLegendre,
+                                              fast_options);
+      hyperspharm::SphericalSurface fast_surface(rows, cols);
+      hyperspharm::SphericalHarmonics fast_result(l_max);
+      inverse_fast = get_best_time([&]() {
+        fast_surface = hyperspharm::Spharm::ispharm_transform(fast_plan, harmonics);
+      });
+      forward_fast = get_best_time([&]() {
+        fast_result = hyperspharm::Spharm::spharm_transform(fast_plan, surface);
+      });
+      for (hyperspharm::natural_t l = 0; l <= l_max; ++l)
+      {
+        for (hyperspharm::natural_t m = 0; m <= l; ++m)
+        {
+          max_error = std::max(max_error, std::abs(fast_result.get(l, m) - harmonics.get(l, m)));
+        }
+      }
+    }
+
+    std::cout << "l_max " << l_max << ": forward direct " << forward_direct << "s, fast " << forward_fast
+              << "s; inverse direct " << inverse_direct << "s, fast " << inverse_fast
+              << "s (max error " << max_error << ")\n";
+    // Crossover: the fast transforms are faster from this band limit on
+    if ((forward_fast + inverse_fast) >= (forward_direct + inverse_direct))
+    {
+      crossover = 0;
+    }
+    else if (crossover == 0)
+    {
+      crossover = l_max;
+    }
+  }
+
+  if (crossover != 0)
+  {
+    std::cout << "The fast Legendre transform is faster from l_max = " << crossover << "\n";
+  }
+  else
+  {
+    std::cout << "The fast Legendre transform does not stay faster than the direct one over the sweep\n";
+  }
+}
+
+void test_hyperspharm_strong_scaling()
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<> coeff_dis(-1.0, 1.0);
+
+  const hyperspharm::natural_t n_max = 64;
+  const hyperspharm::natural_t size = 2 * n_max;
+  const hyperspharm::HyperSpharmPlan plan(n_max, size, size, n_max);
+  hyperspharm::HyperSphericalCoeffs coeffs(n_max, hyperspharm::CoeffsLayout::Tetrahedral);
+  for (auto it = coeffs.begin(); it != coeffs.end(); ++it)
+  {
+    *it = {coeff_dis(gen), (it.m() == 0) ? 0.0 : coeff_dis(gen)};
+  }
+  const auto surface = hyperspharm::HyperSpharm::transform(plan, coeffs);
+
+  const int max_threads = omp_get_num_procs();
+  double reference_time = 0;
+  std::cout << "Hyperspherical transform strong scaling (n_max " << n_max << ", "
+            << n_max << "x" << size << "x" << size << " samples)\n";
+  for (int threads = 1; ; threads = std::min(2 * threads, max_threads))
+  {
+    omp_set_num_threads(threads);
+    auto start = std::chrono::high_resolution_clock::now();
+    const auto result = hyperspharm::HyperSpharm::transform(plan, surface);
+    hyperspharm::HyperSpharm::transform(plan, result);
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_time = finish - start;
+    if (threads == 1) { reference_time = elapsed_time.count(); }
+
+    std::cout << threads << " threads: forward + inverse took " << elapsed_time.count() << "s (speedup "
+              << reference_time / elapsed_time.count() << ", efficiency "
+              << reference_time / (elapsed_time.count() * threads) << ")\n";
+    if (threads == max_threads) { break; }
+  }
+  omp_set_num_threads(max_threads);
+}
+
 int main()
 {
   test_spharm_normalized_legendre();
   test_spharm_normalized_legendre_array();
+  test_fast_legendre_transform();
+  test_hyperspharm_strong_scaling();
   return 0;
 }
\ No newline at end of file
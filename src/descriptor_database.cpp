@@ -0,0 +1,247 @@
+/**
+ * @file descriptor_database.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Append only store of descriptors with similarity search
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <omp.h>
+#include "aligned_allocator.h"
+#include "serialization.h"
+#include "descriptor_database.h"
+
+namespace hyperspharm
+{
+
+const natural_t DescriptorDatabase::VERSION = 1;
+const natural_t DescriptorDatabase::HEADER_SIZE = 64;
+const natural_t DescriptorDatabase::SHARD_SIZE = 4096;
+
+DescriptorDatabase DescriptorDatabase::create(const std::string &path, const natural_t dimension)
+{
+  if (!BinaryFile::is_little_endian())
+  {
+    throw std::runtime_error( "DescriptorDatabase: the files can only be written on little-endian hosts" );
+  }
+  char bytes[HEADER_SIZE];
+  std::memset(bytes, 0, HEADER_SIZE);
+  std::memcpy(bytes, "HSDB", 4);
+  BinaryFile::store(bytes + 4, VERSION, 2);
+  BinaryFile::store(bytes + 8, dimension, 8);
+  BinaryFile::store(bytes + 16, get_row_stride(dimension), 8);
+  BinaryFile::store(bytes + 24, 0, 8);
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes, HEADER_SIZE);
+    if (!file)
+    {
+      throw std::runtime_error( "DescriptorDatabase: cannot write " + path );
+    }
+  }
+  return DescriptorDatabase(path);
+}
+
+DescriptorDatabase::DescriptorDatabase(const std::string &path) :
+  path_(path), file_(path), dimension_(0), row_stride_(0), size_(0)
+{
+  read_header();
+}
+
+natural_t DescriptorDatabase::dimension() const
+{
+  return dimension_;
+}
+
+natural_t DescriptorDatabase::size() const
+{
+  return size_;
+}
+
+natural_t DescriptorDatabase::row_stride() const
+{
+  return row_stride_;
+}
+
+const float *DescriptorDatabase::row(const natural_t index) const
+{
+  return reinterpret_cast<const float*>(file_.data() + HEADER_SIZE) + (index * row_stride_);
+}
+
+void DescriptorDatabase::append(const float *descriptors, const natural_t count)
+{
+  if (count == 0) { return; }
+
+  std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+  if (!file)
+  {
+    throw std::runtime_error( "DescriptorDatabase: cannot open " + path_ );
+  }
+  // Rows after the count of the header (an interrupted append) are overwritten
+  file.seekp(static_cast<std::streamoff>(HEADER_SIZE + (size_ * row_stride_ * sizeof(float))));
+  std::vector<float> padded_row(row_stride_, 0.0f);
+  for (natural_t row_i = 0; row_i < count; ++row_i)
+  {
+    std::copy(descriptors + (row_i * dimension_), descriptors + ((row_i + 1) * dimension_), padded_row.begin());
+    file.write(reinterpret_cast<const char*>(padded_row.data()),
+               static_cast<std::streamsize>(row_stride_ * sizeof(float)));
+  }
+  // The rows are flushed before the count that makes them visible
+  file.flush();
+  char count_bytes[8];
+  BinaryFile::store(count_bytes, size_ + count, 8);
+  file.seekp(24);
+  file.write(count_bytes, 8);
+  file.flush();
+  if (!file)
+  {
+    throw std::runtime_error( "DescriptorDatabase: cannot write " + path_ );
+  }
+  file.close();
+
+  file_ = MappedFile(path_);
+  read_header();
+}
+
+std::vector<SearchResult> DescriptorDatabase::search(const float *query, const natural_t k, const Metric metric) const
+{
+  std::vector<SearchResult> results(std::min(k, size_));
+  search_batch(query, 1, k, metric, results.data());
+  return results;
+}
+
+natural_t DescriptorDatabase::search_batch(const float *queries, const natural_t query_nb, const natural_t k,
+                                           const Metric metric, SearchResult *out) const
+{
+  const natural_t result_nb = std::min(k, size_);
+  if ((result_nb == 0) || (query_nb == 0)) { return result_nb; }
+
+  // Queries padded like the rows: the distance loops run over whole cache lines
+  aligned_vector<float> padded_queries(query_nb * row_stride_, 0.0f);
+  for (natural_t query_i = 0; query_i < query_nb; ++query_i)
+  {
+    std::copy(queries + (query_i * dimension_), queries + ((query_i + 1) * dimension_),
+              padded_queries.begin() + (query_i * row_stride_));
+  }
+
+  const natural_t shard_nb = (size_ + SHARD_SIZE - 1) / SHARD_SIZE;
+  const natural_t thread_nb = static_cast<natural_t>(omp_get_max_threads());
+  // heaps[thread][query]: best entries found by the thread
+  std::vector<std::vector<SearchResult>> heaps(thread_nb * query_nb);
+#pragma omp parallel
+  {
+    std::vector<SearchResult>* thread_heaps =
+        heaps.data() + (static_cast<natural_t>(omp_get_thread_num()) * query_nb);
+#pragma omp for schedule(dynamic)
+    for (natural_t shard_i = 0; shard_i < shard_nb; ++shard_i)
+    {
+      const natural_t last = std::min(size_, (shard_i + 1) * SHARD_SIZE);
+      for (natural_t row_i = shard_i * SHARD_SIZE; row_i < last; ++row_i)
+      {
+        const float* values = row(row_i);
+        for (natural_t query_i = 0; query_i < query_nb; ++query_i)
+        {
+          const float key = get_key(values, padded_queries.data() + (query_i * row_stride_), row_stride_, metric);
+          push(thread_heaps[query_i], result_nb, {row_i, key});
+        }
+      }
+    }
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for (natural_t query_i = 0; query_i < query_nb; ++query_i)
+  {
+    std::vector<SearchResult> merged;
+    merged.reserve(thread_nb * result_nb);
+    for (natural_t thread_i = 0; thread_i < thread_nb; ++thread_i)
+    {
+      const auto& heap = heaps[(thread_i * query_nb) + query_i];
+      merged.insert(merged.end(), heap.begin(), heap.end());
+    }
+    std::partial_sort(merged.begin(), merged.begin() + result_nb, merged.end(), is_better);
+    SearchResult* results = out + (query_i * result_nb);
+    for (natural_t result_i = 0; result_i < result_nb; ++result_i)
+    {
+      results[result_i] = merged[result_i];
+      if (metric == Metric::InnerProduct) { results[result_i].score = -results[result_i].score; }
+    }
+  }
+  return result_nb;
+}
+
+void DescriptorDatabase::read_header()
+{
+  const char* bytes = file_.data();
+  if ((file_.size() < HEADER_SIZE) || (std::memcmp(bytes, "HSDB", 4) != 0))
+  {
+    throw std::runtime_error( "DescriptorDatabase: " + path_ + " is not a database" );
+  }
+  if (BinaryFile::load(bytes + 4, 2) != VERSION)
+  {
+    throw std::runtime_error( "DescriptorDatabase: unsupported version of " + path_ );
+  }
+  dimension_ = BinaryFile::load(bytes + 8, 8);
+  row_stride_ = BinaryFile::load(bytes + 16, 8);
+  size_ = BinaryFile::load(bytes + 24, 8);
+  if ((row_stride_ != get_row_stride(dimension_)) ||
+      (((file_.size() - HEADER_SIZE) / sizeof(float)) < (size_ * row_stride_)))
+  {
+    throw std::runtime_error( "DescriptorDatabase: invalid header in " + path_ );
+  }
+}
+
+inline float DescriptorDatabase::get_key(const float *row, const float *query, const natural_t row_stride,
+                                         const Metric metric)
+{
+  float key = 0.0f;
+  if (metric == Metric::L2)
+  {
+#pragma omp simd reduction(+:key)
+    for (natural_t i = 0; i < row_stride; ++i)
+    {
+      const float difference = row[i] - query[i];
+      key += difference * difference;
+    }
+    return key;
+  }
+#pragma omp simd reduction(+:key)
+  for (natural_t i = 0; i < row_stride; ++i)
+  {
+    key += row[i] * query[i];
+  }
+  return -key;
+}
+
+void DescriptorDatabase::push(std::vector<SearchResult> &heap, const natural_t capacity, const SearchResult &candidate)
+{
+  if (heap.size() < capacity)
+  {
+    heap.push_back(candidate);
+    std::push_heap(heap.begin(), heap.end(), is_better);
+  }
+  else if (is_better(candidate, heap.front()))
+  {
+    std::pop_heap(heap.begin(), heap.end(), is_better);
+    heap.back() = candidate;
+    std::push_heap(heap.begin(), heap.end(), is_better);
+  }
+}
+
+bool DescriptorDatabase::is_better(const SearchResult &left, const SearchResult &right)
+{
+  return (left.score < right.score) || ((left.score == right.score) && (left.index < right.index));
+}
+
+natural_t DescriptorDatabase::get_row_stride(const natural_t dimension)
+{
+  // 16 floats: one cache line
+  return std::max<natural_t>(16, ((dimension + 15) / 16) * 16);
+}
+
+}
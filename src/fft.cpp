@@ -6,6 +6,7 @@
 *
 */
 
+#include <vector>
 #include "fft.h"
 
 namespace hyperspharm
@@ -26,10 +27,11 @@ bool is_power_of_two(natural_t value)
 * @param array array of complex number to be separated
 * @param size size of the array
 */
-void separate(complex_t* array, natural_t size)
+template<class T>
+void separate(std::complex<T>* array, natural_t size)
 {
   const natural_t half_size = size / 2;
-  complex_t* temp_array = new complex_t[half_size];  // get temp heap storage
+  std::complex<T>* temp_array = new std::complex<T>[half_size];  // get temp heap storage
   for(natural_t index=0; index < half_size; index++)    // copy all odd elements to heap storage
     temp_array[index] = array[index * 2 + 1];
   for(natural_t index=0; index < half_size; index++)    // copy all even elements to lower-half of a[]
@@ -39,6 +41,25 @@ void separate(complex_t* array, natural_t size)
   delete[] temp_array;                 // delete heap storage
 }
 
+/**
+* @brief Same as above, the odd elements being stored in the scratch buffer
+*
+* @param array array of complex number to be separated
+* @param size size of the array
+* @param scratch buffer of at least size / 2 elements
+*/
+template<class T>
+void separate(std::complex<T>* array, natural_t size, std::complex<T>* scratch)
+{
+  const natural_t half_size = size / 2;
+  for(natural_t index=0; index < half_size; index++)
+    scratch[index] = array[index * 2 + 1];
+  for(natural_t index=0; index < half_size; index++)
+    array[index] = array[index*2];
+  for(natural_t index=0; index < half_size; index++)
+    array[index+half_size] = scratch[index];
+}
+
 /**
 * @brief Compute the fft of the given array, only if size is a power of two.
 * 
@@ -48,7 +69,8 @@ void separate(complex_t* array, natural_t size)
 * @param size size of the array
 * @return bool returns true if size is a power of two.
 */
-bool fft (complex_t array[], natural_t size)
+template<class T>
+bool fft (std::complex<T> array[], natural_t size)
 {
   if (is_power_of_two(size))
   {
@@ -62,6 +84,24 @@ bool fft (complex_t array[], natural_t size)
   }
 }
 
+/**
+* @brief Same as above with a scratch buffer of at least size / 2 elements (no heap allocation)
+*/
+template<class T>
+bool fft (std::complex<T> array[], natural_t size, std::complex<T>* scratch)
+{
+  if (is_power_of_two(size))
+  {
+    unsafe_fft(array, size, scratch);
+    return true;
+  }
+  else
+  {
+    std::cerr << "Error in fft: Size of the array needs to be a power of 2\n"; 
+    return false;
+  }
+}
+
 /**
 * @brief Compute the inverse fft of the given array, only if size is a power of two.
 * 
@@ -71,12 +111,31 @@ bool fft (complex_t array[], natural_t size)
 * @param size size of the array
 * @return bool returns true if size is a power of two.
 */
-bool ifft (complex_t array[], natural_t size)
+template<class T>
+bool ifft (std::complex<T> array[], natural_t size)
+{
+  if (is_power_of_two(size))
+  {
+    std::vector<std::complex<T>> scratch(size / 2);
+    return ifft(array, size, scratch.data());
+  }
+  else
+  {
+    std::cerr << "Error in ifft: Size of the array needs to be a power of 2\n"; 
+    return false;
+  }
+}
+
+/**
+* @brief Same as above with a scratch buffer of at least size / 2 elements (no heap allocation)
+*/
+template<class T>
+bool ifft (std::complex<T> array[], natural_t size, std::complex<T>* scratch)
 {
   if (is_power_of_two(size))
   {
     // Using the formula inverse F({X_n}) = F({X_{N-n}})/n;
-    complex_t temp;
+    std::complex<T> temp;
     // X_n = X_{N-n}
     for (natural_t index = 1; index < (size/2); index++)
     {
@@ -84,10 +143,10 @@ bool ifft (complex_t array[], natural_t size)
       array[index] = array[size - index];
       array[size - index] = temp;
     }
-    unsafe_fft(array, size);
+    unsafe_fft(array, size, scratch);
     for (natural_t index = 0; index < size; index++)
     {
-      array[index] = array[index] / static_cast<real_t>(size);
+      array[index] = array[index] / static_cast<T>(size);
     }
     return true;
   }
@@ -111,7 +170,19 @@ bool ifft (complex_t array[], natural_t size)
 * @param array array of complex number to be separated
 * @param size size of the array
 */
-void unsafe_fft (complex_t array[], natural_t size) 
+template<class T>
+void unsafe_fft (std::complex<T> array[], natural_t size)
+{
+  // A single scratch buffer, reused by all the levels of the recursion
+  std::vector<std::complex<T>> scratch(size / 2);
+  unsafe_fft(array, size, scratch.data());
+}
+
+/**
+* @brief Same as above with a scratch buffer of at least size / 2 elements (no heap allocation)
+*/
+template<class T>
+void unsafe_fft (std::complex<T> array[], natural_t size, std::complex<T>* scratch)
 {
   if(size < 2) 
   {
@@ -121,19 +192,90 @@ void unsafe_fft (complex_t array[], natural_t size)
   else 
   {
     const natural_t half_size = size / 2;
-    separate(array, size);      // all evens to lower half, all odds to upper half
-    unsafe_fft(array, half_size);   // recurse even items
-    unsafe_fft(array + half_size, half_size);   // recurse odd  items
+    separate(array, size, scratch);      // all evens to lower half, all odds to upper half
+    unsafe_fft(array, half_size, scratch);   // recurse even items
+    unsafe_fft(array + half_size, half_size, scratch);   // recurse odd  items
     // combine results of two half recursions
     for(natural_t index = 0; index < half_size; index++) 
     {
-       complex_t e = array[index    ];                              // even
-       complex_t o = array[index + half_size];                      // odd
-       complex_t w = exp( complex_t(0,-2.*M_PI*index/size) ); // w is the "twiddle-factor"
+       std::complex<T> e = array[index    ];                              // even
+       std::complex<T> o = array[index + half_size];                      // odd
+       // w is the "twiddle-factor", always computed in double precision
+       std::complex<T> w(exp( complex_t(0,-2.*M_PI*index/size) ));
        array[index] = e + w * o;
        array[index + half_size] = e - w * o;
     }
   }
 }
 
+/**
+* @brief Compute the fft of real values through a complex fft of half size
+*
+* z_k = x_{2k} + i x_{2k+1} is transformed, then
+* X_k = (Z_k + conj(Z_{N/2-k})) / 2 - i e^{-2 i pi k / N} (Z_k - conj(Z_{N/2-k})) / 2
+*
+* @param input size real values
+* @param size size of the input, power of two
+* @param output size / 2 + 1 coefficients
+* @param scratch buffer of at least size / 4 elements
+* @return bool returns true if size is a power of two.
+*/
+template<class T>
+bool rfft (const T* input, natural_t size, std::complex<T>* output, std::complex<T>* scratch)
+{
+  if (!is_power_of_two(size))
+  {
+    std::cerr << "Error in rfft: Size of the array needs to be a power of 2\n";
+    return false;
+  }
+  if (size == 1)
+  {
+    output[0] = input[0];
+    return true;
+  }
+
+  const natural_t half_size = size / 2;
+  for (natural_t index = 0; index < half_size; index++)
+  {
+    output[index] = std::complex<T>(input[2 * index], input[(2 * index) + 1]);
+  }
+  unsafe_fft(output, half_size, scratch);
+
+  const std::complex<T> z0 = output[0];
+  output[0] = z0.real() + z0.imag();
+  output[half_size] = z0.real() - z0.imag();
+  const std::complex<T> half_i(0, 0.5);
+  for (natural_t index = 1; index <= (half_size / 2); index++)
+  {
+    // Both coefficients of the pair (index, half_size - index) depend on the same two values
+    const natural_t mirror = half_size - index;
+    const std::complex<T> a = output[index];
+    const std::complex<T> b = output[mirror];
+    const std::complex<T> w_index(exp( complex_t(0,-2.*M_PI*index/size) ));
+    const std::complex<T> w_mirror(exp( complex_t(0,-2.*M_PI*mirror/size) ));
+    output[index] = (static_cast<T>(0.5) * (a + std::conj(b))) - (half_i * w_index * (a - std::conj(b)));
+    output[mirror] = (static_cast<T>(0.5) * (b + std::conj(a))) - (half_i * w_mirror * (b - std::conj(a)));
+  }
+  return true;
+}
+
+template void separate(std::complex<float>* array, natural_t size);
+template void separate(std::complex<double>* array, natural_t size);
+template bool fft(std::complex<float>* array, natural_t size);
+template bool fft(std::complex<double>* array, natural_t size);
+template bool ifft(std::complex<float>* array, natural_t size);
+template bool ifft(std::complex<double>* array, natural_t size);
+template void unsafe_fft(std::complex<float>* array, natural_t size);
+template void unsafe_fft(std::complex<double>* array, natural_t size);
+template void separate(std::complex<float>* array, natural_t size, std::complex<float>* scratch);
+template void separate(std::complex<double>* array, natural_t size, std::complex<double>* scratch);
+template bool fft(std::complex<float>* array, natural_t size, std::complex<float>* scratch);
+template bool fft(std::complex<double>* array, natural_t size, std::complex<double>* scratch);
+template bool ifft(std::complex<float>* array, natural_t size, std::complex<float>* scratch);
+template bool ifft(std::complex<double>* array, natural_t size, std::complex<double>* scratch);
+template void unsafe_fft(std::complex<float>* array, natural_t size, std::complex<float>* scratch);
+template void unsafe_fft(std::complex<double>* array, natural_t size, std::complex<double>* scratch);
+template bool rfft(const float* input, natural_t size, std::complex<float>* output, std::complex<float>* scratch);
+template bool rfft(const double* input, natural_t size, std::complex<double>* output, std::complex<double>* scratch);
+
 }
@@ -0,0 +1,297 @@
+/**
+ * @file flt.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Fast Legendre transform helpers: compression of the Legendre matrices used by the spherical transforms
+ */
+
+#include "flt.h"
+
+namespace hyperspharm
+{
+
+const natural_t CompressedLegendreMatrix::MIN_TILE_SIZE = 32;
+
+CompressedLegendreMatrix::CompressedLegendreMatrix() :
+  rows_(0), cols_(0), cost_(0), max_rank_(0)
+{
+}
+
+CompressedLegendreMatrix::CompressedLegendreMatrix(const real_t *values, const natural_t rows,
+                                                   const natural_t cols, const real_t tolerance) :
+  rows_(rows), cols_(cols), cost_(0), max_rank_(0)
+{
+  if ((rows == 0) || (cols == 0)) { return; }
+
+  real_t max_norm = 0;
+  for (natural_t col = 0; col < cols; ++col)
+  {
+    real_t norm = 0;
+    for (natural_t row = 0; row < rows; ++row)
+    {
+      norm += values[(row * cols) + col] * values[(row * cols) + col];
+    }
+    max_norm = std::max(max_norm, std::sqrt(norm));
+  }
+
+  // The rank of a tile grows with (degree range) x (latitude range): square tiles of ~ 3 sqrt(cols)
+  // balance the number of tiles and their ranks
+  const auto tile_size = std::max(MIN_TILE_SIZE,
+                                  static_cast<natural_t>(3.0 * std::sqrt(static_cast<real_t>(cols))));
+  for (natural_t first_row = 0; first_row < rows; first_row += tile_size)
+  {
+    for (natural_t first_col = 0; first_col < cols; first_col += tile_size)
+    {
+      tiles_.push_back(compress_tile(values, cols,
+                                     first_row, std::min(tile_size, rows - first_row),
+                                     first_col, std::min(tile_size, cols - first_col),
+                                     tolerance * max_norm));
+      const auto& tile = tiles_.back();
+      cost_ += tile.dense ? (tile.row_nb * tile.col_nb) : (tile.rank * (tile.row_nb + tile.col_nb));
+      max_rank_ = std::max(max_rank_, tile.rank);
+    }
+  }
+}
+
+CompressedLegendreMatrix::Tile
+CompressedLegendreMatrix::compress_tile(const real_t *values, const natural_t cols,
+                                        const natural_t first_row, const natural_t row_nb,
+                                        const natural_t first_col, const natural_t col_nb,
+                                        const real_t absolute_tolerance)
+{
+  Tile tile;
+  tile.first_row = first_row;
+  tile.row_nb = row_nb;
+  tile.first_col = first_col;
+  tile.col_nb = col_nb;
+
+  // Column pivoted Gram-Schmidt: residuals holds the columns of the tile (column major)
+  std::vector<real_t> residuals(row_nb * col_nb);
+  for (natural_t row = 0; row < row_nb; ++row)
+  {
+    for (natural_t col = 0; col < col_nb; ++col)
+    {
+      residuals[(col * row_nb) + row] = values[((first_row + row) * cols) + first_col + col];
+    }
+  }
+
+  const natural_t max_rank = (row_nb * col_nb) / (row_nb + col_nb);
+  std::vector<bool> selected(col_nb, false);
+  std::vector<real_t> r_coeffs; // r_coeffs[k * col_nb + col]: coefficient of the column on q_k
+  std::vector<real_t> q(row_nb);
+  while (tile.skeleton.size() < max_rank)
+  {
+    natural_t pivot = col_nb;
+    real_t pivot_norm = absolute_tolerance;
+    for (natural_t col = 0; col < col_nb; ++col)
+    {
+      if (selected[col]) { continue; }
+      real_t norm = 0;
+      for (natural_t row = 0; row < row_nb; ++row)
+      {
+        norm += residuals[(col * row_nb) + row] * residuals[(col * row_nb) + row];
+      }
+      norm = std::sqrt(norm);
+      if (norm > pivot_norm)
+      {
+        pivot = col;
+        pivot_norm = norm;
+      }
+    }
+    if (pivot == col_nb) { break; }
+
+    selected[pivot] = true;
+    tile.skeleton.push_back(pivot);
+    for (natural_t row = 0; row < row_nb; ++row)
+    {
+      q[row] = residuals[(pivot * row_nb) + row] / pivot_norm;
+    }
+    r_coeffs.resize(r_coeffs.size() + col_nb, 0.0);
+    real_t* r_k = r_coeffs.data() + ((tile.skeleton.size() - 1) * col_nb);
+    for (natural_t col = 0; col < col_nb; ++col)
+    {
+      if (selected[col] && (col != pivot)) { continue; }
+      real_t* residual = residuals.data() + (col * row_nb);
+      real_t projection = 0;
+      for (natural_t row = 0; row < row_nb; ++row)
+      {
+        projection += q[row] * residual[row];
+      }
+      for (natural_t row = 0; row < row_nb; ++row)
+      {
+        residual[row] -= projection * q[row];
+      }
+      r_k[col] = projection;
+    }
+  }
+
+  tile.rank = tile.skeleton.size();
+  tile.dense = (tile.rank >= max_rank);
+  if (tile.dense)
+  {
+    tile.rank = col_nb;
+    tile.skeleton.clear();
+    tile.columns.resize(row_nb * col_nb);
+    for (natural_t row = 0; row < row_nb; ++row)
+    {
+      for (natural_t col = 0; col < col_nb; ++col)
+      {
+        tile.columns[(row * col_nb) + col] = values[((first_row + row) * cols) + first_col + col];
+      }
+    }
+    return tile;
+  }
+
+  // M[:, skeleton] = Q R_s with R_s upper triangular: T = R_s^{-1} R
+  const natural_t rank = tile.rank;
+  tile.interpolation.resize(rank * col_nb);
+  for (natural_t col = 0; col < col_nb; ++col)
+  {
+    for (natural_t k = rank; k-- > 0;)
+    {
+      real_t value = r_coeffs[(k * col_nb) + col];
+      for (natural_t j = k + 1; j < rank; ++j)
+      {
+        value -= r_coeffs[(k * col_nb) + tile.skeleton[j]] * tile.interpolation[(j * col_nb) + col];
+      }
+      tile.interpolation[(k * col_nb) + col] = value / r_coeffs[(k * col_nb) + tile.skeleton[k]];
+    }
+  }
+
+  tile.columns.resize(row_nb * rank);
+  for (natural_t row = 0; row < row_nb; ++row)
+  {
+    for (natural_t k = 0; k < rank; ++k)
+    {
+      tile.columns[(row * rank) + k] = values[((first_row + row) * cols) + first_col + tile.skeleton[k]];
+    }
+  }
+  return tile;
+}
+
+void CompressedLegendreMatrix::apply(const complex_t *x, complex_t *y, const natural_t batch) const
+{
+  std::vector<complex_t> scratch(max_rank_ * batch);
+  apply(x, y, batch, scratch.data());
+}
+
+void CompressedLegendreMatrix::apply(const complex_t *x, complex_t *y, const natural_t batch,
+                                     complex_t *projected) const
+{
+  for (const auto& tile : tiles_)
+  {
+    const complex_t* x_tile = x + (tile.first_col * batch);
+    complex_t* y_tile = y + (tile.first_row * batch);
+    const complex_t* z = x_tile;
+    if (!tile.dense)
+    {
+      // z = T x
+      std::fill_n(projected, tile.rank * batch, complex_t(0, 0));
+      for (natural_t k = 0; k < tile.rank; ++k)
+      {
+        const real_t* t_k = tile.interpolation.data() + (k * tile.col_nb);
+        complex_t* z_k = projected + (k * batch);
+        for (natural_t col = 0; col < tile.col_nb; ++col)
+        {
+          for (natural_t i = 0; i < batch; ++i)
+          {
+            z_k[i] += t_k[col] * x_tile[(col * batch) + i];
+          }
+        }
+      }
+      z = projected;
+    }
+
+    // y += M[:, skeleton] z
+    for (natural_t row = 0; row < tile.row_nb; ++row)
+    {
+      const real_t* columns = tile.columns.data() + (row * tile.rank);
+      complex_t* y_row = y_tile + (row * batch);
+      for (natural_t k = 0; k < tile.rank; ++k)
+      {
+        for (natural_t i = 0; i < batch; ++i)
+        {
+          y_row[i] += columns[k] * z[(k * batch) + i];
+        }
+      }
+    }
+  }
+}
+
+void CompressedLegendreMatrix::apply_transpose(const complex_t *y, complex_t *x, const natural_t batch) const
+{
+  std::vector<complex_t> scratch(max_rank_ * batch);
+  apply_transpose(y, x, batch, scratch.data());
+}
+
+void CompressedLegendreMatrix::apply_transpose(const complex_t *y, complex_t *x, const natural_t batch,
+                                               complex_t *projected) const
+{
+  for (const auto& tile : tiles_)
+  {
+    const complex_t* y_tile = y + (tile.first_row * batch);
+    complex_t* x_tile = x + (tile.first_col * batch);
+
+    // z = M[:, skeleton]^T y
+    std::fill_n(projected, tile.rank * batch, complex_t(0, 0));
+    for (natural_t row = 0; row < tile.row_nb; ++row)
+    {
+      const real_t* columns = tile.columns.data() + (row * tile.rank);
+      const complex_t* y_row = y_tile + (row * batch);
+      for (natural_t k = 0; k < tile.rank; ++k)
+      {
+        for (natural_t i = 0; i < batch; ++i)
+        {
+          projected[(k * batch) + i] += columns[k] * y_row[i];
+        }
+      }
+    }
+
+    if (tile.dense)
+    {
+      for (natural_t i = 0; i < (tile.col_nb * batch); ++i)
+      {
+        x_tile[i] += projected[i];
+      }
+      continue;
+    }
+
+    // x += T^T z
+    for (natural_t k = 0; k < tile.rank; ++k)
+    {
+      const real_t* t_k = tile.interpolation.data() + (k * tile.col_nb);
+      const complex_t* z_k = projected + (k * batch);
+      for (natural_t col = 0; col < tile.col_nb; ++col)
+      {
+        for (natural_t i = 0; i < batch; ++i)
+        {
+          x_tile[(col * batch) + i] += t_k[col] * z_k[i];
+        }
+      }
+    }
+  }
+}
+
+natural_t CompressedLegendreMatrix::rows() const
+{
+  return rows_;
+}
+
+natural_t CompressedLegendreMatrix::cols() const
+{
+  return cols_;
+}
+
+natural_t CompressedLegendreMatrix::cost() const
+{
+  return cost_;
+}
+
+natural_t CompressedLegendreMatrix::max_rank() const
+{
+  return max_rank_;
+}
+
+}
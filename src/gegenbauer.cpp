@@ -138,75 +138,4 @@ void GegenbauerPoly::compute_coefficients(const natural_t l_max)
   }
 }
 
-
-
-GegenbauerArray::GegenbauerArray(const natural_t l_max) :
-  l_max_(l_max)
-{
-  values_.resize(l_max + 1);
-  for (auto& value : values_)
-  {
-    value.resize(l_max + 1);
-  }
-}
-
-real_t GegenbauerArray::get(const natural_t l, const natural_t m) const
-{
-  if(l > l_max_)
-  {
-    // TODO improve error message
-    throw std::invalid_argument( "Gegenbauer array index out of range" );
-  }
-
-  return values_[m][l];
-}
-
-real_t GegenbauerArray::unsafe_get(const natural_t l, const natural_t m) const
-{
-  return values_[m][l];
-}
-
-void GegenbauerArray::set(const natural_t l, const natural_t m, const real_t x)
-{
-  if((m > l_max_) || (l > l_max_))
-  {
-    // TODO improve error message
-    throw std::invalid_argument( "Gegenbauer array index out of range" );
-  }
-  
-  values_[m][l] =  x;
 }
-
-void GegenbauerArray::unsafe_set(const natural_t l, const natural_t m, const real_t x)
-{
-  values_[m][l] =  x;
-}
-
-GegenbauerArray::GegenbauerArray(GegenbauerArray &&other) noexcept :
-  l_max_(other.l_max_)
-{
-  values_ = std::move(other.values_);
-}
-
-GegenbauerArray &GegenbauerArray::operator=(GegenbauerArray &&other) noexcept
-{
-  if (this != &other)
-  {
-    l_max_ = other.l_max_;
-    values_ = std::move(other.values_);
-  }
-  return *this;
-}
-
-natural_t GegenbauerArray::l_max() const 
-{
-  return l_max_;
-}
-
-std::vector<std::vector<real_t>>& GegenbauerArray::values()
-{
-  return values_;
-}
-
-}
-
@@ -6,199 +6,652 @@
  *
  */
 
+#include <new>
+#include <omp.h>
 #include "hyperspharm.h"
 
 namespace hyperspharm
 {
 
-HyperSphericalSurface::HyperSphericalSurface(const natural_t theta_nb, const natural_t psi_nb, const natural_t phi_nb):
-  theta_nb_(theta_nb), psi_nb_(psi_nb), phi_nb_(phi_nb), values_(theta_nb * psi_nb * phi_nb)
+
+HyperSpharmPlan::HyperSpharmPlan(const natural_t theta_nb, const natural_t psi_nb, const natural_t phi_nb,
+                                 const natural_t n_max) :
+  HyperSpharmPlan(theta_nb, psi_nb, phi_nb, n_max, GridType::Equiangular)
 {
+}
 
+HyperSpharmPlan::HyperSpharmPlan(const natural_t theta_nb, const natural_t psi_nb, const natural_t phi_nb,
+                                 const natural_t n_max, const GridType grid) :
+  theta_nb_(theta_nb), psi_nb_(psi_nb), phi_nb_(phi_nb),
+  n_max_(((psi_nb == 0) || (phi_nb == 0)) ? 0 : std::min(n_max, theta_nb)), grid_(grid),
+  half_theta_nb_((theta_nb + 1) / 2),
+  sphere_plan_(psi_nb, phi_nb, (n_max_ > 0) ? n_max_ - 1 : 0, (n_max_ > 0) ? n_max_ - 1 : 0, grid),
+  l_nb_((n_max_ > 0) ? std::min(n_max_, sphere_plan_.l_nb()) : 0)
+{
+  if (theta_nb_ > 0)
+  {
+    auto rule = Quadrature::gauss_chebyshev(theta_nb_);
+    betas_ = std::move(rule.thetas);
+    beta_weights_ = std::move(rule.weights);
+  }
+
+  gegenbauer_offsets_.resize(l_nb_);
+  natural_t size = 0;
+  for (natural_t l = 0; l < l_nb_; ++l)
+  {
+    gegenbauer_offsets_[l] = size;
+    size += (n_max_ - l) * half_theta_nb_;
+  }
+  gegenbauer_.resize(size);
+  if (l_nb_ == 0) { return; }
+
+  // The first call computes the recurrence coefficients, the parallel ones only read them
+  const natural_t gegenbauer_max = std::max<natural_t>(n_max_, 1);
+  GegenbauerPoly::get_norm_array(gegenbauer_max, 0.0);
+#pragma omp parallel for schedule(dynamic)
+  for (natural_t beta_i = 0; beta_i < half_theta_nb_; ++beta_i)
+  {
+    const real_t beta = betas_[beta_i];
+    const auto gegenbauer_beta = GegenbauerPoly::get_norm_array(gegenbauer_max, std::cos(beta));
+    real_t sin_power = 1.0;
+    for (natural_t l = 0; l < l_nb_; ++l)
+    {
+      real_t* values = gegenbauer_.data() + gegenbauer_offsets_[l] + beta_i;
+      for (natural_t degree = 0; degree < (n_max_ - l); ++degree)
+      {
+        values[degree * half_theta_nb_] = sin_power * gegenbauer_beta.unsafe_get(degree, l + 1);
+      }
+      sin_power *= std::sin(beta);
+    }
+  }
 }
 
+natural_t HyperSpharmPlan::theta_nb() const
+{
+  return theta_nb_;
+}
 
-HyperSphericalSurface::HyperSphericalSurface(const natural_t theta_nb, const natural_t psi_nb,
-                                             const natural_t phi_nb, const real_t init_val):
-    theta_nb_(theta_nb), psi_nb_(psi_nb),
-    phi_nb_(phi_nb), values_(theta_nb * psi_nb * phi_nb, init_val)
+natural_t HyperSpharmPlan::psi_nb() const
 {
+  return psi_nb_;
+}
 
+natural_t HyperSpharmPlan::phi_nb() const
+{
+  return phi_nb_;
 }
 
-real_t HyperSphericalSurface::get(natural_t theta_i, natural_t psi_i, natural_t phi_i) const
+natural_t HyperSpharmPlan::n_max() const
 {
-  return values_[get_index(theta_i, psi_i, phi_i)];
+  return n_max_;
 }
 
-void HyperSphericalSurface::set(natural_t theta_i, natural_t psi_i, natural_t phi_i, real_t radius)
+GridType HyperSpharmPlan::grid() const
 {
-  // TODO Check could be added (and then an unsafe method)
-  values_[get_index(theta_i, psi_i, phi_i)] = radius;
+  return grid_;
 }
 
-natural_t HyperSphericalSurface::theta_nb() const
+natural_t HyperSpharmPlan::half_theta_nb() const
 {
-  return theta_nb_;
+  return half_theta_nb_;
 }
 
-natural_t HyperSphericalSurface::psi_nb() const
+natural_t HyperSpharmPlan::l_nb() const
 {
-  return psi_nb_;
+  return l_nb_;
 }
 
-natural_t HyperSphericalSurface::phi_nb() const
+natural_t HyperSpharmPlan::m_nb() const
 {
-  return phi_nb_;
+  return (l_nb_ > 0) ? std::min(l_nb_, sphere_plan_.m_nb()) : 0;
 }
 
-std::vector<real_t> HyperSphericalSurface::thetas() const
+const std::vector<real_t> &HyperSpharmPlan::betas() const
 {
-  return std::vector<real_t>();
+  return betas_;
 }
 
-std::vector<real_t> HyperSphericalSurface::psis() const
+const std::vector<real_t> &HyperSpharmPlan::beta_weights() const
 {
-  return std::vector<real_t>();
+  return beta_weights_;
 }
 
-std::vector<real_t> HyperSphericalSurface::phis() const
+const SpharmPlan &HyperSpharmPlan::sphere_plan() const
 {
-  return std::vector<real_t>();
+  return sphere_plan_;
 }
 
-void HyperSphericalSurface::map(std::function<real_t()> func)
+const natural_t HyperSpharm::DESCRIPTOR_BLOCK_SIZE = 8;
+
+HyperSphericalCoeffs HyperSpharm::transform(const HyperSphericalSurface &surface)
 {
-  for(auto& value : values_)
+  const HyperSpharmPlan plan(surface.theta_nb(), surface.psi_nb(), surface.phi_nb(),
+                             surface.theta_nb(), surface.grid());
+  return transform(plan, surface);
+}
+
+HyperSphericalCoeffs HyperSpharm::transform(const HyperSpharmPlan &plan, const HyperSphericalSurface &surface)
+{
+  return transform(plan, surface.view());
+}
+
+HyperSphericalCoeffs HyperSpharm::transform(const HyperSpharmPlan &plan, const HyperSphericalSurfaceView &surface)
+{
+  HyperSphericalCoeffs result(0, CoeffsLayout::Tetrahedral);
+  Workspace workspace(required_bytes(plan));
+  transform(plan, surface, result, workspace);
+  return result;
+}
+
+natural_t HyperSpharm::required_bytes(const HyperSpharmPlan &plan)
+{
+  const auto thread_nb = static_cast<natural_t>(omp_get_max_threads());
+  const auto& sphere_plan = plan.sphere_plan();
+  const natural_t beta_nb = plan.theta_nb();
+  const natural_t folded_bytes = Workspace::aligned_size(thread_nb * 2 * plan.half_theta_nb() * sizeof(complex_t));
+  const natural_t orders_bytes = Workspace::aligned_size(get_order_nb(plan) * sizeof(Order));
+  // Forward: spherical stage of all the slices, then folded sums of the Gegenbauer stage
+  const natural_t forward_bytes = get_slices_bytes(plan, beta_nb) + Spharm::required_bytes(sphere_plan, beta_nb) +
+                                  orders_bytes + folded_bytes;
+  // Inverse: Gegenbauer sums into the coefficients of all the slices, then synthesis of one slice at a time
+  const natural_t inverse_bytes = Workspace::aligned_size(beta_nb * get_slice_coeffs_size(plan) * sizeof(complex_t)) +
+                                  orders_bytes + folded_bytes + Spharm::required_bytes(sphere_plan);
+  return std::max(std::max(forward_bytes, inverse_bytes), get_descriptors_bytes(plan, DESCRIPTOR_BLOCK_SIZE));
+}
+
+natural_t HyperSpharm::required_bytes(const HyperSpharmPlan &plan, const natural_t memory_budget)
+{
+  const auto thread_nb = static_cast<natural_t>(omp_get_max_threads());
+  const natural_t slab_size = get_slab_size(plan, memory_budget);
+  return get_slices_bytes(plan, slab_size) + Spharm::required_bytes(plan.sphere_plan(), slab_size) +
+         Workspace::aligned_size(get_order_nb(plan) * sizeof(Order)) +
+         Workspace::aligned_size(thread_nb * slab_size * sizeof(complex_t));
+}
+
+void HyperSpharm::transform(const HyperSpharmPlan &plan, const HyperSphericalSurfaceView &surface,
+                            HyperSphericalCoeffs &out, Workspace &workspace)
+{
+  check_surface(plan, surface);
+
+  const natural_t beta_nb = plan.theta_nb();
+  const natural_t n_nb = plan.n_max();
+  prepare_coeffs(plan, out);
+  if (n_nb == 0) { return; }
+
+  // fft along phi (parallel over the (beta, theta) rows) and Legendre contraction along theta
+  // (parallel over (m, beta)): batched spherical transform of the beta slices.
+  const natural_t mark = workspace.used();
+  const natural_t coeffs_size = get_slice_coeffs_size(plan);
+  const SphericalSurfaceView* slices = get_slices(plan, surface.data(), beta_nb, workspace);
+  complex_t* slice_harmonics = workspace.allocate<complex_t>(beta_nb * coeffs_size);
+  Spharm::spharm_transform_batch(plan.sphere_plan(), slices, beta_nb, slice_harmonics, workspace);
+
+  // Gegenbauer contraction along beta, parallel over (l, m):
+  // f_nlm = sum_k w_k sin^l(beta_k) NG^{l+1}_{n-l}(cos(beta_k)) f_lm(beta_k)
+  // The mirrored hyperangles are folded into the sums used by the even (n - l) and odd (n - l) degrees
+  const natural_t half_nb = plan.half_theta_nb();
+  const natural_t order_nb = get_order_nb(plan);
+  const Order* orders = get_orders(plan, workspace);
+  const auto& weights = plan.beta_weights();
+  complex_t* folded_buffers = workspace.allocate<complex_t>(
+      static_cast<natural_t>(omp_get_max_threads()) * 2 * half_nb);
+#pragma omp parallel
   {
-    value = func();
+    // Per thread scratch: folded w_k f_lm(beta_k)
+    complex_t* even = folded_buffers + (static_cast<natural_t>(omp_get_thread_num()) * 2 * half_nb);
+    complex_t* odd = even + half_nb;
+#pragma omp for schedule(dynamic)
+    for (natural_t order_i = 0; order_i < order_nb; ++order_i)
+    {
+      const natural_t l = orders[order_i].l;
+      const natural_t m = orders[order_i].m;
+      const natural_t index = ((l * (l + 1)) / 2) + m;
+      for (natural_t beta_i = 0; beta_i < half_nb; ++beta_i)
+      {
+        const natural_t mirror_i = beta_nb - 1 - beta_i;
+        const complex_t north = weights[beta_i] * slice_harmonics[(beta_i * coeffs_size) + index];
+        even[beta_i] = north;
+        odd[beta_i] = north;
+        if (mirror_i != beta_i)
+        {
+          const complex_t south = weights[mirror_i] * slice_harmonics[(mirror_i * coeffs_size) + index];
+          even[beta_i] += south;
+          odd[beta_i] -= south;
+        }
+      }
+      for (natural_t n = l; n < n_nb; ++n)
+      {
+        const real_t* gegenbauer = plan.gegenbauer(l, n);
+        const complex_t* folded = is_even(n - l) ? even : odd;
+        complex_t fnlm = {0, 0};
+        for (natural_t beta_i = 0; beta_i < half_nb; ++beta_i)
+        {
+          fnlm += gegenbauer[beta_i] * folded[beta_i];
+        }
+        out.set(n, l, m, fnlm);
+      }
+    }
   }
+  workspace.rewind(mark);
+}
+
+HyperSphericalCoeffs HyperSpharm::transform(const HyperSpharmPlan &plan, const MappedFile &file,
+                                             const natural_t offset, const natural_t memory_budget)
+{
+  HyperSphericalCoeffs result(0, CoeffsLayout::Tetrahedral);
+  Workspace workspace(required_bytes(plan, memory_budget));
+  transform(plan, file, offset, memory_budget, result, workspace);
+  return result;
 }
 
-void HyperSphericalSurface::map(std::function<real_t(real_t)> func)
+void HyperSpharm::transform(const HyperSpharmPlan &plan, const MappedFile &file, const natural_t offset,
+                            const natural_t memory_budget, HyperSphericalCoeffs &out, Workspace &workspace)
 {
-  for(auto& value : values_)
+  const natural_t beta_nb = plan.theta_nb();
+  const natural_t slice_size = plan.psi_nb() * plan.phi_nb();
+  const natural_t slice_bytes = slice_size * sizeof(real_t);
+  if ((offset + (beta_nb * slice_bytes)) > file.size())
+  {
+    throw std::invalid_argument( "HyperSpharm transform: the file is too small for the plan" );
+  }
+  if ((offset % sizeof(real_t)) != 0)
   {
-    value = func(value);
+    throw std::invalid_argument( "HyperSpharm transform: the offset must be a multiple of sizeof(real_t)" );
   }
+
+  prepare_coeffs(plan, out);
+  if (plan.n_max() == 0) { return; }
+
+  const natural_t mark = workspace.used();
+  const natural_t slab_size = get_slab_size(plan, memory_budget);
+  const real_t* values = reinterpret_cast<const real_t*>(file.data() + offset);
+  SphericalSurfaceView* slices = get_slices(plan, values, slab_size, workspace);
+  complex_t* slice_harmonics = workspace.allocate<complex_t>(slab_size * get_slice_coeffs_size(plan));
+  file.will_need(offset, std::min(slab_size, beta_nb) * slice_bytes);
+  for (natural_t first = 0; first < beta_nb; first += slab_size)
+  {
+    const natural_t count = std::min(slab_size, beta_nb - first);
+    const natural_t next_count = std::min(slab_size, beta_nb - (first + count));
+    file.will_need(offset + ((first + count) * slice_bytes), next_count * slice_bytes);
+
+    // The spherical transforms read the mapped pages in place
+    for (natural_t slice_i = 0; slice_i < count; ++slice_i)
+    {
+      slices[slice_i] = SphericalSurfaceView(values + ((first + slice_i) * slice_size), plan.psi_nb(),
+                                             plan.phi_nb(), plan.phi_nb(), plan.grid());
+    }
+    Spharm::spharm_transform_batch(plan.sphere_plan(), slices, count, slice_harmonics, workspace);
+    file.dont_need(offset + (first * slice_bytes), count * slice_bytes);
+    accumulate_gegenbauer(plan, slice_harmonics, first, count, out, workspace);
+  }
+  workspace.rewind(mark);
+}
+
+natural_t HyperSpharm::descriptor_size(const HyperSpharmPlan &plan)
+{
+  return descriptor_index(plan.n_max(), 0);
+}
+
+std::vector<float> HyperSpharm::descriptors(const HyperSpharmPlan &plan, const HyperSphericalSurface &surface)
+{
+  std::vector<float> result(descriptor_size(plan));
+  descriptors_batch(plan, &surface, 1, result.data());
+  return result;
+}
+
+void HyperSpharm::descriptors_batch(const HyperSpharmPlan &plan, const HyperSphericalSurface *surfaces,
+                                    const natural_t count, float *out)
+{
+  Workspace workspace(get_descriptors_bytes(plan, std::min(DESCRIPTOR_BLOCK_SIZE, count)));
+  descriptors_batch(plan, surfaces, count, out, workspace);
 }
 
-void HyperSphericalSurface::map(std::function<real_t(natural_t, natural_t,
-                                                     natural_t, real_t)> func)
+void HyperSpharm::descriptors_batch(const HyperSpharmPlan &plan, const HyperSphericalSurface *surfaces,
+                                    const natural_t count, float *out, Workspace &workspace)
 {
-  natural_t n = 0;
-  natural_t l = 0;
-  natural_t m = 0;
-  for (natural_t i = 0; i < (theta_nb_ * psi_nb_ * phi_nb_); ++i)
+  for (natural_t shape_i = 0; shape_i < count; ++shape_i)
+  {
+    check_surface(plan, surfaces[shape_i].view());
+  }
+
+  const natural_t beta_nb = plan.theta_nb();
+  const natural_t half_nb = plan.half_theta_nb();
+  const natural_t n_nb = plan.n_max();
+  const natural_t l_nb = plan.l_nb();
+  const natural_t m_nb = plan.m_nb();
+  const natural_t size = descriptor_size(plan);
+  if ((size == 0) || (count == 0)) { return; }
+  const auto& weights = plan.beta_weights();
+
+  const natural_t mark = workspace.used();
+  const natural_t coeffs_size = get_slice_coeffs_size(plan);
+  const natural_t block_size = std::min(DESCRIPTOR_BLOCK_SIZE, count);
+  SphericalSurfaceView* slices = get_slices(plan, surfaces[0].values().data(), block_size * beta_nb, workspace);
+  complex_t* slice_harmonics = workspace.allocate<complex_t>(block_size * beta_nb * coeffs_size);
+  const natural_t scratch_size = (4 * half_nb) + n_nb;
+  real_t* scratch_buffers = workspace.allocate<real_t>(static_cast<natural_t>(omp_get_max_threads()) * scratch_size);
+  for (natural_t first = 0; first < count; first += DESCRIPTOR_BLOCK_SIZE)
   {
-    if (phi_nb_ == m)
+    // Spherical stage of all the hyperangles of the block of shapes in a single batch
+    const natural_t block_nb = std::min(DESCRIPTOR_BLOCK_SIZE, count - first);
+    for (natural_t shape_i = 0; shape_i < block_nb; ++shape_i)
     {
-      ++l;
-      m = 0;
+      const real_t* values = surfaces[first + shape_i].values().data();
+      for (natural_t beta_i = 0; beta_i < beta_nb; ++beta_i)
+      {
+        slices[(shape_i * beta_nb) + beta_i] = SphericalSurfaceView(
+            values + (beta_i * plan.psi_nb() * plan.phi_nb()), plan.psi_nb(), plan.phi_nb(), plan.phi_nb(),
+            plan.grid());
+      }
     }
-    if (psi_nb_ == l)
+    Spharm::spharm_transform_batch(plan.sphere_plan(), slices, block_nb * beta_nb, slice_harmonics, workspace);
+
+    // The degrees l >= plan.l_nb() (psi grid too coarse for n_max) are not computed: their energies are 0,
+    // as their coefficients in the transform
+    std::fill_n(out + (first * size), block_nb * size, 0.0f);
+
+    // Gegenbauer stage fused with the energies: each (shape, l) owns the descriptors (n, l)
+#pragma omp parallel
     {
-      ++n;
-      l = 0;
+      // Per thread scratch: folded w_k f_lm(beta_k) split in real and imaginary parts, and the energies
+      real_t* even_re = scratch_buffers + (static_cast<natural_t>(omp_get_thread_num()) * scratch_size);
+      real_t* even_im = even_re + half_nb;
+      real_t* odd_re = even_im + half_nb;
+      real_t* odd_im = odd_re + half_nb;
+      real_t* energies = odd_im + half_nb;
+#pragma omp for collapse(2) schedule(dynamic)
+      for (natural_t shape_i = 0; shape_i < block_nb; ++shape_i)
+      {
+        for (natural_t l = 0; l < l_nb; ++l)
+        {
+          const complex_t* harmonics = slice_harmonics + (shape_i * beta_nb * coeffs_size);
+          std::fill_n(energies, n_nb, 0.0);
+          for (natural_t m = 0; m < std::min(l + 1, m_nb); ++m)
+          {
+            const natural_t index = ((l * (l + 1)) / 2) + m;
+            for (natural_t beta_i = 0; beta_i < half_nb; ++beta_i)
+            {
+              const natural_t mirror_i = beta_nb - 1 - beta_i;
+              complex_t even = weights[beta_i] * harmonics[(beta_i * coeffs_size) + index];
+              complex_t odd = even;
+              if (mirror_i != beta_i)
+              {
+                const complex_t south = weights[mirror_i] * harmonics[(mirror_i * coeffs_size) + index];
+                even += south;
+                odd -= south;
+              }
+              even_re[beta_i] = even.real();
+              even_im[beta_i] = even.imag();
+              odd_re[beta_i] = odd.real();
+              odd_im[beta_i] = odd.imag();
+            }
+            // The negative orders have the same energy as the positive ones
+            const real_t multiplicity = (m == 0) ? 1.0 : 2.0;
+            for (natural_t n = l; n < n_nb; ++n)
+            {
+              const real_t* gegenbauer = plan.gegenbauer(l, n);
+              const real_t* folded_re = is_even(n - l) ? even_re : odd_re;
+              const real_t* folded_im = is_even(n - l) ? even_im : odd_im;
+              real_t re = 0, im = 0;
+#pragma omp simd reduction(+:re, im)
+              for (natural_t beta_i = 0; beta_i < half_nb; ++beta_i)
+              {
+                re += gegenbauer[beta_i] * folded_re[beta_i];
+                im += gegenbauer[beta_i] * folded_im[beta_i];
+              }
+              energies[n] += multiplicity * ((re * re) + (im * im));
+            }
+          }
+          float* descriptors = out + ((first + shape_i) * size);
+          for (natural_t n = l; n < n_nb; ++n)
+          {
+            descriptors[descriptor_index(n, l)] = static_cast<float>(energies[n]);
+          }
+        }
+      }
     }
-    values_[i] = func(n, l, m, values_[i]);
-    ++m;
   }
+  workspace.rewind(mark);
 }
 
-std::string HyperSphericalSurface::to_string() const
+HyperSphericalSurface HyperSpharm::transform(const HyperSphericalCoeffs &coeffs)
 {
-  return "TODO";
+  const natural_t n_max = coeffs.n_max();
+  natural_t size = 1;
+  while (size < (2 * n_max)) { size *= 2; }
+  const HyperSpharmPlan plan(n_max, size, size, n_max);
+  return transform(plan, coeffs);
 }
 
-std::vector<real_t> &HyperSphericalSurface::values()
+HyperSphericalSurface HyperSpharm::transform(const HyperSpharmPlan &plan, const HyperSphericalCoeffs &coeffs)
 {
-  return values_;
+  HyperSphericalSurface result(plan.theta_nb(), plan.psi_nb(), plan.phi_nb(), plan.grid());
+  Workspace workspace(required_bytes(plan));
+  transform(plan, coeffs, result, workspace);
+  return result;
 }
 
-HyperSphericalCoeffs::HyperSphericalCoeffs(natural_t n_max, natural_t l_max, natural_t m_max):
-  n_max_(n_max), l_max_(l_max), m_max_(m_max), values_(n_max * l_max * m_max)
+void HyperSpharm::transform(const HyperSpharmPlan &plan, const HyperSphericalCoeffs &coeffs,
+                            HyperSphericalSurface &out, Workspace &workspace)
 {
-}
+  const natural_t beta_nb = plan.theta_nb();
+  const natural_t psi_nb = plan.psi_nb();
+  const natural_t phi_nb = plan.phi_nb();
+  const natural_t n_nb = std::min(plan.n_max(), coeffs.n_max());
+  if ((out.theta_nb() != beta_nb) || (out.psi_nb() != psi_nb) || (out.phi_nb() != phi_nb) ||
+      (out.grid() != plan.grid()))
+  {
+    out = HyperSphericalSurface(beta_nb, psi_nb, phi_nb, plan.grid());
+  }
+  if (n_nb == 0)
+  {
+    std::fill(out.values().begin(), out.values().end(), 0.0);
+    return;
+  }
 
-HyperSphericalCoeffs::HyperSphericalCoeffs(natural_t n_max, natural_t l_max,
-                                           natural_t m_max, complex_t init_val):
-    n_max_(n_max), l_max_(l_max), m_max_(m_max), values_(n_max * l_max * m_max, init_val)
-{
+  // The coefficients the plan does not compute are 0. Filled with the static schedule of the slices
+  // (first touch of the pages by the threads writing them)
+  const auto& sphere_plan = plan.sphere_plan();
+  const natural_t mark = workspace.used();
+  const natural_t coeffs_size = get_slice_coeffs_size(plan);
+  complex_t* slice_harmonics = workspace.allocate<complex_t>(beta_nb * coeffs_size);
+#pragma omp parallel for schedule(static)
+  for (natural_t beta_i = 0; beta_i < beta_nb; ++beta_i)
+  {
+    std::fill_n(slice_harmonics + (beta_i * coeffs_size), coeffs_size, complex_t(0, 0));
+  }
+
+  // Gegenbauer sum over n, parallel over (l, m):
+  // f_lm(beta_k) = sum_n sin^l(beta_k) NG^{l+1}_{n-l}(cos(beta_k)) f_nlm
+  // The even (n - l) and odd (n - l) sums are computed on the first half of the hyperangles:
+  // f_lm(beta_k) = even_k + odd_k and f_lm(pi - beta_k) = even_k - odd_k
+  const natural_t half_nb = plan.half_theta_nb();
+  const natural_t order_nb = get_order_nb(plan);
+  const Order* orders = get_orders(plan, workspace);
+  complex_t* folded_buffers = workspace.allocate<complex_t>(
+      static_cast<natural_t>(omp_get_max_threads()) * 2 * half_nb);
+#pragma omp parallel
+  {
+    // Per thread scratch: even and odd sums
+    complex_t* even = folded_buffers + (static_cast<natural_t>(omp_get_thread_num()) * 2 * half_nb);
+    complex_t* odd = even + half_nb;
+#pragma omp for schedule(dynamic)
+    for (natural_t order_i = 0; order_i < order_nb; ++order_i)
+    {
+      const natural_t l = orders[order_i].l;
+      const natural_t m = orders[order_i].m;
+      if ((l >= coeffs.l_max()) || (m >= coeffs.m_max())) { continue; }
+      const natural_t index = ((l * (l + 1)) / 2) + m;
+      std::fill_n(even, half_nb, complex_t(0, 0));
+      std::fill_n(odd, half_nb, complex_t(0, 0));
+      for (natural_t n = l; n < n_nb; ++n)
+      {
+        const real_t* gegenbauer = plan.gegenbauer(l, n);
+        const complex_t fnlm = coeffs.get(n, l, m);
+        complex_t* folded = is_even(n - l) ? even : odd;
+        for (natural_t beta_i = 0; beta_i < half_nb; ++beta_i)
+        {
+          folded[beta_i] += gegenbauer[beta_i] * fnlm;
+        }
+      }
+      for (natural_t beta_i = 0; beta_i < half_nb; ++beta_i)
+      {
+        const natural_t mirror_i = beta_nb - 1 - beta_i;
+        slice_harmonics[(beta_i * coeffs_size) + index] = even[beta_i] + odd[beta_i];
+        if (mirror_i != beta_i)
+        {
+          slice_harmonics[(mirror_i * coeffs_size) + index] = even[beta_i] - odd[beta_i];
+        }
+      }
+    }
+  }
+
+  // Legendre sum over l and inverse fft over phi of each beta slice, written in place
+  // (each spherical synthesis is parallel over m and the theta rows)
+  const natural_t slice_size = psi_nb * phi_nb;
+  for (natural_t beta_i = 0; beta_i < beta_nb; ++beta_i)
+  {
+    const SphericalHarmonicsView harmonics(slice_harmonics + (beta_i * coeffs_size), sphere_plan.l_max());
+    Spharm::ispharm_transform(sphere_plan, harmonics, out.values().data() + (beta_i * slice_size), workspace);
+  }
+  workspace.rewind(mark);
 }
 
-complex_t HyperSphericalCoeffs::get(natural_t n, natural_t l, natural_t m) const
+natural_t HyperSpharm::get_order_nb(const HyperSpharmPlan &plan)
 {
-  return values_[get_index(n, l, m)];
+  natural_t order_nb = 0;
+  for (natural_t l = 0; l < plan.l_nb(); ++l)
+  {
+    order_nb += std::min(l + 1, plan.m_nb());
+  }
+  return order_nb;
 }
 
-void HyperSphericalCoeffs::set(natural_t n, natural_t l, natural_t m, complex_t value)
+HyperSpharm::Order* HyperSpharm::get_orders(const HyperSpharmPlan &plan, Workspace &workspace)
 {
-  values_[get_index(n, l, m)] = value;
+  Order* orders = workspace.allocate<Order>(get_order_nb(plan));
+  natural_t order_i = 0;
+  for (natural_t l = 0; l < plan.l_nb(); ++l)
+  {
+    for (natural_t m = 0; m < std::min(l + 1, plan.m_nb()); ++m)
+    {
+      orders[order_i++] = {l, m};
+    }
+  }
+  return orders;
 }
 
-natural_t HyperSphericalCoeffs::n_max() const
+natural_t HyperSpharm::get_slice_coeffs_size(const HyperSpharmPlan &plan)
 {
-  return n_max_;
+  const natural_t l_max = plan.sphere_plan().l_max();
+  return ((l_max + 1) * (l_max + 2)) / 2;
 }
 
-natural_t HyperSphericalCoeffs::l_max() const
+natural_t HyperSpharm::get_slices_bytes(const HyperSpharmPlan &plan, const natural_t count)
 {
-  return l_max_;
+  return Workspace::aligned_size(count * sizeof(SphericalSurfaceView)) +
+         Workspace::aligned_size(count * get_slice_coeffs_size(plan) * sizeof(complex_t));
 }
 
-natural_t HyperSphericalCoeffs::m_max() const
+natural_t HyperSpharm::get_descriptors_bytes(const HyperSpharmPlan &plan, const natural_t block_size)
 {
-  return m_max_;
+  const auto thread_nb = static_cast<natural_t>(omp_get_max_threads());
+  const natural_t slice_nb = block_size * plan.theta_nb();
+  return get_slices_bytes(plan, slice_nb) + Spharm::required_bytes(plan.sphere_plan(), slice_nb) +
+         Workspace::aligned_size(thread_nb * ((4 * plan.half_theta_nb()) + plan.n_max()) * sizeof(real_t));
 }
 
-void HyperSphericalCoeffs::map(std::function<complex_t()> func)
+SphericalSurfaceView* HyperSpharm::get_slices(const HyperSpharmPlan &plan, const real_t *values,
+                                              const natural_t count, Workspace &workspace)
 {
-  for(auto& value : values_)
+  const natural_t psi_nb = plan.psi_nb();
+  const natural_t phi_nb = plan.phi_nb();
+  SphericalSurfaceView* slices = workspace.allocate<SphericalSurfaceView>(count);
+  for (natural_t slice_i = 0; slice_i < count; ++slice_i)
   {
-    value = func();
+    new (slices + slice_i) SphericalSurfaceView(values + (slice_i * psi_nb * phi_nb), psi_nb, phi_nb, phi_nb,
+                                                plan.grid());
   }
+  return slices;
 }
 
-void HyperSphericalCoeffs::map(std::function<complex_t(complex_t)> func)
+void HyperSpharm::prepare_coeffs(const HyperSpharmPlan &plan, HyperSphericalCoeffs &coeffs)
 {
-  for(auto& value : values_)
+  if ((coeffs.n_max() != plan.n_max()) || (coeffs.layout() != CoeffsLayout::Tetrahedral))
+  {
+    coeffs = HyperSphericalCoeffs(plan.n_max(), CoeffsLayout::Tetrahedral);
+  }
+  else
   {
-    value = func(value);
+    std::fill(coeffs.values().begin(), coeffs.values().end(), complex_t(0, 0));
   }
 }
 
-void HyperSphericalCoeffs::map(std::function<complex_t(natural_t, natural_t,
-                                                       natural_t, complex_t)> func)
+void HyperSpharm::accumulate_gegenbauer(const HyperSpharmPlan &plan, const complex_t *slice_harmonics,
+                                        const natural_t first, const natural_t count, HyperSphericalCoeffs &coeffs,
+                                        Workspace &workspace)
 {
-  natural_t n = 0;
-  natural_t l = 0;
-  natural_t m = 0;
-  for (natural_t i = 0; i < values_.size(); ++i)
+  const natural_t beta_nb = plan.theta_nb();
+  const natural_t half_nb = plan.half_theta_nb();
+  const natural_t n_nb = plan.n_max();
+  const natural_t coeffs_size = get_slice_coeffs_size(plan);
+  const natural_t mark = workspace.used();
+  const natural_t order_nb = get_order_nb(plan);
+  const Order* orders = get_orders(plan, workspace);
+  complex_t* flm_buffers = workspace.allocate<complex_t>(static_cast<natural_t>(omp_get_max_threads()) * count);
+  const auto& weights = plan.beta_weights();
+  auto& values = coeffs.values();
+#pragma omp parallel
   {
-    if (m_max_ == m)
-    {
-      ++l;
-      m = 0;
-    }
-    if (l_max_ == l)
+    // Per thread scratch: w_k f_lm(beta_k)
+    complex_t* flm = flm_buffers + (static_cast<natural_t>(omp_get_thread_num()) * count);
+#pragma omp for schedule(dynamic)
+    for (natural_t order_i = 0; order_i < order_nb; ++order_i)
     {
-      ++n;
-      l = 0;
+      const natural_t l = orders[order_i].l;
+      const natural_t m = orders[order_i].m;
+      const natural_t index = ((l * (l + 1)) / 2) + m;
+      for (natural_t slice_i = 0; slice_i < count; ++slice_i)
+      {
+        flm[slice_i] = weights[first + slice_i] * slice_harmonics[(slice_i * coeffs_size) + index];
+      }
+      for (natural_t n = l; n < n_nb; ++n)
+      {
+        // The table only holds the first half of the hyperangles: the others are mirrored
+        const real_t* gegenbauer = plan.gegenbauer(l, n);
+        const real_t mirror_sign = minus_one_power(n - l);
+        complex_t fnlm = {0, 0};
+        for (natural_t slice_i = 0; slice_i < count; ++slice_i)
+        {
+          const natural_t beta_i = first + slice_i;
+          const real_t g = (beta_i < half_nb) ? gegenbauer[beta_i] : mirror_sign * gegenbauer[beta_nb - 1 - beta_i];
+          fnlm += g * flm[slice_i];
+        }
+        values[coeffs.get_index(n, l, m)] += fnlm;
+      }
     }
-    values_[i] = func(n, l, m, values_[i]);
-    ++m;
   }
+  workspace.rewind(mark);
 }
 
-std::string HyperSphericalCoeffs::to_string()
+void HyperSpharm::check_surface(const HyperSpharmPlan &plan, const HyperSphericalSurfaceView &surface)
 {
-  return "TODO";
+  if ((surface.theta_nb() != plan.theta_nb()) || (surface.psi_nb() != plan.psi_nb()) ||
+      (surface.phi_nb() != plan.phi_nb()) || (surface.grid() != plan.grid()))
+  {
+    throw std::invalid_argument( "HyperSpharm transform: the surface must have the size and grid of the plan" );
+  }
 }
 
-std::vector<complex_t>& HyperSphericalCoeffs::values()
+natural_t HyperSpharm::get_slab_size(const HyperSpharmPlan &plan, const natural_t memory_budget)
 {
-  return values_;
+  const auto& sphere_plan = plan.sphere_plan();
+  const natural_t slice_bytes = plan.psi_nb() * plan.phi_nb() * sizeof(real_t);
+  // Mapped pages of the slab and of the prefetched one (read in place), ffts of the rows and
+  // spherical coefficients
+  const natural_t bytes_per_beta = (2 * slice_bytes) + (plan.psi_nb() * sphere_plan.m_nb() * sizeof(complex_t)) +
+                                   (((sphere_plan.l_max() + 1) * (sphere_plan.l_max() + 2)) / 2) * sizeof(complex_t);
+  return std::max<natural_t>(1, std::min(plan.theta_nb(), memory_budget / bytes_per_beta));
 }
 
-}
\ No newline at end of file
+}
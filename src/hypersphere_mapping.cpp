@@ -0,0 +1,159 @@
+/**
+ * @file hypersphere_mapping.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Mapping of 3D data (voxel grids, point clouds) onto the 3-sphere
+ */
+
+#include "hypersphere_mapping.h"
+
+namespace hyperspharm
+{
+
+const natural_t HyperSphereMapping::BETA_BLOCK_SIZE = 16;
+const natural_t HyperSphereMapping::PSI_BLOCK_SIZE = 8;
+
+void HyperSphereMapping::map_volume(const VolumeView &volume, HyperSphericalSurface &surface,
+                                    const Interpolation interpolation)
+{
+  if ((volume.x_nb == 0) || (volume.y_nb == 0) || (volume.z_nb == 0))
+  {
+    throw std::invalid_argument( "HyperSphereMapping map_volume: the volume is empty" );
+  }
+
+  const natural_t beta_nb = surface.theta_nb();
+  const natural_t psi_nb = surface.psi_nb();
+  const natural_t phi_nb = surface.phi_nb();
+  if ((beta_nb == 0) || (psi_nb == 0) || (phi_nb == 0)) { return; }
+
+  const real_t center_x = static_cast<real_t>(volume.x_nb - 1) / 2.0;
+  const real_t center_y = static_cast<real_t>(volume.y_nb - 1) / 2.0;
+  const real_t center_z = static_cast<real_t>(volume.z_nb - 1) / 2.0;
+  const real_t radius = static_cast<real_t>(std::min({volume.x_nb, volume.y_nb, volume.z_nb}) - 1) / 2.0;
+
+  // Unit directions of the (psi, phi) samples, shared by all the hyperangles
+  const auto psis = surface.psis();
+  const auto phis = surface.phis();
+  std::vector<real_t> directions(3 * psi_nb * phi_nb);
+  for (natural_t psi_i = 0; psi_i < psi_nb; ++psi_i)
+  {
+    for (natural_t phi_i = 0; phi_i < phi_nb; ++phi_i)
+    {
+      real_t* direction = directions.data() + (3 * ((psi_i * phi_nb) + phi_i));
+      direction[0] = std::sin(psis[psi_i]) * std::cos(phis[phi_i]);
+      direction[1] = std::sin(psis[psi_i]) * std::sin(phis[phi_i]);
+      direction[2] = std::cos(psis[psi_i]);
+    }
+  }
+
+  const auto betas = surface.thetas();
+  const natural_t x_nb = volume.x_nb;
+  const natural_t y_nb = volume.y_nb;
+  const real_t* voxels = volume.values;
+  real_t* values = surface.values().data();
+  const natural_t beta_block_nb = (beta_nb + BETA_BLOCK_SIZE - 1) / BETA_BLOCK_SIZE;
+  const natural_t psi_block_nb = (psi_nb + PSI_BLOCK_SIZE - 1) / PSI_BLOCK_SIZE;
+#pragma omp parallel for collapse(2) schedule(static)
+  for (natural_t psi_block = 0; psi_block < psi_block_nb; ++psi_block)
+  {
+    for (natural_t beta_block = 0; beta_block < beta_block_nb; ++beta_block)
+    {
+      const natural_t psi_end = std::min(psi_nb, (psi_block + 1) * PSI_BLOCK_SIZE);
+      const natural_t beta_end = std::min(beta_nb, (beta_block + 1) * BETA_BLOCK_SIZE);
+      for (natural_t beta_i = beta_block * BETA_BLOCK_SIZE; beta_i < beta_end; ++beta_i)
+      {
+        const real_t r = radius * betas[beta_i] / M_PI;
+        for (natural_t psi_i = psi_block * PSI_BLOCK_SIZE; psi_i < psi_end; ++psi_i)
+        {
+          real_t* row = values + surface.get_index(beta_i, psi_i, 0);
+          const real_t* row_directions = directions.data() + (3 * psi_i * phi_nb);
+          for (natural_t phi_i = 0; phi_i < phi_nb; ++phi_i)
+          {
+            // The sampled points stay in the inscribed ball: no bound checks are needed on the lower corner
+            const real_t x = center_x + (r * row_directions[3 * phi_i]);
+            const real_t y = center_y + (r * row_directions[(3 * phi_i) + 1]);
+            const real_t z = center_z + (r * row_directions[(3 * phi_i) + 2]);
+            if (interpolation == Interpolation::Nearest)
+            {
+              const auto x_i = static_cast<natural_t>(x + 0.5);
+              const auto y_i = static_cast<natural_t>(y + 0.5);
+              const auto z_i = static_cast<natural_t>(z + 0.5);
+              row[phi_i] = voxels[(((z_i * y_nb) + y_i) * x_nb) + x_i];
+              continue;
+            }
+
+            const auto x_i = std::min(static_cast<natural_t>(x), x_nb - 1);
+            const auto y_i = std::min(static_cast<natural_t>(y), y_nb - 1);
+            const auto z_i = std::min(static_cast<natural_t>(z), volume.z_nb - 1);
+            const real_t dx = x - static_cast<real_t>(x_i);
+            const real_t dy = y - static_cast<real_t>(y_i);
+            const real_t dz = z - static_cast<real_t>(z_i);
+            // Steps to the upper corner, 0 on the last voxel of an axis
+            const natural_t step_x = (x_i + 1 < x_nb) ? 1 : 0;
+            const natural_t step_y = (y_i + 1 < y_nb) ? x_nb : 0;
+            const natural_t step_z = (z_i + 1 < volume.z_nb) ? (x_nb * y_nb) : 0;
+            const real_t* corner = voxels + (((z_i * y_nb) + y_i) * x_nb) + x_i;
+            const real_t c00 = corner[0] + dx * (corner[step_x] - corner[0]);
+            const real_t c10 = corner[step_y] + dx * (corner[step_y + step_x] - corner[step_y]);
+            const real_t c01 = corner[step_z] + dx * (corner[step_z + step_x] - corner[step_z]);
+            const real_t c11 = corner[step_z + step_y] +
+                               dx * (corner[step_z + step_y + step_x] - corner[step_z + step_y]);
+            const real_t c0 = c00 + dy * (c10 - c00);
+            const real_t c1 = c01 + dy * (c11 - c01);
+            row[phi_i] = c0 + dz * (c1 - c0);
+          }
+        }
+      }
+    }
+  }
+}
+
+void HyperSphereMapping::bin_points(const real_t *points, const real_t *weights, const natural_t count,
+                                    const real_t radius, HyperSphericalSurface &surface)
+{
+  if (!(radius > 0))
+  {
+    throw std::invalid_argument( "HyperSphereMapping bin_points: the radius must be positive" );
+  }
+
+  const natural_t beta_nb = surface.theta_nb();
+  const natural_t phi_nb = surface.phi_nb();
+  if ((beta_nb == 0) || (surface.psi_nb() == 0) || (phi_nb == 0)) { return; }
+
+  const auto psis = surface.psis();
+  real_t* values = surface.values().data();
+#pragma omp parallel for schedule(static)
+  for (natural_t point_i = 0; point_i < count; ++point_i)
+  {
+    const real_t* point = points + (3 * point_i);
+    const real_t r = std::sqrt((point[0] * point[0]) + (point[1] * point[1]) + (point[2] * point[2]));
+    if (r > radius) { continue; }
+
+    // Hyperangles beta_k = (k + 1) pi / (beta_nb + 1)
+    const real_t beta_position = (r / radius) * static_cast<real_t>(beta_nb + 1);
+    const natural_t beta_i = std::min(beta_nb, std::max<natural_t>(1, static_cast<natural_t>(beta_position + 0.5))) - 1;
+    const real_t psi = (r > 0) ? std::acos(std::max(-1.0, std::min(1.0, point[2] / r))) : 0.0;
+    const natural_t psi_i = get_closest(psis, psi);
+    real_t phi = std::atan2(point[1], point[0]);
+    if (phi < 0) { phi += 2.0 * M_PI; }
+    const natural_t phi_i = static_cast<natural_t>((phi * static_cast<real_t>(phi_nb) / (2.0 * M_PI)) + 0.5) % phi_nb;
+
+    const real_t weight = (weights != nullptr) ? weights[point_i] : 1.0;
+#pragma omp atomic
+    values[surface.get_index(beta_i, psi_i, phi_i)] += weight;
+  }
+}
+
+natural_t HyperSphereMapping::get_closest(const std::vector<real_t> &values, const real_t value)
+{
+  const auto upper = std::lower_bound(values.begin(), values.end(), value);
+  if (upper == values.begin()) { return 0; }
+  if (upper == values.end()) { return values.size() - 1; }
+  const auto lower = upper - 1;
+  return static_cast<natural_t>(((value - *lower) <= (*upper - value)) ? (lower - values.begin())
+                                                                       : (upper - values.begin()));
+}
+
+}
@@ -175,8 +175,17 @@ real_t LegendrePoly::get_spharm_normalized(const natural_t l,
 NormalizedLegendreArray LegendrePoly::get_norm_array(const real_t normalization_coeff,
                                                      const natural_t l_max,
                                                      const real_t x)
+{
+  return get_norm_array(normalization_coeff, l_max, l_max, x);
+}
+
+NormalizedLegendreArray LegendrePoly::get_norm_array(const real_t normalization_coeff,
+                                                     const natural_t l_max,
+                                                     const natural_t m_max,
+                                                     const real_t x)
 {
   NormalizedLegendreArray result(l_max);
+  const natural_t last_m = std::min(l_max, m_max);
 
   // Compute N_m^m
   result.values_[0][0] = 1.0;
@@ -184,7 +193,7 @@ NormalizedLegendreArray LegendrePoly::get_norm_array(const real_t normalization_
   if (l_max != 0)
   {
     const real_t poly_sqrt = -std::sqrt(static_cast<real_t>(1.0) - (x * x));
-    for (natural_t i = 1; i <= l_max; i++)
+    for (natural_t i = 1; i <= last_m; i++)
     {
       pi_i = poly_sqrt * (pi_i * std::sqrt(static_cast<real_t>(2*i + 1) / static_cast<real_t>(2*i)));
       result.values_[i][i] = pi_i;
@@ -192,7 +201,7 @@ NormalizedLegendreArray LegendrePoly::get_norm_array(const real_t normalization_
   }
 
   compute_coefficients(l_max);
-  for (natural_t m = 0; m < l_max; ++m)
+  for (natural_t m = 0; (m < l_max) && (m <= last_m); ++m)
   {
     auto& values_m = result.values_[m];
     values_m[m + 1] = x * std::sqrt(static_cast<real_t>(m * 2 + 3)) * values_m[m];
@@ -205,9 +214,9 @@ NormalizedLegendreArray LegendrePoly::get_norm_array(const real_t normalization_
     }
   }
 
-  for (auto& values : result.values_)
+  for (natural_t m = 0; m <= last_m; ++m)
   {
-    for (auto& value : values)
+    for (auto& value : result.values_[m])
     {
       value *= normalization_coeff;
     }
@@ -216,6 +225,42 @@ NormalizedLegendreArray LegendrePoly::get_norm_array(const real_t normalization_
   return result;
 }
 
+void LegendrePoly::get_norm_order(const real_t normalization_coeff,
+                                  const natural_t l_max,
+                                  const natural_t m,
+                                  const real_t x,
+                                  real_t* out)
+{
+  // Compute N_m^m with the same sequence of operations as get_norm_array
+  real_t pi_i = 1.0;
+  if (l_max != 0)
+  {
+    const real_t poly_sqrt = -std::sqrt(static_cast<real_t>(1.0) - (x * x));
+    for (natural_t i = 1; i <= m; i++)
+    {
+      pi_i = poly_sqrt * (pi_i * std::sqrt(static_cast<real_t>(2*i + 1) / static_cast<real_t>(2*i)));
+    }
+  }
+  out[0] = pi_i;
+
+  compute_coefficients(l_max);
+  if (m < l_max)
+  {
+    out[1] = x * std::sqrt(static_cast<real_t>(m * 2 + 3)) * out[0];
+    const auto& coeffs_m = coeffs_[m];
+    for (natural_t l = (m + 2); l <= l_max; ++l)
+    {
+      out[l - m] = (coeffs_m[l].alm * x * out[l - m - 1]) -
+                   (coeffs_m[l].blm * out[l - m - 2]);
+    }
+  }
+
+  for (natural_t l = m; l <= l_max; ++l)
+  {
+    out[l - m] *= normalization_coeff;
+  }
+}
+
 NormalizedLegendreArray LegendrePoly::get_fully_norm_array(const natural_t l_max, const real_t x)
 {
   return get_norm_array(FULLY_NORM, l_max, x);
@@ -249,72 +294,4 @@ void LegendrePoly::compute_coefficients(const natural_t l_max)
   }
 }
 
-NormalizedLegendreArray::NormalizedLegendreArray(const natural_t l_max) :
-  l_max_(l_max)
-{
-  values_.resize(l_max + 1);
-  for (auto& value : values_)
-  {
-    value.resize(l_max + 1);
-  }
-}
-
-real_t NormalizedLegendreArray::get(const natural_t l, const integer_t m) const
-{
-  if((static_cast<natural_t>(std::abs(m)) > l )|| l > l_max_)
-  {
-    return 0;
-  }
-
-  return ((m >= 0) || is_even(m)) ? values_[m][l] : -values_[m][l];
-}
-
-real_t NormalizedLegendreArray::unsafe_get(const natural_t l, const natural_t m) const
-{
-  return values_[m][l];
 }
-
-void NormalizedLegendreArray::set(const natural_t l, const integer_t m, const real_t x)
-{
-  if((static_cast<natural_t>(std::abs(m)) > l )|| l > l_max_)
-  {
-    return;
-  }
-  if (m >= 0)
-  {
-    values_[m][l] =  x;
-  }
-  else
-  {
-    values_[m][l] =  is_even(m) ? x : -x;
-  }
-}
-
-void NormalizedLegendreArray::unsafe_set(const natural_t l, const natural_t m, const real_t x)
-{
-  values_[m][l] =  x;
-}
-
-NormalizedLegendreArray::NormalizedLegendreArray(NormalizedLegendreArray &&other) noexcept :
-  l_max_(other.l_max_)
-{
-  values_ = std::move(other.values_);
-}
-
-NormalizedLegendreArray &NormalizedLegendreArray::operator=(NormalizedLegendreArray &&other) noexcept
-{
-  if (this != &other)
-  {
-    l_max_ = other.l_max_;
-    values_ = std::move(other.values_);
-  }
-  return *this;
-}
-
-natural_t NormalizedLegendreArray::l_max() const 
-{
-  return l_max_;
-}
-
-}
-
@@ -0,0 +1,120 @@
+/**
+ * @file mapped_file.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Read only memory mapping of a file
+ */
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped_file.h"
+
+namespace hyperspharm
+{
+
+MappedFile::MappedFile(const std::string &path) :
+  data_(nullptr), size_(0)
+{
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0)
+  {
+    throw std::runtime_error( "MappedFile: cannot open " + path );
+  }
+  struct stat file_stat;
+  if (fstat(file, &file_stat) != 0)
+  {
+    close(file);
+    throw std::runtime_error( "MappedFile: cannot stat " + path );
+  }
+
+  size_ = static_cast<natural_t>(file_stat.st_size);
+  if (size_ > 0)
+  {
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, file, 0);
+    if (data == MAP_FAILED)
+    {
+      close(file);
+      throw std::runtime_error( "MappedFile: cannot map " + path );
+    }
+    data_ = static_cast<char*>(data);
+  }
+  // The mapping stays valid after the file is closed
+  close(file);
+}
+
+MappedFile::~MappedFile()
+{
+  if (data_ != nullptr)
+  {
+    munmap(data_, size_);
+  }
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept :
+  data_(other.data_), size_(other.size_)
+{
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+  if (this != &other)
+  {
+    if (data_ != nullptr)
+    {
+      munmap(data_, size_);
+    }
+    data_ = other.data_;
+    size_ = other.size_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+const char *MappedFile::data() const
+{
+  return data_;
+}
+
+natural_t MappedFile::size() const
+{
+  return size_;
+}
+
+void MappedFile::will_need(const natural_t offset, const natural_t length) const
+{
+  advise(offset, length, MADV_WILLNEED);
+}
+
+void MappedFile::dont_need(const natural_t offset, const natural_t length) const
+{
+  advise(offset, length, MADV_DONTNEED);
+}
+
+void MappedFile::advise(const natural_t offset, const natural_t length, const int advice) const
+{
+  if ((data_ == nullptr) || (offset >= size_) || (length == 0)) { return; }
+
+  // madvise needs a page aligned address: the range is extended to the start of its first page
+  const natural_t page_size = static_cast<natural_t>(sysconf(_SC_PAGESIZE));
+  const natural_t first = offset - (offset % page_size);
+  natural_t last = std::min(offset + length, size_);
+  if ((advice == MADV_DONTNEED) && (last < size_))
+  {
+    // madvise rounds the length up to whole pages: the partial last page, which also holds the start
+    // of the next range (e.g. prefetched by will_need), is kept. It is released with that range.
+    last -= last % page_size;
+  }
+  if (last <= first) { return; }
+  // The advice is only a hint: a failure does not change the results
+  madvise(data_ + first, last - first, advice);
+}
+
+}
@@ -0,0 +1,236 @@
+/**
+ * @file quadrature.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Quadrature rules over the inclination theta
+ * Based on following paper for the Clenshaw-Curtis weights: https://doi.org/10.1007/s10543-006-0045-4
+ */
+
+#include "quadrature.h"
+
+namespace hyperspharm
+{
+
+const natural_t Quadrature::NEWTON_MAX_ITERATIONS = 100;
+
+QuadratureRule Quadrature::get(const GridType type, const natural_t n)
+{
+  switch (type)
+  {
+    case GridType::ClenshawCurtis:
+      return clenshaw_curtis(n);
+    case GridType::GaussLegendre:
+      return gauss_legendre(n);
+    case GridType::Equiangular:
+    default:
+      return equiangular(n);
+  }
+}
+
+std::vector<real_t> Quadrature::get_thetas(const GridType type, const natural_t n)
+{
+  std::vector<real_t> thetas;
+  thetas.reserve(n);
+  switch (type)
+  {
+    case GridType::ClenshawCurtis:
+    {
+      const real_t delta_theta = (n > 1) ? M_PI / static_cast<real_t>(n - 1) : 0.0;
+      for (natural_t k = 0; k < n; ++k)
+      {
+        thetas.push_back(delta_theta * static_cast<real_t>(k));
+      }
+      return thetas;
+    }
+    case GridType::GaussLegendre:
+      return gauss_legendre(n).thetas;
+    case GridType::Equiangular:
+    default:
+    {
+      const real_t delta_theta = M_PI / static_cast<real_t>(n);
+      for (natural_t k = 0; k < n; ++k)
+      {
+        thetas.push_back(delta_theta * static_cast<real_t>(k));
+      }
+      return thetas;
+    }
+  }
+}
+
+QuadratureRule Quadrature::equiangular(const natural_t n)
+{
+  QuadratureRule rule;
+  rule.thetas = get_thetas(GridType::Equiangular, n);
+  rule.weights = compute_cheb_weights(n);
+
+  const real_t quadrature_normalization = M_PI / static_cast<real_t>(n);
+  for (natural_t k = 0; k < n; ++k)
+  {
+    rule.weights[k] *= std::sin(rule.thetas[k]) * quadrature_normalization;
+  }
+  return rule;
+}
+
+QuadratureRule Quadrature::clenshaw_curtis(const natural_t n)
+{
+  if (n < 2)
+  {
+    throw std::invalid_argument( "Clenshaw-Curtis quadrature: at least 2 nodes are needed" );
+  }
+
+  QuadratureRule rule;
+  rule.thetas = get_thetas(GridType::ClenshawCurtis, n);
+
+  const natural_t N = n - 1;
+  const auto sums = compute_clenshaw_curtis_sums(N);
+  rule.weights.reserve(n);
+  for (natural_t k = 0; k <= N; ++k)
+  {
+    const real_t c_k = ((k == 0) || (k == N)) ? 1.0 : 2.0;
+    rule.weights.push_back(c_k * (1.0 - sums[k]) / static_cast<real_t>(N));
+  }
+  return rule;
+}
+
+QuadratureRule Quadrature::gauss_legendre(const natural_t n)
+{
+  if (n < 1)
+  {
+    throw std::invalid_argument( "Gauss-Legendre quadrature: at least 1 node is needed" );
+  }
+
+  QuadratureRule rule;
+  rule.thetas.resize(n);
+  rule.weights.resize(n);
+
+  // The nodes are symmetric: only the ones with x = cos(theta) >= 0 are computed
+  for (natural_t i = 0; i < (n + 1) / 2; ++i)
+  {
+    real_t x = std::cos(M_PI * (static_cast<real_t>(i) + 0.75) / (static_cast<real_t>(n) + 0.5));
+    real_t derivative = 0;
+    for (natural_t iteration = 0; iteration < NEWTON_MAX_ITERATIONS; ++iteration)
+    {
+      // P_n(x) and P_{n-1}(x) with the three terms recurrence
+      real_t p_l_1 = 1.0;
+      real_t p_l = x;
+      for (natural_t l = 1; l < n; ++l)
+      {
+        const real_t tmp = p_l;
+        p_l = ((static_cast<real_t>(2 * l + 1) * x * p_l) - (static_cast<real_t>(l) * p_l_1)) /
+              static_cast<real_t>(l + 1);
+        p_l_1 = tmp;
+      }
+      derivative = static_cast<real_t>(n) * ((x * p_l) - p_l_1) / ((x * x) - 1.0);
+      const real_t delta = p_l / derivative;
+      x -= delta;
+      if (std::abs(delta) <= 1e-15) { break; }
+    }
+
+    const real_t weight = 2.0 / ((1.0 - (x * x)) * derivative * derivative);
+    rule.thetas[i] = std::acos(x);
+    rule.weights[i] = weight;
+    rule.thetas[n - 1 - i] = M_PI - rule.thetas[i];
+    rule.weights[n - 1 - i] = weight;
+  }
+  return rule;
+}
+
+QuadratureRule Quadrature::gauss_chebyshev(const natural_t n)
+{
+  if (n < 1)
+  {
+    throw std::invalid_argument( "Gauss-Chebyshev quadrature: at least 1 node is needed" );
+  }
+
+  QuadratureRule rule;
+  rule.thetas.reserve(n);
+  rule.weights.reserve(n);
+  const real_t delta_beta = M_PI / static_cast<real_t>(n + 1);
+  for (natural_t k = 0; k < n; ++k)
+  {
+    const real_t beta = delta_beta * static_cast<real_t>(k + 1);
+    const real_t sin_beta = std::sin(beta);
+    rule.thetas.push_back(beta);
+    rule.weights.push_back(delta_beta * sin_beta * sin_beta);
+  }
+  return rule;
+}
+
+std::vector<real_t> Quadrature::compute_cheb_weights(const natural_t n)
+{
+  std::vector<real_t> result;
+  result.reserve(n);
+  if (is_power_of_two(n))
+  {
+    // sum_l sin((2l + 1) theta_k) / (2l + 1) = Im(e^{i theta_k} sum_l e^{2 i pi l k / n} / (2l + 1))
+    std::vector<complex_t> coeffs(n);
+    for (natural_t l = 0; l < n / 2; ++l)
+    {
+      coeffs[l] = 1.0 / (2.0 * static_cast<real_t>(l) + 1.0);
+    }
+    ifft(coeffs.data(), n);
+    for (natural_t k = 0; k < n; ++k)
+    {
+      const real_t theta = M_PI * static_cast<real_t>(k) / static_cast<real_t>(n);
+      const real_t sum = (std::polar(static_cast<real_t>(n), theta) * coeffs[k]).imag();
+      result.push_back(sum * 4.0 / M_PI);
+    }
+    return result;
+  }
+
+  const real_t delta_theta = M_PI / static_cast<real_t>(n);
+  real_t theta = 0;
+  for (natural_t k = 0; k < n; ++k)
+  {
+    real_t sum = 0;
+    for (natural_t l = 0; l < n / 2; ++l)
+    {
+      sum += std::sin((2.0 * l + 1.0) * theta) / (2.0 * l + 1.0);
+    }
+    result.push_back(sum * 4.0 / M_PI);
+    theta += delta_theta;
+  }
+  return result;
+}
+
+std::vector<real_t> Quadrature::compute_clenshaw_curtis_sums(const natural_t N)
+{
+  std::vector<real_t> result(N + 1);
+  std::vector<real_t> d(N / 2 + 1);
+  for (natural_t j = 1; j <= N / 2; ++j)
+  {
+    const real_t b_j = ((2 * j) == N) ? 1.0 : 2.0;
+    d[j] = b_j / (4.0 * static_cast<real_t>(j * j) - 1.0);
+  }
+
+  if (is_power_of_two(N))
+  {
+    std::vector<complex_t> coeffs(N);
+    for (natural_t j = 1; j <= N / 2; ++j)
+    {
+      coeffs[j] = d[j];
+    }
+    fft(coeffs.data(), N);
+    for (natural_t k = 0; k < N; ++k)
+    {
+      result[k] = coeffs[k].real();
+    }
+    result[N] = result[0];
+    return result;
+  }
+
+  for (natural_t k = 0; k <= N; ++k)
+  {
+    real_t sum = 0;
+    for (natural_t j = 1; j <= N / 2; ++j)
+    {
+      sum += d[j] * std::cos(2.0 * M_PI * static_cast<real_t>(j * k) / static_cast<real_t>(N));
+    }
+    result[k] = sum;
+  }
+  return result;
+}
+
+}
@@ -0,0 +1,227 @@
+/**
+ * @file rotation.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Rotations of spherical harmonics in the spectral domain
+ */
+
+#include <map>
+#include <mutex>
+#include "utils.h"
+#include "rotation.h"
+
+namespace hyperspharm
+{
+
+const natural_t WignerD::CACHE_SIZE = 16;
+
+WignerD::WignerD(const natural_t l_max, const real_t beta) :
+  l_max_(l_max), beta_(beta), offsets_(l_max + 1)
+{
+  natural_t size = 0;
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    offsets_[l] = size;
+    size += ((2 * l) + 1) * ((2 * l) + 1);
+  }
+  values_.resize(size);
+
+  const real_t cos_beta = std::cos(beta);
+  const real_t half_cos = std::cos(beta / 2.0);
+  const real_t half_sin = std::sin(beta / 2.0);
+  const bool zero_cos = (std::abs(half_cos) < std::numeric_limits<real_t>::min());
+  const bool zero_sin = (std::abs(half_sin) < std::numeric_limits<real_t>::min());
+  const real_t log_cos = zero_cos ? 0.0 : std::log(std::abs(half_cos));
+  const real_t log_sin = zero_sin ? 0.0 : std::log(std::abs(half_sin));
+  const integer_t last = static_cast<integer_t>(l_max);
+
+#pragma omp parallel for collapse(2) schedule(dynamic)
+  for (integer_t m = -last; m <= last; ++m)
+  {
+    for (integer_t m_prime = -last; m_prime <= last; ++m_prime)
+    {
+      // d^l = ((l (2 l - 1)) / sqrt((l^2 - m^2) (l^2 - m'^2))) *
+      //       ((cos(beta) - m m' / (l (l - 1))) d^{l-1} - (sqrt(((l-1)^2 - m^2) ((l-1)^2 - m'^2)) / ((l - 1) (2 l - 1))) d^{l-2})
+      const integer_t first_l = std::max(std::abs(m), std::abs(m_prime));
+      real_t previous = 0.0;
+      real_t current = get_seed(m, m_prime, log_cos, log_sin, zero_cos, zero_sin);
+      const auto store = [&](const integer_t l, const real_t value) {
+        values_[offsets_[l] + ((m + l) * ((2 * l) + 1)) + m_prime + l] = value;
+      };
+      store(first_l, current);
+      for (integer_t l = first_l + 1; l <= last; ++l)
+      {
+        const real_t lr = static_cast<real_t>(l);
+        const real_t mm = static_cast<real_t>(m * m);
+        const real_t pp = static_cast<real_t>(m_prime * m_prime);
+        const real_t factor = (lr * ((2 * lr) - 1)) / std::sqrt(((lr * lr) - mm) * ((lr * lr) - pp));
+        const real_t cross = (l > 1) ? (static_cast<real_t>(m * m_prime) / (lr * (lr - 1))) : 0.0;
+        const real_t lower = (l > 1) ? (std::sqrt((((lr - 1) * (lr - 1)) - mm) * (((lr - 1) * (lr - 1)) - pp)) /
+                                        ((lr - 1) * ((2 * lr) - 1)))
+                                     : 0.0;
+        const real_t next = factor * (((cos_beta - cross) * current) - (lower * previous));
+        previous = current;
+        current = next;
+        store(l, current);
+      }
+    }
+  }
+}
+
+std::shared_ptr<const WignerD> WignerD::get(const natural_t l_max, const real_t beta)
+{
+  static std::mutex mutex;
+  static std::map<std::pair<natural_t, real_t>, std::shared_ptr<const WignerD>> cache;
+
+  const auto key = std::make_pair(l_max, beta);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = cache.find(key);
+    if (it != cache.end()) { return it->second; }
+  }
+  // Computed outside of the lock: concurrent misses of the same key compute it twice, only one is kept
+  auto table = std::make_shared<const WignerD>(l_max, beta);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (cache.size() >= CACHE_SIZE) { cache.clear(); }
+  return cache.emplace(key, table).first->second;
+}
+
+natural_t WignerD::l_max() const
+{
+  return l_max_;
+}
+
+real_t WignerD::beta() const
+{
+  return beta_;
+}
+
+real_t WignerD::get_seed(const integer_t m, const integer_t m_prime, const real_t log_cos, const real_t log_sin,
+                         const bool zero_cos, const bool zero_sin)
+{
+  // With l = max(|m|, |m'|) and C(k) = sqrt((2 l)! / ((l + k)! (l - k)!)):
+  //   d^l_{l m'}  = (-1)^(l - m') C(m') cos^(l + m')(beta / 2) sin^(l - m')(beta / 2)
+  //   d^l_{-l m'} = C(m') cos^(l - m') sin^(l + m')
+  //   d^l_{m l}   = C(m) cos^(l + m) sin^(l - m)
+  //   d^l_{m -l}  = (-1)^(l + m) C(m) cos^(l - m) sin^(l + m)
+  const integer_t l = std::max(std::abs(m), std::abs(m_prime));
+  integer_t k, cos_power, sin_power;
+  real_t sign = 1.0;
+  if (m == l)
+  {
+    k = m_prime; cos_power = l + m_prime; sin_power = l - m_prime;
+    sign = minus_one_power(l - m_prime);
+  }
+  else if (m == -l)
+  {
+    k = m_prime; cos_power = l - m_prime; sin_power = l + m_prime;
+  }
+  else if (m_prime == l)
+  {
+    k = m; cos_power = l + m; sin_power = l - m;
+  }
+  else
+  {
+    k = m; cos_power = l - m; sin_power = l + m;
+    sign = minus_one_power(l + m);
+  }
+  if ((zero_cos && (cos_power > 0)) || (zero_sin && (sin_power > 0))) { return 0.0; }
+
+  const real_t log_value = (0.5 * (std::lgamma((2.0 * l) + 1.0) - std::lgamma(l + k + 1.0) - std::lgamma(l - k + 1.0))) +
+                           ((cos_power > 0) ? (cos_power * log_cos) : 0.0) +
+                           ((sin_power > 0) ? (sin_power * log_sin) : 0.0);
+  return sign * std::exp(log_value);
+}
+
+template<class T>
+BasicSphericalHarmonics<T> SpharmRotation::rotate(const BasicSphericalHarmonics<T> &harmonics, const real_t alpha,
+                                                  const real_t beta, const real_t gamma, const RotationMethod method)
+{
+  const natural_t l_max = harmonics.l_max();
+  BasicSphericalHarmonics<T> result(l_max);
+  const auto tables = WignerD::get(l_max, (method == RotationMethod::Direct) ? beta : (M_PI / 2.0));
+
+#pragma omp parallel
+  {
+    // Per thread scratch: the orders of a degree and the coefficients between the quarter turns
+    std::vector<complex_t> orders((2 * l_max) + 1), turned((2 * l_max) + 1);
+#pragma omp for schedule(dynamic)
+    for (natural_t l = 0; l <= l_max; ++l)
+    {
+      const integer_t li = static_cast<integer_t>(l);
+      const natural_t size = (2 * l) + 1;
+      const real_t* d = tables->matrix(l);
+      get_orders(harmonics, l, gamma, orders.data());
+
+      const complex_t* rotated = orders.data();
+      if (method == RotationMethod::QuarterTurns)
+      {
+        // d^l_{m m'}(beta) = i^(m - m') sum_k Delta_{k m} Delta_{k m'} e^{-i k beta}:
+        // turned_k = e^{-i k beta} sum_m' Delta_{k m'} i^-m' g_m'
+        for (integer_t k = -li; k <= li; ++k)
+        {
+          const real_t* delta_k = d + ((k + li) * size);
+          complex_t sum = {0, 0};
+          for (integer_t m_prime = -li; m_prime <= li; ++m_prime)
+          {
+            sum += delta_k[m_prime + li] * orders[m_prime + li] * get_i_power(-m_prime);
+          }
+          turned[k + li] = sum * std::exp(complex_t(0, -static_cast<real_t>(k) * beta));
+        }
+        rotated = turned.data();
+      }
+
+      for (integer_t m = 0; m <= li; ++m)
+      {
+        complex_t sum = {0, 0};
+        if (method == RotationMethod::Direct)
+        {
+          const real_t* d_m = d + ((m + li) * size);
+          for (integer_t m_prime = -li; m_prime <= li; ++m_prime)
+          {
+            sum += d_m[m_prime + li] * rotated[m_prime + li];
+          }
+        }
+        else
+        {
+          for (integer_t k = -li; k <= li; ++k)
+          {
+            sum += d[((k + li) * size) + m + li] * rotated[k + li];
+          }
+          sum *= get_i_power(m);
+        }
+        sum *= std::exp(complex_t(0, -static_cast<real_t>(m) * alpha));
+        result.set(l, static_cast<natural_t>(m), std::complex<T>(sum));
+      }
+    }
+  }
+  return result;
+}
+
+template<class T>
+void SpharmRotation::get_orders(const BasicSphericalHarmonics<T> &harmonics, const natural_t l, const real_t gamma,
+                                complex_t *orders)
+{
+  const integer_t li = static_cast<integer_t>(l);
+  for (integer_t m = 0; m <= li; ++m)
+  {
+    const complex_t flm(harmonics.get(l, static_cast<natural_t>(m)));
+    orders[li + m] = flm * std::exp(complex_t(0, -static_cast<real_t>(m) * gamma));
+    if (m > 0)
+    {
+      // Real function: f_l-m = (-1)^m conj(f_lm)
+      orders[li - m] = minus_one_power(m) * std::conj(flm) * std::exp(complex_t(0, static_cast<real_t>(m) * gamma));
+    }
+  }
+}
+
+template BasicSphericalHarmonics<float> SpharmRotation::rotate(const BasicSphericalHarmonics<float>& harmonics,
+                                                               real_t alpha, real_t beta, real_t gamma,
+                                                               RotationMethod method);
+template BasicSphericalHarmonics<double> SpharmRotation::rotate(const BasicSphericalHarmonics<double>& harmonics,
+                                                                real_t alpha, real_t beta, real_t gamma,
+                                                                RotationMethod method);
+
+}
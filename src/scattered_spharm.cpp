@@ -0,0 +1,429 @@
+/**
+ * @file scattered_spharm.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Spherical harmonics expansions at scattered points
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include "scattered_spharm.h"
+
+namespace hyperspharm
+{
+
+const natural_t ScatteredSpharm::LATITUDE_BLOCK = 16;
+const natural_t ScatteredSpharm::FIT_MAX_ITERATIONS = 200;
+const real_t ScatteredSpharm::FIT_TOLERANCE = 1e-10;
+
+ScatteredSpharmPlan::ScatteredSpharmPlan(const real_t *thetas, const real_t *psis, const natural_t count,
+                                         const natural_t l_max) :
+  count_(count), l_max_(l_max), order_(count), psis_(count),
+  a_((l_max + 1) * (l_max + 3), 0.0), b_((l_max + 1) * (l_max + 3), 0.0)
+{
+  std::iota(order_.begin(), order_.end(), 0);
+  std::stable_sort(order_.begin(), order_.end(), [thetas](const natural_t left, const natural_t right) {
+    return thetas[left] < thetas[right];
+  });
+  for (natural_t sorted_i = 0; sorted_i < count; ++sorted_i)
+  {
+    const natural_t point_i = order_[sorted_i];
+    psis_[sorted_i] = psis[point_i];
+    if ((sorted_i == 0) || (thetas[point_i] != thetas[order_[sorted_i - 1]]))
+    {
+      latitude_offsets_.push_back(sorted_i);
+      cos_thetas_.push_back(std::cos(thetas[point_i]));
+      sin_thetas_.push_back(std::sin(thetas[point_i]));
+    }
+  }
+  latitude_offsets_.push_back(count);
+
+  // a_lm = sqrt((4 l^2 - 1) / (l^2 - m^2)), b_lm = sqrt(((2 l + 1) ((l - 1)^2 - m^2)) / ((2 l - 3) (l^2 - m^2)))
+  for (natural_t m = 0; m <= l_max; ++m)
+  {
+    const real_t mr = static_cast<real_t>(m);
+    for (natural_t l = m + 1; l <= (l_max + 2); ++l)
+    {
+      const real_t lr = static_cast<real_t>(l);
+      a_[(m * (l_max + 3)) + l] = std::sqrt(((4 * lr * lr) - 1) / ((lr * lr) - (mr * mr)));
+      if (l >= (m + 2))
+      {
+        b_[(m * (l_max + 3)) + l] = std::sqrt((((2 * lr) + 1) * (((lr - 1) * (lr - 1)) - (mr * mr))) /
+                                              (((2 * lr) - 3) * ((lr * lr) - (mr * mr))));
+      }
+    }
+  }
+}
+
+natural_t ScatteredSpharmPlan::count() const
+{
+  return count_;
+}
+
+natural_t ScatteredSpharmPlan::l_max() const
+{
+  return l_max_;
+}
+
+natural_t ScatteredSpharmPlan::latitude_nb() const
+{
+  return cos_thetas_.size();
+}
+
+void ScatteredSpharm::evaluate(const ScatteredSpharmPlan &plan, const SphericalHarmonics &harmonics, real_t *out)
+{
+  const natural_t l_max = plan.l_max();
+  const natural_t latitude_nb = plan.latitude_nb();
+  const natural_t block_nb = (latitude_nb + LATITUDE_BLOCK - 1) / LATITUDE_BLOCK;
+
+#pragma omp parallel
+  {
+    // Per thread scratch: Legendre sums of the block, e^{i m psi} and the values of the points of a latitude
+    std::vector<complex_t> sums((l_max + 1) * LATITUDE_BLOCK);
+    std::vector<real_t> cos_m, sin_m, cos_1, sin_1, values;
+#pragma omp for schedule(dynamic)
+    for (natural_t block_i = 0; block_i < block_nb; ++block_i)
+    {
+      const natural_t first = block_i * LATITUDE_BLOCK;
+      const natural_t nb = std::min(LATITUDE_BLOCK, latitude_nb - first);
+      compute_legendre_sums(plan, harmonics, first, nb, sums.data());
+
+      for (natural_t latitude_i = 0; latitude_i < nb; ++latitude_i)
+      {
+        const natural_t begin = plan.latitude_begin(first + latitude_i);
+        const natural_t point_nb = plan.latitude_begin(first + latitude_i + 1) - begin;
+        cos_m.resize(point_nb); sin_m.resize(point_nb);
+        cos_1.resize(point_nb); sin_1.resize(point_nb);
+        values.resize(point_nb);
+        for (natural_t point_i = 0; point_i < point_nb; ++point_i)
+        {
+          cos_1[point_i] = std::cos(plan.psi(begin + point_i));
+          sin_1[point_i] = std::sin(plan.psi(begin + point_i));
+          cos_m[point_i] = cos_1[point_i];
+          sin_m[point_i] = sin_1[point_i];
+          values[point_i] = sums[latitude_i].real();
+        }
+        // f = S_0 + 2 Re(sum_{m > 0} S_m e^{i m psi}), e^{i m psi} by successive rotations
+        for (natural_t m = 1; m <= l_max; ++m)
+        {
+          const real_t sum_re = 2.0 * sums[(m * LATITUDE_BLOCK) + latitude_i].real();
+          const real_t sum_im = 2.0 * sums[(m * LATITUDE_BLOCK) + latitude_i].imag();
+          real_t* c_m = cos_m.data();
+          real_t* s_m = sin_m.data();
+          const real_t* c_1 = cos_1.data();
+          const real_t* s_1 = sin_1.data();
+          real_t* v = values.data();
+#pragma omp simd
+          for (natural_t point_i = 0; point_i < point_nb; ++point_i)
+          {
+            v[point_i] += (sum_re * c_m[point_i]) - (sum_im * s_m[point_i]);
+            const real_t next_cos = (c_m[point_i] * c_1[point_i]) - (s_m[point_i] * s_1[point_i]);
+            s_m[point_i] = (s_m[point_i] * c_1[point_i]) + (c_m[point_i] * s_1[point_i]);
+            c_m[point_i] = next_cos;
+          }
+        }
+        for (natural_t point_i = 0; point_i < point_nb; ++point_i)
+        {
+          out[plan.point_index(begin + point_i)] = values[point_i];
+        }
+      }
+    }
+  }
+}
+
+std::vector<real_t> ScatteredSpharm::evaluate(const SphericalHarmonics &harmonics, const std::vector<real_t> &thetas,
+                                              const std::vector<real_t> &psis)
+{
+  if (thetas.size() != psis.size())
+  {
+    throw std::invalid_argument( "ScatteredSpharm evaluate: thetas and psis must have the same size" );
+  }
+  const ScatteredSpharmPlan plan(thetas.data(), psis.data(), thetas.size(), harmonics.l_max());
+  std::vector<real_t> result(thetas.size());
+  evaluate(plan, harmonics, result.data());
+  return result;
+}
+
+SphericalHarmonics ScatteredSpharm::adjoint(const ScatteredSpharmPlan &plan, const real_t *values)
+{
+  const natural_t l_max = plan.l_max();
+  const natural_t latitude_nb = plan.latitude_nb();
+  const natural_t block_nb = (latitude_nb + LATITUDE_BLOCK - 1) / LATITUDE_BLOCK;
+  SphericalHarmonics result(l_max);
+  auto& coefficients = result.values();
+
+#pragma omp parallel
+  {
+    // Per thread scratch: partial coefficients, sums over the points of the block and e^{-i m psi}
+    aligned_vector<complex_t> partial(coefficients.size(), complex_t(0, 0));
+    std::vector<complex_t> sums((l_max + 1) * LATITUDE_BLOCK);
+    std::vector<real_t> cos_m, sin_m, cos_1, sin_1, point_values;
+#pragma omp for schedule(dynamic)
+    for (natural_t block_i = 0; block_i < block_nb; ++block_i)
+    {
+      const natural_t first = block_i * LATITUDE_BLOCK;
+      const natural_t nb = std::min(LATITUDE_BLOCK, latitude_nb - first);
+      std::fill(sums.begin(), sums.end(), complex_t(0, 0));
+
+      // T_m(theta) = sum_{p on the latitude} values_p e^{-i m psi_p}
+      for (natural_t latitude_i = 0; latitude_i < nb; ++latitude_i)
+      {
+        const natural_t begin = plan.latitude_begin(first + latitude_i);
+        const natural_t point_nb = plan.latitude_begin(first + latitude_i + 1) - begin;
+        cos_m.resize(point_nb); sin_m.resize(point_nb);
+        cos_1.resize(point_nb); sin_1.resize(point_nb);
+        point_values.resize(point_nb);
+        for (natural_t point_i = 0; point_i < point_nb; ++point_i)
+        {
+          cos_1[point_i] = std::cos(plan.psi(begin + point_i));
+          sin_1[point_i] = std::sin(plan.psi(begin + point_i));
+          cos_m[point_i] = 1.0;
+          sin_m[point_i] = 0.0;
+          point_values[point_i] = values[plan.point_index(begin + point_i)];
+        }
+        for (natural_t m = 0; m <= l_max; ++m)
+        {
+          real_t* c_m = cos_m.data();
+          real_t* s_m = sin_m.data();
+          const real_t* c_1 = cos_1.data();
+          const real_t* s_1 = sin_1.data();
+          const real_t* v = point_values.data();
+          real_t sum_re = 0, sum_im = 0;
+#pragma omp simd reduction(+:sum_re, sum_im)
+          for (natural_t point_i = 0; point_i < point_nb; ++point_i)
+          {
+            sum_re += v[point_i] * c_m[point_i];
+            sum_im -= v[point_i] * s_m[point_i];
+            const real_t next_cos = (c_m[point_i] * c_1[point_i]) - (s_m[point_i] * s_1[point_i]);
+            s_m[point_i] = (s_m[point_i] * c_1[point_i]) + (c_m[point_i] * s_1[point_i]);
+            c_m[point_i] = next_cos;
+          }
+          sums[(m * LATITUDE_BLOCK) + latitude_i] = complex_t(sum_re, sum_im);
+        }
+      }
+      add_legendre_products(plan, first, nb, sums.data(), partial.data());
+    }
+#pragma omp critical
+    for (natural_t i = 0; i < coefficients.size(); ++i)
+    {
+      coefficients[i] += partial[i];
+    }
+  }
+
+  // Real parameters: Re(f_l0) contributes P_l^0, Re(f_lm) and Im(f_lm) contribute 2 P_l^m cos and -2 P_l^m sin
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    result.set(l, 0, complex_t(result.get(l, 0).real(), 0.0));
+    for (natural_t m = 1; m <= l; ++m)
+    {
+      result.set(l, m, 2.0 * result.get(l, m));
+    }
+  }
+  return result;
+}
+
+SphericalHarmonics ScatteredSpharm::fit(const ScatteredSpharmPlan &plan, const real_t *values,
+                                        const real_t regularization, const natural_t max_iterations,
+                                        const real_t tolerance)
+{
+  if (regularization < 0)
+  {
+    throw std::invalid_argument( "ScatteredSpharm fit: the regularization must be non-negative" );
+  }
+  const natural_t l_max = plan.l_max();
+  // The normal matrix is A^T A + regularization W, W = diag(1 for m = 0, 2 for m > 0) being the L2 norm
+  // of the parameters. For uniform samples A^T A ~ (count / (4 pi)) W: W is used as preconditioner.
+  SphericalHarmonics result(l_max), direction(l_max), preconditioned(l_max);
+  SphericalHarmonics residual = adjoint(plan, values);
+  const natural_t size = result.values().size();
+  std::vector<real_t> weights(size);
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      weights[((l * (l + 1)) / 2) + m] = (m == 0) ? 1.0 : 2.0;
+    }
+  }
+  auto& x = result.values();
+  auto& r = residual.values();
+  auto& p = direction.values();
+  auto& z = preconditioned.values();
+
+  for (natural_t i = 0; i < size; ++i) { p[i] = r[i] / weights[i]; }
+  real_t residual_dot = get_dot(residual, direction);
+  const real_t initial_norm = std::sqrt(get_dot(residual, residual));
+  if (initial_norm == 0) { return result; }
+
+  std::vector<real_t> evaluated(plan.count());
+  for (natural_t iteration = 0; iteration < max_iterations; ++iteration)
+  {
+    // q = (A^T A + regularization W) p
+    evaluate(plan, direction, evaluated.data());
+    SphericalHarmonics product = adjoint(plan, evaluated.data());
+    auto& q = product.values();
+    for (natural_t i = 0; i < size; ++i) { q[i] += regularization * weights[i] * p[i]; }
+    const real_t curvature = get_dot(direction, product);
+    if (curvature <= 0) { break; }
+
+    const real_t step = residual_dot / curvature;
+    for (natural_t i = 0; i < size; ++i)
+    {
+      x[i] += step * p[i];
+      r[i] -= step * q[i];
+    }
+    if (std::sqrt(get_dot(residual, residual)) <= (tolerance * initial_norm)) { break; }
+
+    for (natural_t i = 0; i < size; ++i) { z[i] = r[i] / weights[i]; }
+    const real_t next_dot = get_dot(residual, preconditioned);
+    const real_t beta = next_dot / residual_dot;
+    residual_dot = next_dot;
+    for (natural_t i = 0; i < size; ++i) { p[i] = z[i] + (beta * p[i]); }
+  }
+  return result;
+}
+
+SphericalHarmonics ScatteredSpharm::fit(const std::vector<real_t> &thetas, const std::vector<real_t> &psis,
+                                        const std::vector<real_t> &values, const natural_t l_max,
+                                        const real_t regularization)
+{
+  if ((thetas.size() != psis.size()) || (thetas.size() != values.size()))
+  {
+    throw std::invalid_argument( "ScatteredSpharm fit: thetas, psis and values must have the same size" );
+  }
+  const ScatteredSpharmPlan plan(thetas.data(), psis.data(), thetas.size(), l_max);
+  return fit(plan, values.data(), regularization);
+}
+
+void ScatteredSpharm::compute_legendre_sums(const ScatteredSpharmPlan &plan, const SphericalHarmonics &harmonics,
+                                            const natural_t first, const natural_t nb, complex_t *sums)
+{
+  const natural_t l_max = plan.l_max();
+  real_t x[LATITUDE_BLOCK], sin_theta[LATITUDE_BLOCK], seed[LATITUDE_BLOCK];
+  get_block(plan, first, nb, x, sin_theta, seed);
+
+  real_t y1_re[LATITUDE_BLOCK], y1_im[LATITUDE_BLOCK], y2_re[LATITUDE_BLOCK], y2_im[LATITUDE_BLOCK];
+  for (natural_t m = 0; m <= l_max; ++m)
+  {
+    // P_m^m = -sqrt((2 m + 1) / (2 m)) sin(theta) P_{m-1}^{m-1}
+    if (m > 0)
+    {
+      const real_t factor = -std::sqrt(static_cast<real_t>((2 * m) + 1) / static_cast<real_t>(2 * m));
+#pragma omp simd
+      for (natural_t lane = 0; lane < LATITUDE_BLOCK; ++lane)
+      {
+        seed[lane] *= factor * sin_theta[lane];
+      }
+    }
+
+    // Clenshaw: y_l = f_lm + a_{l+1} x y_{l+1} - b_{l+2} y_{l+2}, from l_max down to m + 1
+    std::fill_n(y1_re, LATITUDE_BLOCK, 0.0); std::fill_n(y1_im, LATITUDE_BLOCK, 0.0);
+    std::fill_n(y2_re, LATITUDE_BLOCK, 0.0); std::fill_n(y2_im, LATITUDE_BLOCK, 0.0);
+    for (natural_t l = l_max; l > m; --l)
+    {
+      const complex_t flm = harmonics.get(l, m);
+      const real_t a = plan.a(l + 1, m);
+      const real_t b = plan.b(l + 2, m);
+#pragma omp simd
+      for (natural_t lane = 0; lane < LATITUDE_BLOCK; ++lane)
+      {
+        const real_t y_re = flm.real() + (a * x[lane] * y1_re[lane]) - (b * y2_re[lane]);
+        const real_t y_im = flm.imag() + (a * x[lane] * y1_im[lane]) - (b * y2_im[lane]);
+        y2_re[lane] = y1_re[lane]; y2_im[lane] = y1_im[lane];
+        y1_re[lane] = y_re; y1_im[lane] = y_im;
+      }
+    }
+
+    // S_m = f_mm P_m^m + y_{m+1} P_{m+1}^m - b_{m+2} y_{m+2} P_m^m, with P_{m+1}^m = a_{m+1} x P_m^m
+    const complex_t fmm = harmonics.get(m, m);
+    const real_t a = plan.a(m + 1, m);
+    const real_t b = plan.b(m + 2, m);
+    complex_t* sums_m = sums + (m * LATITUDE_BLOCK);
+    for (natural_t lane = 0; lane < LATITUDE_BLOCK; ++lane)
+    {
+      const real_t p0 = seed[lane];
+      const real_t p1 = a * x[lane] * p0;
+      sums_m[lane] = complex_t((fmm.real() * p0) + (p1 * y1_re[lane]) - (b * p0 * y2_re[lane]),
+                               (fmm.imag() * p0) + (p1 * y1_im[lane]) - (b * p0 * y2_im[lane]));
+    }
+  }
+}
+
+void ScatteredSpharm::add_legendre_products(const ScatteredSpharmPlan &plan, const natural_t first,
+                                            const natural_t nb, const complex_t *sums, complex_t *coefficients)
+{
+  const natural_t l_max = plan.l_max();
+  real_t x[LATITUDE_BLOCK], sin_theta[LATITUDE_BLOCK], seed[LATITUDE_BLOCK];
+  get_block(plan, first, nb, x, sin_theta, seed);
+
+  // The padding lanes hold zero sums
+  real_t sums_re[LATITUDE_BLOCK], sums_im[LATITUDE_BLOCK], previous[LATITUDE_BLOCK], current[LATITUDE_BLOCK];
+  for (natural_t m = 0; m <= l_max; ++m)
+  {
+    if (m > 0)
+    {
+      const real_t factor = -std::sqrt(static_cast<real_t>((2 * m) + 1) / static_cast<real_t>(2 * m));
+#pragma omp simd
+      for (natural_t lane = 0; lane < LATITUDE_BLOCK; ++lane)
+      {
+        seed[lane] *= factor * sin_theta[lane];
+      }
+    }
+    for (natural_t lane = 0; lane < LATITUDE_BLOCK; ++lane)
+    {
+      sums_re[lane] = sums[(m * LATITUDE_BLOCK) + lane].real();
+      sums_im[lane] = sums[(m * LATITUDE_BLOCK) + lane].imag();
+      previous[lane] = 0.0;
+      current[lane] = seed[lane];
+    }
+
+    // Upward recurrence P_l^m = a_lm x P_{l-1}^m - b_lm P_{l-2}^m from P_m^m
+    for (natural_t l = m; l <= l_max; ++l)
+    {
+      const real_t a = plan.a(l, m);
+      const real_t b = plan.b(l, m);
+      real_t sum_re = 0, sum_im = 0;
+#pragma omp simd reduction(+:sum_re, sum_im)
+      for (natural_t lane = 0; lane < LATITUDE_BLOCK; ++lane)
+      {
+        const real_t value = (l == m) ? current[lane] : ((a * x[lane] * current[lane]) - (b * previous[lane]));
+        previous[lane] = (l == m) ? 0.0 : current[lane];
+        current[lane] = value;
+        sum_re += value * sums_re[lane];
+        sum_im += value * sums_im[lane];
+      }
+      coefficients[((l * (l + 1)) / 2) + m] += complex_t(sum_re, sum_im);
+    }
+  }
+}
+
+void ScatteredSpharm::get_block(const ScatteredSpharmPlan &plan, const natural_t first, const natural_t nb,
+                                real_t *x, real_t *sin_theta, real_t *seed)
+{
+  // The block is padded with its last latitude: the loops always run over LATITUDE_BLOCK lanes
+  for (natural_t lane = 0; lane < LATITUDE_BLOCK; ++lane)
+  {
+    const natural_t latitude_i = first + std::min(lane, nb - 1);
+    x[lane] = plan.latitude_cos(latitude_i);
+    sin_theta[lane] = plan.latitude_sin(latitude_i);
+    seed[lane] = 1.0 / std::sqrt(4.0 * M_PI);
+  }
+}
+
+real_t ScatteredSpharm::get_dot(const SphericalHarmonics &left, const SphericalHarmonics &right)
+{
+  real_t result = 0;
+  for (natural_t l = 0; l <= left.l_max(); ++l)
+  {
+    result += left.get(l, 0).real() * right.get(l, 0).real();
+    for (natural_t m = 1; m <= l; ++m)
+    {
+      result += (left.get(l, m) * std::conj(right.get(l, m))).real();
+    }
+  }
+  return result;
+}
+
+}
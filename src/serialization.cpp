@@ -0,0 +1,351 @@
+/**
+ * @file serialization.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Binary file format of the surfaces and coefficient sets
+ */
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include "serialization.h"
+
+namespace hyperspharm
+{
+
+const natural_t BinaryFile::VERSION = 1;
+const natural_t BinaryFile::HEADER_SIZE = 64;
+const natural_t BinaryFile::PAYLOAD_ALIGNMENT = 64;
+
+static_assert(sizeof(std::complex<float>) == (2 * sizeof(float)), "std::complex<float> must be two packed floats");
+static_assert(sizeof(std::complex<double>) == (2 * sizeof(double)), "std::complex<double> must be two packed doubles");
+
+template<>
+ScalarType BinaryFile::get_real_scalar<float>()
+{
+  return ScalarType::Float32;
+}
+
+template<>
+ScalarType BinaryFile::get_real_scalar<double>()
+{
+  return ScalarType::Float64;
+}
+
+template<>
+ScalarType BinaryFile::get_complex_scalar<float>()
+{
+  return ScalarType::Complex64;
+}
+
+template<>
+ScalarType BinaryFile::get_complex_scalar<double>()
+{
+  return ScalarType::Complex128;
+}
+
+BinaryFile::BinaryFile(const std::string &path) :
+  file_(path), header_(read_header(file_, path))
+{
+}
+
+const BinaryHeader &BinaryFile::header() const
+{
+  return header_;
+}
+
+ContainerType BinaryFile::type() const
+{
+  return header_.type;
+}
+
+ScalarType BinaryFile::scalar() const
+{
+  return header_.scalar;
+}
+
+const MappedFile &BinaryFile::file() const
+{
+  return file_;
+}
+
+natural_t BinaryFile::payload_offset() const
+{
+  return header_.payload_offset;
+}
+
+template<class T>
+BasicSphericalSurfaceView<T> BinaryFile::spherical_surface() const
+{
+  const T* values = reinterpret_cast<const T*>(payload(ContainerType::SphericalSurface, get_real_scalar<T>()));
+  return BasicSphericalSurfaceView<T>(values, header_.dims[0], header_.dims[1], header_.dims[1], header_.grid);
+}
+
+template<class T>
+BasicSphericalHarmonicsView<T> BinaryFile::spherical_harmonics() const
+{
+  const auto values = reinterpret_cast<const std::complex<T>*>(payload(ContainerType::SphericalHarmonics,
+                                                                       get_complex_scalar<T>()));
+  return BasicSphericalHarmonicsView<T>(values, header_.dims[0]);
+}
+
+HyperSphericalSurfaceView BinaryFile::hyperspherical_surface() const
+{
+  const auto values = reinterpret_cast<const real_t*>(payload(ContainerType::HyperSphericalSurface,
+                                                              get_real_scalar<real_t>()));
+  return HyperSphericalSurfaceView(values, header_.dims[0], header_.dims[1], header_.dims[2], header_.grid);
+}
+
+HyperSphericalCoeffsView BinaryFile::hyperspherical_coeffs() const
+{
+  const auto values = reinterpret_cast<const complex_t*>(payload(ContainerType::HyperSphericalCoeffs,
+                                                                 get_complex_scalar<real_t>()));
+  return HyperSphericalCoeffsView(values, header_.dims[0], header_.dims[1], header_.dims[2], header_.layout);
+}
+
+template<class T>
+void BinaryFile::save(const std::string &path, const BasicSphericalSurface<T> &surface)
+{
+  const auto& values = surface.values();
+  write(path, make_header(ContainerType::SphericalSurface, get_real_scalar<T>(), surface.grid(),
+                          CoeffsLayout::Cube, surface.rows(), surface.cols(), 0, values.size() * sizeof(T)),
+        values.data());
+}
+
+template<class T>
+void BinaryFile::save(const std::string &path, const BasicSphericalHarmonics<T> &harmonics)
+{
+  const auto& values = harmonics.values();
+  write(path, make_header(ContainerType::SphericalHarmonics, get_complex_scalar<T>(), GridType::Equiangular,
+                          CoeffsLayout::Cube, harmonics.l_max(), 0, 0, values.size() * sizeof(std::complex<T>)),
+        values.data());
+}
+
+void BinaryFile::save(const std::string &path, const HyperSphericalSurface &surface)
+{
+  const auto& values = surface.values();
+  write(path, make_header(ContainerType::HyperSphericalSurface, get_real_scalar<real_t>(), surface.grid(),
+                          CoeffsLayout::Cube, surface.theta_nb(), surface.psi_nb(), surface.phi_nb(),
+                          values.size() * sizeof(real_t)),
+        values.data());
+}
+
+void BinaryFile::save(const std::string &path, const HyperSphericalCoeffs &coeffs)
+{
+  const auto& values = coeffs.values();
+  write(path, make_header(ContainerType::HyperSphericalCoeffs, get_complex_scalar<real_t>(), GridType::Equiangular,
+                          coeffs.layout(), coeffs.n_max(), coeffs.l_max(), coeffs.m_max(),
+                          values.size() * sizeof(complex_t)),
+        values.data());
+}
+
+const char *BinaryFile::payload(const ContainerType type, const ScalarType scalar) const
+{
+  if ((header_.type != type) || (header_.scalar != scalar))
+  {
+    throw std::runtime_error( "BinaryFile: the file holds another container or scalar type" );
+  }
+  return file_.data() + header_.payload_offset;
+}
+
+BinaryHeader BinaryFile::make_header(const ContainerType type, const ScalarType scalar, const GridType grid,
+                                     const CoeffsLayout layout, const natural_t dim0, const natural_t dim1,
+                                     const natural_t dim2, const natural_t payload_bytes)
+{
+  BinaryHeader header;
+  header.version = VERSION;
+  header.type = type;
+  header.scalar = scalar;
+  header.grid = grid;
+  header.layout = layout;
+  header.dims[0] = dim0;
+  header.dims[1] = dim1;
+  header.dims[2] = dim2;
+  header.payload_offset = HEADER_SIZE;
+  header.payload_bytes = payload_bytes;
+  return header;
+}
+
+void BinaryFile::write(const std::string &path, const BinaryHeader &header, const void *payload)
+{
+  if (!is_little_endian())
+  {
+    throw std::runtime_error( "BinaryFile: the files can only be written on little-endian hosts" );
+  }
+
+  char bytes[HEADER_SIZE];
+  std::memset(bytes, 0, HEADER_SIZE);
+  std::memcpy(bytes, "HSPH", 4);
+  store(bytes + 4, header.version, 2);
+  store(bytes + 6, static_cast<natural_t>(header.type), 1);
+  store(bytes + 7, static_cast<natural_t>(header.scalar), 1);
+  store(bytes + 8, static_cast<natural_t>(header.grid), 1);
+  store(bytes + 9, static_cast<natural_t>(header.layout), 1);
+  for (natural_t dim = 0; dim < 3; ++dim)
+  {
+    store(bytes + 16 + (8 * dim), header.dims[dim], 8);
+  }
+  store(bytes + 40, header.payload_offset, 8);
+  store(bytes + 48, header.payload_bytes, 8);
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file)
+  {
+    throw std::runtime_error( "BinaryFile: cannot open " + path );
+  }
+  file.write(bytes, HEADER_SIZE);
+  file.write(static_cast<const char*>(payload), static_cast<std::streamsize>(header.payload_bytes));
+  if (!file)
+  {
+    throw std::runtime_error( "BinaryFile: cannot write " + path );
+  }
+}
+
+BinaryHeader BinaryFile::read_header(const MappedFile &file, const std::string &path)
+{
+  if (!is_little_endian())
+  {
+    throw std::runtime_error( "BinaryFile: the files can only be mapped on little-endian hosts" );
+  }
+  const char* bytes = file.data();
+  if ((file.size() < HEADER_SIZE) || (std::memcmp(bytes, "HSPH", 4) != 0))
+  {
+    throw std::runtime_error( "BinaryFile: " + path + " is not a binary file" );
+  }
+
+  BinaryHeader header;
+  header.version = load(bytes + 4, 2);
+  if (header.version != VERSION)
+  {
+    throw std::runtime_error( "BinaryFile: unsupported version of " + path );
+  }
+  const natural_t type = load(bytes + 6, 1);
+  const natural_t scalar = load(bytes + 7, 1);
+  const natural_t grid = load(bytes + 8, 1);
+  const natural_t layout = load(bytes + 9, 1);
+  if ((type < static_cast<natural_t>(ContainerType::SphericalSurface)) ||
+      (type > static_cast<natural_t>(ContainerType::HyperSphericalCoeffs)) ||
+      (scalar < static_cast<natural_t>(ScalarType::Float32)) ||
+      (scalar > static_cast<natural_t>(ScalarType::Complex128)) ||
+      (grid > static_cast<natural_t>(GridType::GaussLegendre)) ||
+      (layout > static_cast<natural_t>(CoeffsLayout::Tetrahedral)))
+  {
+    throw std::runtime_error( "BinaryFile: invalid header in " + path );
+  }
+  header.type = static_cast<ContainerType>(type);
+  header.scalar = static_cast<ScalarType>(scalar);
+  header.grid = static_cast<GridType>(grid);
+  header.layout = static_cast<CoeffsLayout>(layout);
+  for (natural_t dim = 0; dim < 3; ++dim)
+  {
+    header.dims[dim] = load(bytes + 16 + (8 * dim), 8);
+  }
+  header.payload_offset = load(bytes + 40, 8);
+  header.payload_bytes = load(bytes + 48, 8);
+
+  natural_t value_nb = 0;
+  natural_t payload_bytes = 0;
+  if (!get_value_nb(header, value_nb) ||
+      __builtin_mul_overflow(value_nb, get_scalar_size(header.scalar), &payload_bytes))
+  {
+    throw std::runtime_error( "BinaryFile: invalid dimensions in " + path );
+  }
+  if ((header.payload_offset < HEADER_SIZE) || ((header.payload_offset % PAYLOAD_ALIGNMENT) != 0) ||
+      (header.payload_bytes != payload_bytes) ||
+      (header.payload_offset > file.size()) || (header.payload_bytes > (file.size() - header.payload_offset)))
+  {
+    throw std::runtime_error( "BinaryFile: invalid payload in " + path );
+  }
+  return header;
+}
+
+bool BinaryFile::get_value_nb(const BinaryHeader &header, natural_t &value_nb)
+{
+  // The dimensions are read from the file: the products are checked before being computed
+  const natural_t* dims = header.dims;
+  const natural_t max = std::numeric_limits<natural_t>::max();
+  natural_t product = 0;
+  switch (header.type)
+  {
+    case ContainerType::SphericalSurface:
+      return !__builtin_mul_overflow(dims[0], dims[1], &value_nb);
+    case ContainerType::SphericalHarmonics:
+      if ((dims[0] > (max - 2)) || __builtin_mul_overflow(dims[0] + 2, dims[0] + 1, &product)) { return false; }
+      value_nb = product / 2;
+      return true;
+    case ContainerType::HyperSphericalSurface:
+      return !__builtin_mul_overflow(dims[0], dims[1], &product) &&
+             !__builtin_mul_overflow(product, dims[2], &value_nb);
+    case ContainerType::HyperSphericalCoeffs:
+      if (header.layout == CoeffsLayout::Tetrahedral)
+      {
+        if ((dims[0] > (max - 2)) || __builtin_mul_overflow(dims[0], dims[0] + 1, &product) ||
+            __builtin_mul_overflow(product, dims[0] + 2, &product))
+        {
+          return false;
+        }
+      }
+      else if (__builtin_mul_overflow(dims[0], dims[1], &product) || __builtin_mul_overflow(product, dims[2], &product))
+      {
+        return false;
+      }
+      value_nb = HyperSphericalCoeffs::get_size(header.layout, dims[0], dims[1], dims[2]);
+      return true;
+  }
+  return false;
+}
+
+natural_t BinaryFile::get_scalar_size(const ScalarType scalar)
+{
+  switch (scalar)
+  {
+    case ScalarType::Float32:
+      return sizeof(float);
+    case ScalarType::Float64:
+      return sizeof(double);
+    case ScalarType::Complex64:
+      return sizeof(std::complex<float>);
+    case ScalarType::Complex128:
+      return sizeof(std::complex<double>);
+  }
+  return 0;
+}
+
+bool BinaryFile::is_little_endian()
+{
+  const uint16_t value = 1;
+  unsigned char first_byte;
+  std::memcpy(&first_byte, &value, 1);
+  return first_byte == 1;
+}
+
+void BinaryFile::store(char *destination, const natural_t value, const natural_t bytes)
+{
+  for (natural_t byte = 0; byte < bytes; ++byte)
+  {
+    destination[byte] = static_cast<char>((value >> (8 * byte)) & 0xFF);
+  }
+}
+
+natural_t BinaryFile::load(const char *source, const natural_t bytes)
+{
+  natural_t value = 0;
+  for (natural_t byte = 0; byte < bytes; ++byte)
+  {
+    value |= static_cast<natural_t>(static_cast<unsigned char>(source[byte])) << (8 * byte);
+  }
+  return value;
+}
+
+template BasicSphericalSurfaceView<float> BinaryFile::spherical_surface<float>() const;
+template BasicSphericalSurfaceView<double> BinaryFile::spherical_surface<double>() const;
+template BasicSphericalHarmonicsView<float> BinaryFile::spherical_harmonics<float>() const;
+template BasicSphericalHarmonicsView<double> BinaryFile::spherical_harmonics<double>() const;
+template void BinaryFile::save(const std::string& path, const BasicSphericalSurface<float>& surface);
+template void BinaryFile::save(const std::string& path, const BasicSphericalSurface<double>& surface);
+template void BinaryFile::save(const std::string& path, const BasicSphericalHarmonics<float>& harmonics);
+template void BinaryFile::save(const std::string& path, const BasicSphericalHarmonics<double>& harmonics);
+
+}
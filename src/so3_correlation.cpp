@@ -0,0 +1,195 @@
+/**
+ * @file so3_correlation.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Rotational alignment of spherical functions
+ */
+
+#include <algorithm>
+#include <omp.h>
+#include "fft.h"
+#include "utils.h"
+#include "so3_correlation.h"
+
+namespace hyperspharm
+{
+
+const real_t SO3Correlation::REFINE_TOLERANCE = 1e-7;
+
+natural_t SO3Correlation::get_grid_size(const natural_t l_max)
+{
+  natural_t size = 1;
+  while (size < ((2 * l_max) + 1)) { size *= 2; }
+  return size;
+}
+
+real_t SO3Correlation::correlation(const SphericalHarmonics &f, const SphericalHarmonics &g, const real_t alpha,
+                                   const real_t beta, const real_t gamma)
+{
+  return inner_product(f, SpharmRotation::rotate(g, alpha, beta, gamma, RotationMethod::QuarterTurns));
+}
+
+aligned_vector<real_t> SO3Correlation::correlation_grid(const SphericalHarmonics &f, const SphericalHarmonics &g,
+                                                        natural_t l_max)
+{
+  l_max = std::min(l_max, std::min(f.l_max(), g.l_max()));
+  const natural_t size = get_grid_size(l_max);
+  const integer_t last = static_cast<integer_t>(l_max);
+  const integer_t signed_size = static_cast<integer_t>(size);
+  const auto index = [signed_size](const integer_t frequency) {
+    return static_cast<natural_t>((frequency + signed_size) % signed_size);
+  };
+  const auto delta = WignerD::get(l_max, M_PI / 2.0);
+  const complex_t i_powers[4] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+  const auto i_power = [&i_powers](const integer_t power) { return i_powers[((power % 4) + 4) % 4]; };
+
+  // T[m][k][m'], every k owning its slab
+  aligned_vector<complex_t> values(size * size * size, complex_t(0, 0));
+#pragma omp parallel
+  {
+    // Per thread scratch: Delta_{k m} i^-m f_lm and Delta_{k m'} i^m' conj(g_lm')
+    std::vector<complex_t> f_k((2 * l_max) + 1), g_k((2 * l_max) + 1);
+#pragma omp for schedule(dynamic)
+    for (integer_t k = -last; k <= last; ++k)
+    {
+      for (natural_t l = static_cast<natural_t>(std::abs(k)); l <= l_max; ++l)
+      {
+        const integer_t li = static_cast<integer_t>(l);
+        for (integer_t m = -li; m <= li; ++m)
+        {
+          // Real functions: f_l-m = (-1)^m conj(f_lm)
+          const natural_t order = static_cast<natural_t>(std::abs(m));
+          const complex_t flm = (m >= 0) ? f.get(l, order) : (minus_one_power(order) * std::conj(f.get(l, order)));
+          const complex_t glm = (m >= 0) ? g.get(l, order) : (minus_one_power(order) * std::conj(g.get(l, order)));
+          const real_t delta_km = delta->get(l, k, m);
+          f_k[m + li] = delta_km * i_power(-m) * flm;
+          g_k[m + li] = delta_km * i_power(m) * std::conj(glm);
+        }
+        for (integer_t m = -li; m <= li; ++m)
+        {
+          complex_t* row = values.data() + (((index(m) * size) + index(k)) * size);
+          const complex_t f_value = f_k[m + li];
+          for (integer_t m_prime = -li; m_prime <= li; ++m_prime)
+          {
+            row[index(m_prime)] += f_value * g_k[m_prime + li];
+          }
+        }
+      }
+    }
+  }
+
+  // Inverse fft along gamma (contiguous), beta then alpha
+  const natural_t line_nb = size * size;
+  for (const natural_t stride : {natural_t(1), size, size * size})
+  {
+#pragma omp parallel
+    {
+      std::vector<complex_t> line(size), scratch(std::max<natural_t>(size / 2, 1));
+#pragma omp for schedule(static)
+      for (natural_t line_i = 0; line_i < line_nb; ++line_i)
+      {
+        // First value of the line: the lines along the stride start at the other two indices
+        const natural_t first = (stride == 1) ? (line_i * size)
+                                              : (((line_i / stride) * stride * size) + (line_i % stride));
+        for (natural_t i = 0; i < size; ++i) { line[i] = values[first + (i * stride)]; }
+        ifft(line.data(), size, scratch.data());
+        for (natural_t i = 0; i < size; ++i) { values[first + (i * stride)] = line[i]; }
+      }
+    }
+  }
+
+  // ifft includes a 1 / size normalization per dimension
+  const real_t scale = static_cast<real_t>(size * size * size);
+  aligned_vector<real_t> result(size * size * size);
+#pragma omp parallel for schedule(static)
+  for (natural_t i = 0; i < result.size(); ++i)
+  {
+    result[i] = values[i].real() * scale;
+  }
+  return result;
+}
+
+RotationMatch SO3Correlation::best_rotation(const SphericalHarmonics &f, const SphericalHarmonics &g, const bool refine)
+{
+  return best_rotation(f, g, std::min(f.l_max(), g.l_max()), refine);
+}
+
+RotationMatch SO3Correlation::best_rotation(const SphericalHarmonics &f, const SphericalHarmonics &g,
+                                            const natural_t l_max, const bool refine)
+{
+  const auto grid = correlation_grid(f, g, l_max);
+  const natural_t size = get_grid_size(std::min(l_max, std::min(f.l_max(), g.l_max())));
+  const natural_t best = static_cast<natural_t>(std::max_element(grid.begin(), grid.end()) - grid.begin());
+  const real_t step = (2.0 * M_PI) / static_cast<real_t>(size);
+  RotationMatch match = {step * static_cast<real_t>(best / (size * size)),
+                         step * static_cast<real_t>((best / size) % size),
+                         step * static_cast<real_t>(best % size),
+                         grid[best]};
+  match = normalize(match);
+  if (!refine) { return match; }
+
+  // Pattern search from the grid maximum on the exact correlation, halving the step when no move improves it
+  match.correlation = correlation(f, g, match.alpha, match.beta, match.gamma);
+  for (real_t search_step = step / 2.0; search_step > REFINE_TOLERANCE;)
+  {
+    RotationMatch candidate_best = match;
+    for (natural_t angle = 0; angle < 3; ++angle)
+    {
+      for (const real_t direction : {-1.0, 1.0})
+      {
+        RotationMatch candidate = match;
+        real_t* angles[3] = {&candidate.alpha, &candidate.beta, &candidate.gamma};
+        *angles[angle] += direction * search_step;
+        candidate.correlation = correlation(f, g, candidate.alpha, candidate.beta, candidate.gamma);
+        if (candidate.correlation > candidate_best.correlation) { candidate_best = candidate; }
+      }
+    }
+    if (candidate_best.correlation > match.correlation)
+    {
+      match = candidate_best;
+    }
+    else
+    {
+      search_step /= 2.0;
+    }
+  }
+  return normalize(match);
+}
+
+real_t SO3Correlation::inner_product(const SphericalHarmonics &f, const SphericalHarmonics &g)
+{
+  const natural_t l_max = std::min(f.l_max(), g.l_max());
+  real_t result = 0;
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    result += (f.get(l, 0) * std::conj(g.get(l, 0))).real();
+    for (natural_t m = 1; m <= l; ++m)
+    {
+      result += 2.0 * (f.get(l, m) * std::conj(g.get(l, m))).real();
+    }
+  }
+  return result;
+}
+
+RotationMatch SO3Correlation::normalize(RotationMatch match)
+{
+  const auto wrap = [](const real_t angle) {
+    const real_t wrapped = std::fmod(angle, 2.0 * M_PI);
+    return (wrapped < 0) ? (wrapped + (2.0 * M_PI)) : wrapped;
+  };
+  match.beta = wrap(match.beta);
+  if (match.beta > M_PI)
+  {
+    // R_z(alpha) R_y(-beta) R_z(gamma) = R_z(alpha + pi) R_y(beta) R_z(gamma + pi)
+    match.beta = (2.0 * M_PI) - match.beta;
+    match.alpha += M_PI;
+    match.gamma += M_PI;
+  }
+  match.alpha = wrap(match.alpha);
+  match.gamma = wrap(match.gamma);
+  return match;
+}
+
+}
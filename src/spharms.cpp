@@ -7,301 +7,679 @@
  * Spherical Harmonics Helpers
  */
 
+#include <omp.h>
 #include "spharms.h"
 
 namespace hyperspharm
 {
 
 
-SphericalSurface::SphericalSurface(const natural_t rows, const natural_t cols) :
-  rows_(rows), cols_(cols), values_(rows * cols)
+template<class T>
+const natural_t BasicSpharmPlan<T>::NO_MIRROR = std::numeric_limits<natural_t>::max();
+
+template<class T>
+const LegendreOptions BasicSpharmPlan<T>::DEFAULT_LEGENDRE_OPTIONS = {LegendreMethod::Direct, 1e-12, 1024};
+
+template<class T>
+BasicSpharmPlan<T>::BasicSpharmPlan(const natural_t rows, const natural_t cols) :
+  BasicSpharmPlan(rows, cols, rows, rows)
+{
+}
+
+template<class T>
+BasicSpharmPlan<T>::BasicSpharmPlan(const natural_t rows, const natural_t cols, const natural_t l_max,
+                                    const natural_t m_max) :
+  BasicSpharmPlan(rows, cols, l_max, m_max, GridType::Equiangular)
 {
 }
 
-SphericalSurface::SphericalSurface(const natural_t rows, const natural_t cols, const real_t init_val) :
-  rows_(rows), cols_(cols), values_(rows * cols, init_val)
+template<class T>
+BasicSpharmPlan<T>::BasicSpharmPlan(const natural_t rows, const natural_t cols, const natural_t l_max,
+                                    const natural_t m_max, const GridType grid) :
+  BasicSpharmPlan(rows, cols, l_max, m_max, grid, DEFAULT_LEGENDRE_OPTIONS)
 {
 }
 
-real_t SphericalSurface::get(natural_t theta_n, const natural_t psi_m) const
+template<class T>
+BasicSpharmPlan<T>::BasicSpharmPlan(const natural_t rows, const natural_t cols, const natural_t l_max,
+                                    const natural_t m_max, const GridType grid, const LegendreOptions& options) :
+  rows_(rows), cols_(cols), l_max_(l_max), l_nb_(std::min(l_max + 1, rows)),
+  m_nb_(std::min(std::min(m_max + 1, l_nb_), cols)), grid_(grid), compressed_rank_(0)
+{
+  if (!is_power_of_two(cols))
+  {
+    throw std::invalid_argument( "SpharmPlan: the number of columns must be a power of two (fft along psi)" );
+  }
+  const auto rule = Quadrature::get(grid, rows);
+  const auto& thetas = rule.thetas;
+  const real_t fft_normalization = 2.0 * M_PI / static_cast<real_t>(cols);
+
+  std::vector<real_t> weights;
+  weights.reserve(rows);
+  for (natural_t theta_index = 0; theta_index < rows; ++theta_index)
+  {
+    weights.push_back(rule.weights[theta_index] * fft_normalization);
+  }
+
+  // Pair each latitude of the northern half with its mirror (pi - theta), if it is part of the grid
+  natural_t south = rows;
+  for (natural_t north = 0; (north < rows) && (thetas[north] <= (M_PI / 2.0) + 1e-12); ++north)
+  {
+    while ((south > (north + 1)) && (thetas[south - 1] > (M_PI - thetas[north]) + 1e-12))
+    {
+      --south;
+    }
+    Latitude latitude = {north, NO_MIRROR, weights[north], 0.0};
+    if ((south > (north + 1)) && almost_equal(thetas[south - 1], M_PI - thetas[north], 1e-12))
+    {
+      latitude.south = south - 1;
+      latitude.south_weight = weights[south - 1];
+    }
+    latitudes_.push_back(latitude);
+  }
+
+  fast_orders_.assign(m_nb_, 0);
+  plm_offsets_.assign(m_nb_, 0);
+  if ((l_nb_ == 0) || (m_nb_ == 0)) { return; }
+  std::vector<real_t> xs;
+  xs.reserve(latitudes_.size());
+  for (const auto& latitude : latitudes_)
+  {
+    xs.push_back(std::cos(thetas[latitude.north]));
+  }
+  // The first call computes the recurrence coefficients, the parallel ones only read them
+  std::vector<real_t> column(l_nb_);
+  LegendrePoly::get_norm_order(LegendrePoly::SPHARM_NORM, l_nb_ - 1, 0, 0.0, column.data());
+
+  // The compressed orders are built straight from the recurrence: they never get a dense table
+  compress(options, xs);
+
+  natural_t size = 0;
+  for (natural_t m = 0; m < m_nb_; ++m)
+  {
+    plm_offsets_[m] = size;
+    if (!fast_orders_[m]) { size += latitudes_.size() * (l_nb_ - m); }
+  }
+  plm_.resize(size);
+
+#pragma omp parallel
+  {
+    // Per thread scratch: values of an order at one latitude
+    std::vector<real_t> plm_latitude(l_nb_);
+#pragma omp for schedule(dynamic)
+    for (natural_t m = 0; m < m_nb_; ++m)
+    {
+      if (fast_orders_[m]) { continue; }
+      for (natural_t latitude_index = 0; latitude_index < latitudes_.size(); ++latitude_index)
+      {
+        LegendrePoly::get_norm_order(LegendrePoly::SPHARM_NORM, l_nb_ - 1, m, xs[latitude_index],
+                                     plm_latitude.data());
+        auto values = plm_.data() + plm_offsets_[m] + (latitude_index * (l_nb_ - m));
+        for (natural_t l = m; l < l_nb_; ++l)
+        {
+          values[l - m] = static_cast<T>(plm_latitude[l - m]);
+        }
+      }
+    }
+  }
+}
+
+template<class T>
+void BasicSpharmPlan<T>::compress(const LegendreOptions &options, const std::vector<real_t> &xs)
 {
-  return values_[cols_ * theta_n + psi_m];
+  compressed_rank_ = 0;
+  if ((options.method == LegendreMethod::Direct) ||
+      ((options.method == LegendreMethod::Automatic) && (l_nb_ < options.threshold)))
+  {
+    return;
+  }
+
+  compressed_plm_.resize(2 * m_nb_);
+  const natural_t latitude_nb = latitudes_.size();
+#pragma omp parallel
+  {
+    // Per thread scratch: values of an order at one latitude
+    std::vector<real_t> plm_latitude(l_nb_);
+#pragma omp for schedule(dynamic)
+    for (natural_t m = 0; m < m_nb_; ++m)
+    {
+      // Matrices of the degrees l = m + parity + 2 * row (rows) at every latitude (columns)
+      const natural_t degree_nb = l_nb_ - m;
+      std::vector<real_t> values[2] = {std::vector<real_t>(((degree_nb + 1) / 2) * latitude_nb),
+                                       std::vector<real_t>((degree_nb / 2) * latitude_nb)};
+      for (natural_t latitude_index = 0; latitude_index < latitude_nb; ++latitude_index)
+      {
+        LegendrePoly::get_norm_order(LegendrePoly::SPHARM_NORM, l_nb_ - 1, m, xs[latitude_index],
+                                     plm_latitude.data());
+        for (natural_t degree = 0; degree < degree_nb; ++degree)
+        {
+          values[degree % 2][((degree / 2) * latitude_nb) + latitude_index] = plm_latitude[degree];
+        }
+      }
+
+      natural_t compressed_cost = 0;
+      for (natural_t parity = 0; parity < 2; ++parity)
+      {
+        const natural_t row_nb = (degree_nb + 1 - parity) / 2;
+        compressed_plm_[(2 * m) + parity] = CompressedLegendreMatrix(values[parity].data(), row_nb, latitude_nb,
+                                                                     options.tolerance);
+        compressed_cost += compressed_plm_[(2 * m) + parity].cost();
+      }
+
+      fast_orders_[m] = (options.method == LegendreMethod::Fast) || (compressed_cost < (degree_nb * latitude_nb)) ? 1 : 0;
+      if (!fast_orders_[m])
+      {
+        compressed_plm_[2 * m] = CompressedLegendreMatrix();
+        compressed_plm_[(2 * m) + 1] = CompressedLegendreMatrix();
+      }
+    }
+  }
+
+  for (const auto& compressed : compressed_plm_)
+  {
+    compressed_rank_ = std::max(compressed_rank_, compressed.max_rank());
+  }
 }
 
-void SphericalSurface::set(const natural_t theta_n, const natural_t psi_m, const real_t radius_nm)
+template<class T>
+const CompressedLegendreMatrix *BasicSpharmPlan<T>::compressed_plm(const natural_t m, const natural_t parity) const
 {
-  values_[cols_ * theta_n + psi_m] = radius_nm;
+  return fast_orders_[m] ? &compressed_plm_[(2 * m) + parity] : nullptr;
 }
 
-std::vector<complex_t> SphericalSurface::get_psi_array(const natural_t theta_n) const
+template<class T>
+natural_t BasicSpharmPlan<T>::compressed_rank() const
 {
-  auto start_index = values_.begin() + (theta_n * cols_);
-  return std::vector<complex_t>(start_index, start_index + cols_);
+  return compressed_rank_;
 }
 
-natural_t SphericalSurface::rows() const
+template<class T>
+natural_t BasicSpharmPlan<T>::rows() const
 {
   return rows_;
 }
 
-natural_t SphericalSurface::cols() const
+template<class T>
+natural_t BasicSpharmPlan<T>::cols() const
 {
   return cols_;
 }
 
-std::vector<real_t> SphericalSurface::thetas() const
+template<class T>
+natural_t BasicSpharmPlan<T>::l_max() const
 {
-  const real_t delta_theta = M_PI / static_cast<real_t>(rows_);
-  std::vector<real_t> result;
-  result.reserve(rows_);
+  return l_max_;
+}
 
-  real_t theta = 0;
-  for (natural_t theta_index = 0; theta_index < rows_; ++theta_index)
-  {
-    result.push_back(theta);
-    theta += delta_theta;
-  }
-  return result;
+template<class T>
+GridType BasicSpharmPlan<T>::grid() const
+{
+  return grid_;
 }
 
-std::vector<real_t> SphericalSurface::psis() const
+template<class T>
+natural_t BasicSpharmPlan<T>::l_nb() const
 {
-  const real_t delta_psi = M_PI / static_cast<real_t>(cols_);
-  std::vector<real_t> result;
-  result.reserve(cols_);
+  return l_nb_;
+}
 
-  real_t psi = 0;
-  for (natural_t psi_index = 0; psi_index < cols_; ++psi_index)
-  {
-    result.push_back(psi);
-    psi += delta_psi;
-  }
-  return result;
+template<class T>
+natural_t BasicSpharmPlan<T>::m_nb() const
+{
+  return m_nb_;
 }
 
-std::string SphericalSurface::to_string()
+template<class T>
+const std::vector<typename BasicSpharmPlan<T>::Latitude> &BasicSpharmPlan<T>::latitudes() const
 {
-  std::stringstream sstream;
-  sstream << std::scientific << std::setprecision(3) << std::left;
-  sstream << "Theta\\Psi";
-  for (unsigned int psi = 0; psi < cols_ ; ++psi)
-  {
-    sstream << std::setw(5) << std::right << (psi) << "/" <<
-               std::setw(3) << std::left << (cols_) << "pi";
-  }
-  sstream << std::endl;
+  return latitudes_;
+}
 
-  for (unsigned int theta = 0; theta < rows_ ; ++theta)
-  {
-    sstream << std::setw(3) << std::right << (theta) << "/" <<
-               std::setw(3) << std::left << (rows_ - 1) << "pi : ";
-    for (unsigned int psi = 0; psi < cols_; ++psi)
-    {
-      sstream << std::setw(10) << get(theta, psi) << " ";
-    }
-    sstream << std::endl;
-  }
-  return sstream.str();
+template<class T>
+const natural_t BasicSpharm<T>::BATCH_BLOCK_SIZE = 16;
+
+template<class T>
+BasicSphericalHarmonics<T> BasicSpharm<T>::spharm_transform(const SphericalSurface &spherical_surface)
+{
+  const SpharmPlan plan(spherical_surface.rows(), spherical_surface.cols(),
+                        spherical_surface.rows(), spherical_surface.rows(), spherical_surface.grid());
+  return spharm_transform(plan, spherical_surface);
 }
 
-void SphericalSurface::map(std::function<real_t()> func)
+template<class T>
+BasicSphericalHarmonics<T> BasicSpharm<T>::spharm_transform(const SphericalSurface &spherical_surface, const natural_t l_max)
 {
-  for(auto& value : values_)
-  {
-    value = func();
-  }
+  return spharm_transform(spherical_surface, l_max, l_max);
 }
 
-void SphericalSurface::map(std::function<real_t(const real_t old_val)> func)
+template<class T>
+BasicSphericalHarmonics<T> BasicSpharm<T>::spharm_transform(const SphericalSurface &spherical_surface,
+                                                           const natural_t l_max, const natural_t m_max)
 {
-  for(auto& value : values_)
-  {
-    value = func(value);
-  }
+  const SpharmPlan plan(spherical_surface.rows(), spherical_surface.cols(), l_max, m_max, spherical_surface.grid());
+  return spharm_transform(plan, spherical_surface);
 }
 
-void SphericalSurface::map(std::function<real_t(const natural_t theta_n,
-                                                const natural_t psi_m,
-                                                const real_t old_val)> func)
+template<class T>
+BasicSphericalHarmonics<T> BasicSpharm<T>::spharm_transform(const SpharmPlan &plan, const SphericalSurface &spherical_surface)
 {
-  natural_t n = 0;
-  natural_t m = 0;
-  for (unsigned int i = 0; i < rows_ * cols_; ++i)
-  {
-    if (cols_ == m)
-    {
-      ++n;
-      m = 0;
-    }
-    values_[i] = func(n, m, values_[i]);
-    ++m;
-  }
+  SphericalHarmonics result(plan.l_max());
+  spharm_transform_batch(plan, &spherical_surface, 1, &result);
+  return result;
 }
 
+template<class T>
+BasicSphericalHarmonics<T> BasicSpharm<T>::spharm_transform(const SpharmPlan &plan, const SphericalSurfaceView &view)
+{
+  SphericalHarmonics result(plan.l_max());
+  spharm_transform_batch(plan, &view, 1, &result);
+  return result;
+}
 
-SphericalHarmonics::SphericalHarmonics(const natural_t l_max) :
-  l_max_(l_max), values_(((l_max + 2)*(l_max + 1))/2)
+template<class T>
+void BasicSpharm<T>::spharm_transform_batch(const SphericalSurface *surfaces, const natural_t n, SphericalHarmonics *out)
 {
+  if (n == 0) { return; }
+  const SpharmPlan plan(surfaces[0].rows(), surfaces[0].cols(),
+                        surfaces[0].rows(), surfaces[0].rows(), surfaces[0].grid());
+  spharm_transform_batch(plan, surfaces, n, out);
 }
 
-complex_t SphericalHarmonics::get(const natural_t l, const natural_t m) const
+template<class T>
+void BasicSpharm<T>::spharm_transform_batch(const SpharmPlan &plan, const SphericalSurface *surfaces,
+                                            const natural_t n, SphericalHarmonics *out)
 {
-  const size_t index = ((l+1) * l)/2 + m;
-  if(index >= values_.size())
+  std::vector<SphericalSurfaceView> views;
+  views.reserve(n);
+  for (natural_t surface_index = 0; surface_index < n; ++surface_index)
   {
-    return {0, 0};
+    views.push_back(surfaces[surface_index].view());
   }
+  spharm_transform_batch(plan, views.data(), n, out);
+}
 
-  return values_[index];
+template<class T>
+void BasicSpharm<T>::spharm_transform_batch(const SpharmPlan &plan, const SphericalSurfaceView *surfaces,
+                                            const natural_t n, SphericalHarmonics *out)
+{
+  Workspace workspace(required_bytes(plan, n));
+  spharm_transform_batch(plan, surfaces, n, out, workspace);
 }
 
-void SphericalHarmonics::set(const natural_t l, const natural_t m, const complex_t value)
+template<class T>
+natural_t BasicSpharm<T>::required_bytes(const SpharmPlan &plan, const natural_t n)
 {
-  const size_t index = ((l+1) * l)/2 + m;
-  if(index >= values_.size())
-  {
-    return;
-  }
-  values_[index] = value;
+  const auto thread_nb = static_cast<natural_t>(omp_get_max_threads());
+  const natural_t block_size = std::min(BATCH_BLOCK_SIZE, std::max<natural_t>(n, 1));
+  const natural_t fft_bytes = Workspace::aligned_size(thread_nb * get_fft_buffer_size(plan) *
+                                                      sizeof(std::complex<T>));
+  const natural_t forward_bytes =
+      Workspace::aligned_size(plan.rows() * plan.m_nb() * n * sizeof(std::complex<T>)) + fft_bytes +
+      Workspace::aligned_size(thread_nb * block_size * get_legendre_buffer_size(plan) * sizeof(complex_t));
+  const natural_t inverse_bytes =
+      Workspace::aligned_size(plan.rows() * plan.m_nb() * sizeof(complex_t)) + fft_bytes +
+      Workspace::aligned_size(thread_nb * get_legendre_buffer_size(plan) * sizeof(complex_t));
+  return std::max(forward_bytes, inverse_bytes);
 }
 
-natural_t SphericalHarmonics::l_max() const
+template<class T>
+void BasicSpharm<T>::spharm_transform(const SpharmPlan &plan, const SphericalSurfaceView &view,
+                                      SphericalHarmonics &out, Workspace &workspace)
 {
-  return l_max_;
+  spharm_transform_batch(plan, &view, 1, &out, workspace);
 }
 
-std::string SphericalHarmonics::to_string()
+template<class T>
+void BasicSpharm<T>::spharm_transform_batch(const SpharmPlan &plan, const SphericalSurfaceView *surfaces,
+                                            const natural_t n, SphericalHarmonics *out, Workspace &workspace)
 {
-  std::stringstream sstream;
-  sstream << std::scientific << std::setprecision(2);
-  sstream << " l\\m  ";
-  for (unsigned int m = 0; m < l_max_ ; ++m)
+#pragma omp parallel for schedule(static)
+  for (natural_t surface_index = 0; surface_index < n; ++surface_index)
   {
-    sstream << std::setw(11) << m << std::setw(9) << " ";
+    prepare_harmonics(plan, out[surface_index]);
   }
-  sstream << std::endl;
+  compute_harmonics(plan, surfaces, n, [out](const natural_t surface_index) {
+    return out[surface_index].values().data();
+  }, workspace);
+}
 
-  for (unsigned int l = 0; l < l_max_ ; ++l)
+template<class T>
+void BasicSpharm<T>::spharm_transform_batch(const SpharmPlan &plan, const SphericalSurfaceView *surfaces,
+                                            const natural_t n, std::complex<T> *out, Workspace &workspace)
+{
+  // The coefficients the plan does not compute are 0. Filled with the static schedule of the surfaces
+  // (first touch of the pages by the threads writing them)
+  const natural_t size = ((plan.l_max() + 1) * (plan.l_max() + 2)) / 2;
+#pragma omp parallel for schedule(static)
+  for (natural_t surface_index = 0; surface_index < n; ++surface_index)
   {
-    sstream << std::setw(3) << l << " : ";
-    for (unsigned int m = 0; m <= l; ++m)
-    {
-      sstream << std::setw(18) << get(l, m) << " ";
-    }
-    sstream << std::endl;
+    std::fill_n(out + (surface_index * size), size, std::complex<T>(0, 0));
   }
-  return sstream.str();
+  compute_harmonics(plan, surfaces, n, [out, size](const natural_t surface_index) {
+    return out + (surface_index * size);
+  }, workspace);
 }
 
-SphericalHarmonics Spharm::spharm_transform(const SphericalSurface &spherical_surface)
+template<class T>
+template<class Output>
+void BasicSpharm<T>::compute_harmonics(const SpharmPlan &plan, const SphericalSurfaceView *surfaces,
+                                       const natural_t n, Output output, Workspace &workspace)
 {
-  const auto thetas = spherical_surface.thetas();
-  const auto l_max = thetas.size();
-  std::vector<real_t> cos_thetas, sin_thetas;
-  cos_thetas.reserve(thetas.size());
-  sin_thetas.reserve(thetas.size());
-  for (const auto& theta : thetas)
+  for (natural_t surface_index = 0; surface_index < n; ++surface_index)
   {
-    cos_thetas.push_back(std::cos(theta));
-    sin_thetas.push_back(std::sin(theta));
+    if ((surfaces[surface_index].rows() != plan.rows()) || (surfaces[surface_index].cols() != plan.cols()) ||
+        (surfaces[surface_index].grid() != plan.grid()))
+    {
+      throw std::invalid_argument( "Spharm transform: all the surfaces must have the size and grid of the plan" );
+    }
   }
 
-  const auto fm_thetas = compute_fm_thetas(spherical_surface);
-  const auto cheb_weights = compute_cheb_weights(thetas.size());
-  std::vector<natural_t> plm_indexes;
-  const auto plm_weight_sin_thetas = compute_plm_weight_sin_thetas(cheb_weights,
-                                                                   cos_thetas, sin_thetas,
-                                                                   l_max, plm_indexes);
-
-  const real_t fft_normalization = 2.0 * M_PI / static_cast<real_t>(sin_thetas.size());
-  const real_t quadrature_normalization = M_PI / static_cast<real_t>(sin_thetas.size());
-
-  SphericalHarmonics result(spherical_surface.rows());
-
-  for (natural_t l = 0; l < result.l_max(); ++l)
+  const auto& latitudes = plan.latitudes();
+  const natural_t latitude_nb = latitudes.size();
+  const natural_t l_nb = plan.l_nb();
+  const natural_t m_nb = plan.m_nb();
+  const natural_t block_nb = (n + BATCH_BLOCK_SIZE - 1) / BATCH_BLOCK_SIZE;
+  const natural_t block_size = std::min(BATCH_BLOCK_SIZE, std::max<natural_t>(n, 1));
+
+  const natural_t mark = workspace.used();
+  const auto thread_nb = static_cast<natural_t>(omp_get_max_threads());
+  const natural_t legendre_buffer_size = block_size * get_legendre_buffer_size(plan);
+  std::complex<T>* fm_thetas = workspace.allocate<std::complex<T>>(plan.rows() * m_nb * n);
+  std::complex<T>* fft_buffers = workspace.allocate<std::complex<T>>(thread_nb * get_fft_buffer_size(plan));
+  complex_t* legendre_buffers = workspace.allocate<complex_t>(thread_nb * legendre_buffer_size);
+  compute_fm_thetas(plan, surfaces, n, fm_thetas, fft_buffers);
+
+#pragma omp parallel
   {
-    for (natural_t m = 0; m <= l; ++m)
+    // Per thread scratch: folded sums of the block, then its coefficients
+    complex_t* even = legendre_buffers + (static_cast<natural_t>(omp_get_thread_num()) * legendre_buffer_size);
+    complex_t* odd = even + (latitude_nb * block_size);
+    complex_t* flms = odd + (latitude_nb * block_size);
+    complex_t* flms_parity = flms + (l_nb * block_size);
+    complex_t* compressed_scratch = flms_parity + (l_nb * block_size);
+#pragma omp for collapse(2) schedule(dynamic)
+    for (natural_t m = 0; m < m_nb; ++m)
     {
-      complex_t flm = {0, 0};
-      for (natural_t theta_index = 0; theta_index < thetas.size(); ++theta_index)
+      for (natural_t block = 0; block < block_nb; ++block)
       {
-        flm += fm_thetas[theta_index][m] * plm_weight_sin_thetas[plm_indexes[theta_index]].unsafe_get(l, m);
+        const natural_t first = block * BATCH_BLOCK_SIZE;
+        const natural_t size = std::min(BATCH_BLOCK_SIZE, n - first);
+        const natural_t degree_nb = l_nb - m;
+
+        // Fold the mirrored latitudes into the sums used by the even (l + m) and odd (l + m) degrees
+        for (natural_t latitude_index = 0; latitude_index < latitude_nb; ++latitude_index)
+        {
+          const auto& latitude = latitudes[latitude_index];
+          const std::complex<T>* north = fm_thetas + (((latitude.north * m_nb) + m) * n) + first;
+          complex_t* even_latitude = even + (latitude_index * size);
+          complex_t* odd_latitude = odd + (latitude_index * size);
+          for (natural_t i = 0; i < size; ++i)
+          {
+            even_latitude[i] = complex_t(north[i]) * latitude.north_weight;
+            odd_latitude[i] = even_latitude[i];
+          }
+          if (latitude.south != SpharmPlan::NO_MIRROR)
+          {
+            const std::complex<T>* south = fm_thetas + (((latitude.south * m_nb) + m) * n) + first;
+            for (natural_t i = 0; i < size; ++i)
+            {
+              const complex_t south_value = complex_t(south[i]) * latitude.south_weight;
+              even_latitude[i] += south_value;
+              odd_latitude[i] -= south_value;
+            }
+          }
+        }
+
+        std::fill_n(flms, degree_nb * size, complex_t(0, 0));
+        if (plan.compressed_plm(m, 0) != nullptr)
+        {
+          for (natural_t parity = 0; parity < 2; ++parity)
+          {
+            const auto compressed = plan.compressed_plm(m, parity);
+            std::fill_n(flms_parity, compressed->rows() * size, complex_t(0, 0));
+            compressed->apply(parity == 0 ? even : odd, flms_parity, size, compressed_scratch);
+            for (natural_t row = 0; row < compressed->rows(); ++row)
+            {
+              std::copy(flms_parity + (row * size), flms_parity + ((row + 1) * size),
+                        flms + ((parity + (2 * row)) * size));
+            }
+          }
+        }
+        else
+        {
+          for (natural_t latitude_index = 0; latitude_index < latitude_nb; ++latitude_index)
+          {
+            const T* plm = plan.plm(m, latitude_index);
+            const complex_t* even_latitude = even + (latitude_index * size);
+            const complex_t* odd_latitude = odd + (latitude_index * size);
+            for (natural_t degree = 0; degree < degree_nb; ++degree)
+            {
+              const real_t p = static_cast<real_t>(plm[degree]);
+              const complex_t* folded = is_even(degree) ? even_latitude : odd_latitude;
+              complex_t* flm = flms + (degree * size);
+              for (natural_t i = 0; i < size; ++i)
+              {
+                flm[i] += p * folded[i];
+              }
+            }
+          }
+        }
+
+        for (natural_t degree = 0; degree < degree_nb; ++degree)
+        {
+          const natural_t l = m + degree;
+          for (natural_t i = 0; i < size; ++i)
+          {
+            output(first + i)[((l * (l + 1)) / 2) + m] = static_cast<std::complex<T>>(flms[(degree * size) + i]);
+          }
+        }
       }
-      result.set(l, m, flm * fft_normalization * quadrature_normalization);
     }
   }
+  workspace.rewind(mark);
+}
+
+template<class T>
+BasicSphericalSurface<T> BasicSpharm<T>::ispharm_transform(const SphericalHarmonics &spherical_harmonics)
+{
+  natural_t size = 1;
+  while (size < (2 * (spherical_harmonics.l_max() + 1))) { size *= 2; }
+  const SpharmPlan plan(size, size, spherical_harmonics.l_max(), spherical_harmonics.l_max());
+  return ispharm_transform(plan, spherical_harmonics);
+}
 
+template<class T>
+BasicSphericalSurface<T> BasicSpharm<T>::ispharm_transform(const SpharmPlan &plan, const SphericalHarmonics &spherical_harmonics)
+{
+  SphericalSurface result(plan.rows(), plan.cols(), plan.grid());
+  Workspace workspace(required_bytes(plan));
+  ispharm_transform(plan, spherical_harmonics, result, workspace);
   return result;
 }
 
-// TODO: Check: there is most likely an error in this function 
-// Pnm(cos(theta)) = (-1)^(n+m)Pnm(cos(pi-theta))
-// and not Pnm(cos(theta)) = (-1)^(n+m)Pnm(cos(pi-theta))
-std::vector<NormalizedLegendreArray>
-Spharm::compute_plm_weight_sin_thetas(const std::vector<real_t> &weights,
-                                      const std::vector<real_t> &cos_thetas,
-                                      const std::vector<real_t> &sin_thetas,
-                                      const natural_t l_max,
-                                      std::vector<natural_t> &plm_indexes)
-{
-  const auto max_theta_index = static_cast<natural_t>(cos_thetas.size() / 2.0);
-  std::vector<NormalizedLegendreArray> plm_thetas;
-  plm_thetas.reserve(cos_thetas.size());
-  for (natural_t theta_index = 0; theta_index <= max_theta_index; ++theta_index)
+template<class T>
+void BasicSpharm<T>::ispharm_transform(const SpharmPlan &plan, const SphericalHarmonics &spherical_harmonics,
+                                       SphericalSurface &out, Workspace &workspace)
+{
+  if ((out.rows() != plan.rows()) || (out.cols() != plan.cols()) || (out.grid() != plan.grid()))
   {
-    const real_t norm = sin_thetas[theta_index] * weights[theta_index] * LegendrePoly::SPHARM_NORM;
-    auto pnm_theta = LegendrePoly::get_norm_array(norm,
-                                                  l_max,
-                                                  cos_thetas[theta_index]);
-    plm_thetas.push_back(std::move(pnm_theta));
+    out = SphericalSurface(plan.rows(), plan.cols(), plan.grid());
   }
+  ispharm_transform(plan, spherical_harmonics.view(), out.data(), workspace);
+}
 
-  plm_indexes.clear();
-  plm_indexes.reserve(cos_thetas.size());
-  for (natural_t theta_index = 0; theta_index <= max_theta_index; ++theta_index)
+template<class T>
+void BasicSpharm<T>::ispharm_transform(const SpharmPlan &plan, const SphericalHarmonicsView &spherical_harmonics,
+                                       T *out, Workspace &workspace)
+{
+  const auto& latitudes = plan.latitudes();
+  const natural_t latitude_nb = latitudes.size();
+  const natural_t l_nb = plan.l_nb();
+  const natural_t m_nb = plan.m_nb();
+  const natural_t cols = plan.cols();
+
+  const natural_t mark = workspace.used();
+  const auto thread_nb = static_cast<natural_t>(omp_get_max_threads());
+  const natural_t fft_buffer_size = get_fft_buffer_size(plan);
+  const natural_t legendre_buffer_size = get_legendre_buffer_size(plan);
+  complex_t* gm_thetas = workspace.allocate<complex_t>(plan.rows() * m_nb);
+  std::complex<T>* fft_buffers = workspace.allocate<std::complex<T>>(thread_nb * fft_buffer_size);
+  complex_t* legendre_buffers = workspace.allocate<complex_t>(thread_nb * legendre_buffer_size);
+
+  // g_m(theta) = sum_l f_lm P_l^m(cos(theta)), stored as [theta][m]
+#pragma omp parallel
   {
-    plm_indexes.push_back(theta_index);
+    // First touch of the rows in the static schedule of the fft stage which reads them
+#pragma omp for schedule(static)
+    for (natural_t theta_index = 0; theta_index < plan.rows(); ++theta_index)
+    {
+      std::fill_n(gm_thetas + (theta_index * m_nb), m_nb, complex_t(0, 0));
+    }
+
+    complex_t* even = legendre_buffers + (static_cast<natural_t>(omp_get_thread_num()) * legendre_buffer_size);
+    complex_t* odd = even + latitude_nb;
+    complex_t* flms = odd + latitude_nb;
+    complex_t* compressed_scratch = flms + l_nb;
+#pragma omp for schedule(dynamic)
+    for (natural_t m = 0; m < m_nb; ++m)
+    {
+      const natural_t degree_nb = l_nb - m;
+      std::fill_n(even, latitude_nb, complex_t(0, 0));
+      std::fill_n(odd, latitude_nb, complex_t(0, 0));
+      if (plan.compressed_plm(m, 0) != nullptr)
+      {
+        for (natural_t parity = 0; parity < 2; ++parity)
+        {
+          const auto compressed = plan.compressed_plm(m, parity);
+          for (natural_t row = 0; row < compressed->rows(); ++row)
+          {
+            flms[row] = complex_t(spherical_harmonics.get(m + parity + (2 * row), m));
+          }
+          compressed->apply_transpose(flms, parity == 0 ? even : odd, 1, compressed_scratch);
+        }
+      }
+      else
+      {
+        for (natural_t degree = 0; degree < degree_nb; ++degree)
+        {
+          flms[degree] = complex_t(spherical_harmonics.get(m + degree, m));
+        }
+        for (natural_t latitude_index = 0; latitude_index < latitude_nb; ++latitude_index)
+        {
+          const T* plm = plan.plm(m, latitude_index);
+          for (natural_t degree = 0; degree < degree_nb; ++degree)
+          {
+            auto& folded = is_even(degree) ? even[latitude_index] : odd[latitude_index];
+            folded += static_cast<real_t>(plm[degree]) * flms[degree];
+          }
+        }
+      }
+
+      for (natural_t latitude_index = 0; latitude_index < latitude_nb; ++latitude_index)
+      {
+        const auto& latitude = latitudes[latitude_index];
+        gm_thetas[(latitude.north * m_nb) + m] = even[latitude_index] + odd[latitude_index];
+        if (latitude.south != SpharmPlan::NO_MIRROR)
+        {
+          gm_thetas[(latitude.south * m_nb) + m] = even[latitude_index] - odd[latitude_index];
+        }
+      }
+    }
   }
 
-  const natural_t start_index = is_even(cos_thetas.size()) ?  max_theta_index - 1 :  max_theta_index;
-  for (natural_t theta_index = start_index; theta_index > 0; --theta_index)
+  // f(theta, psi) = sum_m g_m(theta) e^{i m psi} with g_{-m} = conj(g_m) for a real function
+#pragma omp parallel
   {
-    plm_indexes.push_back(theta_index);
+    std::complex<T>* psi_array = fft_buffers + (static_cast<natural_t>(omp_get_thread_num()) * fft_buffer_size);
+    std::complex<T>* fft_scratch = psi_array + cols;
+#pragma omp for schedule(static)
+    for (natural_t theta_index = 0; theta_index < plan.rows(); ++theta_index)
+    {
+      std::fill_n(psi_array, cols, std::complex<T>(0, 0));
+      for (natural_t m = 0; m < m_nb; ++m)
+      {
+        const auto gm = static_cast<std::complex<T>>(gm_thetas[(theta_index * m_nb) + m]);
+        psi_array[m % cols] += gm;
+        if (m > 0) { psi_array[(cols - (m % cols)) % cols] += std::conj(gm); }
+      }
+      ifft(psi_array, cols, fft_scratch);
+      T* row = out + (theta_index * cols);
+      for (natural_t psi_index = 0; psi_index < cols; ++psi_index)
+      {
+        row[psi_index] = psi_array[psi_index].real() * static_cast<T>(cols);
+      }
+    }
   }
-
-  return plm_thetas;
+  workspace.rewind(mark);
 }
 
-std::vector<std::vector<complex_t>>
-Spharm::compute_fm_thetas(const SphericalSurface &spherical_surface)
+template<class T>
+void BasicSpharm<T>::compute_fm_thetas(const SpharmPlan &plan, const SphericalSurfaceView *surfaces, const natural_t n,
+                                       std::complex<T>* fm_thetas, std::complex<T>* fft_buffers)
 {
-  std::vector<std::vector<complex_t>> fm_thetas;
-  fm_thetas.reserve(spherical_surface.rows());
-  for (natural_t theta_index = 0; theta_index < spherical_surface.rows(); ++theta_index)
+  const natural_t rows = plan.rows();
+  const natural_t cols = plan.cols();
+  const natural_t m_nb = plan.m_nb();
+  const natural_t fft_buffer_size = get_fft_buffer_size(plan);
+
+#pragma omp parallel
   {
-    std::vector<complex_t> fm_theta = spherical_surface.get_psi_array(theta_index);
-    fft(fm_theta.data(), fm_theta.size());
-    fm_thetas.push_back(move(fm_theta));
+    std::complex<T>* fm_theta = fft_buffers + (static_cast<natural_t>(omp_get_thread_num()) * fft_buffer_size);
+    std::complex<T>* fft_scratch = fm_theta + ((cols / 2) + 1);
+    // Static schedule over the rows: each thread writes the contiguous [theta] slabs of its chunk, so the
+    // pages of the uninitialized workspace are first touched on the NUMA node of their writer
+#pragma omp for schedule(static)
+    for (natural_t theta_index = 0; theta_index < rows; ++theta_index)
+    {
+      for (natural_t surface_index = 0; surface_index < n; ++surface_index)
+      {
+        // The real row is read in place: only the cols / 2 + 1 first coefficients are computed,
+        // the others being conjugates of them
+        rfft(surfaces[surface_index].row(theta_index), cols, fm_theta, fft_scratch);
+        for (natural_t m = 0; m < m_nb; ++m)
+        {
+          fm_thetas[(((theta_index * m_nb) + m) * n) + surface_index] =
+              (m <= (cols / 2)) ? fm_theta[m] : std::conj(fm_theta[cols - m]);
+        }
+      }
+    }
   }
-  return fm_thetas;
 }
 
-std::vector<real_t> Spharm::compute_cheb_weights(const natural_t n)
+template<class T>
+void BasicSpharm<T>::prepare_harmonics(const SpharmPlan &plan, SphericalHarmonics &harmonics)
 {
-  std::vector<real_t> result;
-  result.reserve(n);
-  const real_t delta_theta = M_PI / static_cast<real_t>(n);
-  real_t theta = 0;
-  for (natural_t k = 0; k < n; ++k)
+  if (harmonics.l_max() != plan.l_max())
+  {
+    harmonics = SphericalHarmonics(plan.l_max());
+    return;
+  }
+  // Reused coefficients: clear the ones the plan does not compute
+  for (natural_t l = 0; l <= plan.l_max(); ++l)
   {
-    real_t sum = 0;
-    for (natural_t l = 0; l < n / 2; ++l)
+    for (natural_t m = ((l < plan.l_nb()) ? std::min(l + 1, plan.m_nb()) : 0); m <= l; ++m)
     {
-      sum += std::sin((2.0 * l + 1.0) * theta) / (2.0 * l + 1.0);
+      harmonics.set(l, m, {0, 0});
     }
-    result.push_back(sum * 4.0 / M_PI);
-    theta += delta_theta;
   }
-  return result;
 }
+
+template<class T>
+natural_t BasicSpharm<T>::get_fft_buffer_size(const SpharmPlan &plan)
+{
+  // Complex inverse fft (cols values and cols / 2 of scratch), larger than the real forward one
+  return plan.cols() + (plan.cols() / 2);
+}
+
+template<class T>
+natural_t BasicSpharm<T>::get_legendre_buffer_size(const SpharmPlan &plan)
+{
+  return (2 * (plan.latitudes().size() + plan.l_nb())) + plan.compressed_rank();
+}
+
+template class BasicSpharmPlan<float>;
+template class BasicSpharmPlan<double>;
+template class BasicSpharm<float>;
+template class BasicSpharm<double>;
+
 }
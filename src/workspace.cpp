@@ -0,0 +1,57 @@
+/**
+ * @file workspace.cpp
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Scratch memory of the transforms
+ */
+
+#include <algorithm>
+#include "workspace.h"
+
+namespace hyperspharm
+{
+
+const natural_t Workspace::ALIGNMENT;
+
+Workspace::Workspace() :
+  used_(0)
+{
+}
+
+Workspace::Workspace(const natural_t bytes) :
+  buffer_(bytes), used_(0)
+{
+}
+
+void Workspace::reset()
+{
+  used_ = 0;
+}
+
+void Workspace::rewind(const natural_t mark)
+{
+  used_ = std::min(used_, mark);
+}
+
+void Workspace::reserve(const natural_t bytes)
+{
+  used_ = 0;
+  if (bytes > buffer_.size())
+  {
+    buffer_ = uninitialized_vector<char>(bytes);
+  }
+}
+
+natural_t Workspace::capacity() const
+{
+  return buffer_.size();
+}
+
+natural_t Workspace::used() const
+{
+  return used_;
+}
+
+}
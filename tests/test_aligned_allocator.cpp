@@ -0,0 +1,160 @@
+#include <cstdint>
+#include "aligned_allocator.h"
+#include "hyperspharm.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+namespace
+{
+
+bool is_aligned(const void* pointer, const std::uintptr_t alignment)
+{
+  return (reinterpret_cast<std::uintptr_t>(pointer) % alignment) == 0;
+}
+
+std::size_t counted_bytes = 0;
+
+/** User allocator keeping track of the bytes it currently holds */
+template<class T>
+class CountingAllocator
+{
+public:
+  typedef T value_type;
+
+  CountingAllocator() noexcept = default;
+  template<class U>
+  CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+  T* allocate(const std::size_t n)
+  {
+    counted_bytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* pointer, const std::size_t n) noexcept
+  {
+    counted_bytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(pointer, n);
+  }
+};
+
+template<class T, class U>
+bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) noexcept
+{
+  return true;
+}
+
+template<class T, class U>
+bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&) noexcept
+{
+  return false;
+}
+
+}
+
+TEST(AlignedAllocator, Alignment)
+{
+  for (natural_t size = 1; size < 100; size += 7)
+  {
+    aligned_vector<char> bytes(size);
+    EXPECT_TRUE(is_aligned(bytes.data(), 64));
+    std::vector<real_t, AlignedAllocator<real_t, 256>> values(size, 1.0);
+    EXPECT_TRUE(is_aligned(values.data(), 256));
+  }
+  EXPECT_EQ(aligned_vector<real_t>().data(), nullptr);
+}
+
+TEST(AlignedAllocator, Containers)
+{
+  const HyperSphericalSurface surface(3, 5, 7);
+  EXPECT_TRUE(is_aligned(surface.values().data(), 64));
+  const HyperSphericalCoeffs coeffs(5, CoeffsLayout::Tetrahedral);
+  EXPECT_TRUE(is_aligned(coeffs.values().data(), 64));
+  const SphericalSurface sphere(5, 8);
+  EXPECT_TRUE(is_aligned(sphere.view().data(), 64));
+  auto gegenbauer = GegenbauerPoly::get_norm_array(4, 0.5);
+  for (const auto& values : gegenbauer.values())
+  {
+    EXPECT_TRUE(is_aligned(values.data(), 64));
+  }
+}
+
+TEST(HugePageAllocator, Alignment)
+{
+  huge_page_vector<real_t> small(100, 2.0);
+  EXPECT_TRUE(is_aligned(small.data(), 64));
+
+  huge_page_vector<real_t> large((3 * HugePageAllocator<real_t>::HUGE_PAGE_SIZE) / sizeof(real_t), 2.0);
+  EXPECT_TRUE(is_aligned(large.data(), HugePageAllocator<real_t>::HUGE_PAGE_SIZE));
+  EXPECT_EQ(large.back(), 2.0);
+}
+
+TEST(HugePageAllocator, Containers)
+{
+  // 64 x 64 x 64 radii: 2 MiB, allocated on a huge page boundary
+  BasicHyperSphericalSurface<HugePageAllocator<real_t>> surface(64, 64, 64, 1.0);
+  EXPECT_TRUE(is_aligned(surface.values().data(), HugePageAllocator<real_t>::HUGE_PAGE_SIZE));
+  surface.set(3, 4, 5, 2.0);
+  EXPECT_EQ(surface.view().get(3, 4, 5), 2.0);
+  const BasicHyperSphericalCoeffs<HugePageAllocator<complex_t>> coeffs(4, CoeffsLayout::Tetrahedral, {1.0, 0.0});
+  EXPECT_EQ(coeffs.get(3, 2, 1), complex_t(1.0, 0.0));
+
+  // The transforms read any container through its view
+  const natural_t l_max = 7;
+  BasicSphericalSurface<real_t, HugePageAllocator<real_t>> sphere(16, 16);
+  SphericalSurface reference(16, 16);
+  for (natural_t theta_n = 0; theta_n < 16; ++theta_n)
+  {
+    for (natural_t psi_m = 0; psi_m < 16; ++psi_m)
+    {
+      sphere.set(theta_n, psi_m, std::cos(0.3 * theta_n) + std::sin(0.2 * psi_m));
+      reference.set(theta_n, psi_m, sphere.get(theta_n, psi_m));
+    }
+  }
+  const SpharmPlan plan(16, 16, l_max, l_max);
+  Workspace workspace(Spharm::required_bytes(plan));
+  BasicSphericalHarmonics<real_t> harmonics(l_max);
+  Spharm::spharm_transform(plan, sphere.view(), harmonics, workspace);
+  const auto expected = Spharm::spharm_transform(plan, reference);
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      EXPECT_EQ(harmonics.get(l, m), expected.get(l, m));
+    }
+  }
+}
+
+TEST(CustomAllocator, Containers)
+{
+  {
+    BasicHyperSphericalSurface<CountingAllocator<real_t>> surface(3, 5, 7, 1.0);
+    surface.set(2, 3, 4, 2.0);
+    EXPECT_EQ(surface.view().get(2, 3, 4), 2.0);
+    EXPECT_EQ(counted_bytes, 3 * 5 * 7 * sizeof(real_t));
+
+    BasicHyperSphericalCoeffs<CountingAllocator<complex_t>> coeffs(4, CoeffsLayout::Tetrahedral, {1.0, 0.0});
+    coeffs.set(3, 2, 1, {0.0, 1.0});
+    EXPECT_EQ(coeffs.view().get(3, 2, 1), complex_t(0.0, 1.0));
+
+    BasicSphericalSurface<real_t, CountingAllocator<real_t>> sphere(4, 8, 1.0);
+    sphere.set(1, 2, 3.0);
+    EXPECT_EQ(sphere.view().get(1, 2), 3.0);
+
+    BasicSphericalHarmonics<real_t, CountingAllocator<complex_t>> harmonics(5);
+    harmonics.set(4, 3, {1.0, 2.0});
+    EXPECT_EQ(harmonics.view().get(4, 3), complex_t(1.0, 2.0));
+
+    BasicNormalizedLegendreArray<CountingAllocator<real_t>> legendre(6);
+    legendre.set(5, 3, 0.5);
+    EXPECT_EQ(legendre.get(5, 3), 0.5);
+
+    BasicGegenbauerArray<CountingAllocator<real_t>> gegenbauer(6);
+    gegenbauer.set(5, 3, 0.25);
+    EXPECT_EQ(gegenbauer.get(5, 3), 0.25);
+
+    EXPECT_GT(counted_bytes, 3 * 5 * 7 * sizeof(real_t));
+  }
+  EXPECT_EQ(counted_bytes, 0u);
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include "descriptor_database.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+namespace
+{
+
+std::vector<SearchResult> brute_force(const std::vector<float>& descriptors, const natural_t dimension,
+                                      const float* query, const natural_t k, const Metric metric)
+{
+  std::vector<SearchResult> results;
+  for (natural_t row = 0; row < (descriptors.size() / dimension); ++row)
+  {
+    float score = 0;
+    for (natural_t i = 0; i < dimension; ++i)
+    {
+      const float value = descriptors[(row * dimension) + i];
+      score += (metric == Metric::L2) ? ((value - query[i]) * (value - query[i])) : (value * query[i]);
+    }
+    results.push_back({row, score});
+  }
+  std::stable_sort(results.begin(), results.end(), [metric](const SearchResult& left, const SearchResult& right) {
+    return (metric == Metric::L2) ? (left.score < right.score) : (left.score > right.score);
+  });
+  results.resize(std::min<natural_t>(k, results.size()));
+  return results;
+}
+
+}
+
+TEST(DescriptorDatabase, AppendAndReopen)
+{
+  const std::string path = ::testing::TempDir() + "descriptor_database_append.bin";
+  const natural_t dimension = 21;
+  {
+    auto database = DescriptorDatabase::create(path, dimension);
+    EXPECT_EQ(database.size(), 0u);
+    EXPECT_EQ(database.row_stride(), 32u);
+    EXPECT_TRUE(database.search(std::vector<float>(dimension).data(), 5, Metric::L2).empty());
+
+    std::vector<float> descriptors(3 * dimension);
+    for (natural_t i = 0; i < descriptors.size(); ++i) { descriptors[i] = static_cast<float>(i); }
+    database.append(descriptors.data(), 2);
+    database.append(descriptors.data() + (2 * dimension), 1);
+    EXPECT_EQ(database.size(), 3u);
+  }
+
+  const DescriptorDatabase database(path);
+  EXPECT_EQ(database.dimension(), dimension);
+  EXPECT_EQ(database.size(), 3u);
+  EXPECT_FLOAT_EQ(database.row(2)[4], static_cast<float>((2 * dimension) + 4));
+  EXPECT_FLOAT_EQ(database.row(1)[dimension], 0.0f);
+
+  {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream << "not a database";
+  }
+  EXPECT_THROW(DescriptorDatabase{path}, std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST(DescriptorDatabase, Search)
+{
+  const std::string path = ::testing::TempDir() + "descriptor_database_search.bin";
+  const natural_t dimension = 36;
+  // Several shards, the last one partial
+  const natural_t count = (2 * DescriptorDatabase::SHARD_SIZE) + 123;
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+  std::vector<float> descriptors(count * dimension);
+  for (auto& value : descriptors) { value = dis(gen); }
+  auto database = DescriptorDatabase::create(path, dimension);
+  database.append(descriptors.data(), count);
+
+  const natural_t query_nb = 5;
+  const natural_t k = 10;
+  std::vector<float> queries(query_nb * dimension);
+  for (auto& value : queries) { value = dis(gen); }
+  // A stored descriptor is its own nearest neighbour
+  std::copy(descriptors.begin() + (4567 * dimension), descriptors.begin() + (4568 * dimension), queries.begin());
+
+  for (const auto metric : {Metric::L2, Metric::InnerProduct})
+  {
+    std::vector<SearchResult> results(query_nb * k);
+    EXPECT_EQ(database.search_batch(queries.data(), query_nb, k, metric, results.data()), k);
+    for (natural_t query_i = 0; query_i < query_nb; ++query_i)
+    {
+      const auto expected = brute_force(descriptors, dimension, queries.data() + (query_i * dimension), k, metric);
+      for (natural_t result_i = 0; result_i < k; ++result_i)
+      {
+        EXPECT_EQ(results[(query_i * k) + result_i].index, expected[result_i].index);
+        EXPECT_NEAR(results[(query_i * k) + result_i].score, expected[result_i].score, 1e-4);
+      }
+    }
+  }
+  const auto nearest = database.search(queries.data(), 1, Metric::L2);
+  ASSERT_EQ(nearest.size(), 1u);
+  EXPECT_EQ(nearest[0].index, 4567u);
+  EXPECT_FLOAT_EQ(nearest[0].score, 0.0f);
+  EXPECT_EQ(database.search(queries.data(), count + 10, Metric::InnerProduct).size(), count);
+  std::remove(path.c_str());
+}
@@ -1,4 +1,5 @@
 
+#include <vector>
 #include "fft.h"
 #include "gtest/gtest.h"
 namespace hyperspharm
@@ -50,4 +51,50 @@ TEST(FFT, ValidIFFT)
   }
 }
 
+TEST(FFT, SinglePrecision)
+{
+  const natural_t size = 64;
+  std::vector<std::complex<float>> x(size);
+  std::vector<complex_t> y(size);
+  for (natural_t i = 0; i < size; ++i)
+  {
+    y[i] = complex_t(std::cos(0.3 * i), std::sin(0.7 * i));
+    x[i] = std::complex<float>(y[i]);
+  }
+  EXPECT_TRUE(fft(x.data(), size));
+  EXPECT_TRUE(fft(y.data(), size));
+  for (natural_t i = 0; i < size; ++i)
+  {
+    EXPECT_NEAR(std::abs(complex_t(x[i]) - y[i]), 0.0, 1e-4);
+  }
+  EXPECT_TRUE(ifft(x.data(), size));
+  EXPECT_NEAR(x[3].real(), std::cos(0.9), 1e-5);
+}
+
+TEST(FFT, RealInput)
+{
+  for (natural_t size = 1; size <= 256; size *= 2)
+  {
+    std::vector<real_t> x(size);
+    std::vector<complex_t> y(size);
+    for (natural_t i = 0; i < size; ++i)
+    {
+      x[i] = std::cos(0.3 * i) + std::sin(1.1 * i * i);
+      y[i] = x[i];
+    }
+    std::vector<complex_t> output((size / 2) + 1);
+    std::vector<complex_t> scratch(std::max<natural_t>(size / 4, 1));
+    EXPECT_TRUE(rfft(x.data(), size, output.data(), scratch.data()));
+    EXPECT_TRUE(fft(y.data(), size));
+    for (natural_t i = 0; i <= (size / 2); ++i)
+    {
+      EXPECT_NEAR(std::abs(output[i] - y[i]), 0.0, 1e-10) << "size " << size << ", index " << i;
+    }
+  }
+
+  std::vector<float> x(6);
+  std::vector<std::complex<float>> output(4), scratch(2);
+  EXPECT_FALSE(rfft(x.data(), 6, output.data(), scratch.data()));
+}
+
 }
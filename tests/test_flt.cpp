@@ -0,0 +1,82 @@
+#include <random>
+#include "flt.h"
+#include "legendre.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+namespace
+{
+
+/**
+ * Matrix of the spharm normalized P_l^m(cos(theta)) for l in [m, m + rows), theta in (0, pi/2]
+ */
+std::vector<real_t> legendre_matrix(const natural_t m, const natural_t rows, const natural_t cols)
+{
+  std::vector<real_t> values(rows * cols);
+  for (natural_t col = 0; col < cols; ++col)
+  {
+    const real_t theta = (M_PI / 2.0) * static_cast<real_t>(col + 1) / static_cast<real_t>(cols);
+    const auto plm = LegendrePoly::get_sph_norm_array(m + rows, std::cos(theta));
+    for (natural_t row = 0; row < rows; ++row)
+    {
+      values[(row * cols) + col] = plm.get(m + row, m);
+    }
+  }
+  return values;
+}
+
+}
+
+TEST(CompressedLegendreMatrix, ApplyMatchesDense)
+{
+  const natural_t rows = 300;
+  const natural_t cols = 250;
+  const natural_t batch = 3;
+  const auto values = legendre_matrix(5, rows, cols);
+  const CompressedLegendreMatrix compressed(values.data(), rows, cols, 1e-12);
+  EXPECT_EQ(compressed.rows(), rows);
+  EXPECT_EQ(compressed.cols(), cols);
+  EXPECT_LT(compressed.cost(), rows * cols);
+
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<real_t> dis(-1.0, 1.0);
+  std::vector<complex_t> x(cols * batch), y(rows * batch);
+  for (auto& value : x) { value = {dis(gen), dis(gen)}; }
+  for (auto& value : y) { value = {dis(gen), dis(gen)}; }
+
+  std::vector<complex_t> ax(rows * batch), aty(cols * batch);
+  compressed.apply(x.data(), ax.data(), batch);
+  compressed.apply_transpose(y.data(), aty.data(), batch);
+
+  for (natural_t row = 0; row < rows; ++row)
+  {
+    for (natural_t i = 0; i < batch; ++i)
+    {
+      complex_t expected = {0, 0};
+      for (natural_t col = 0; col < cols; ++col)
+      {
+        expected += values[(row * cols) + col] * x[(col * batch) + i];
+      }
+      EXPECT_NEAR(std::abs(ax[(row * batch) + i] - expected), 0.0, 1e-9);
+    }
+  }
+  for (natural_t col = 0; col < cols; ++col)
+  {
+    for (natural_t i = 0; i < batch; ++i)
+    {
+      complex_t expected = {0, 0};
+      for (natural_t row = 0; row < rows; ++row)
+      {
+        expected += values[(row * cols) + col] * y[(row * batch) + i];
+      }
+      EXPECT_NEAR(std::abs(aty[(col * batch) + i] - expected), 0.0, 1e-9);
+    }
+  }
+}
+
+TEST(CompressedLegendreMatrix, Empty)
+{
+  const CompressedLegendreMatrix compressed(nullptr, 0, 10, 1e-12);
+  EXPECT_EQ(compressed.cost(), 0u);
+}
@@ -0,0 +1,57 @@
+/**
+ * @file test_helpers.h
+ * @author Sylvaus
+ * @date Mon Oct 19 2026
+ * @brief
+ *
+ * Spherical harmonics shared by the tests
+ */
+#pragma once
+
+#include <random>
+#include <cmath>
+#include "legendre.h"
+#include "spharms.h"
+
+namespace hyperspharm
+{
+
+/**
+ * Returns coefficients up to l_max drawn uniformly in [-1, 1] (f_l0 real, as for a real function)
+ */
+inline SphericalHarmonics get_random_harmonics(const natural_t l_max, const unsigned seed)
+{
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<> dis(-1.0, 1.0);
+  SphericalHarmonics harmonics(l_max);
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    harmonics.set(l, 0, {dis(gen), 0.0});
+    for (natural_t m = 1; m <= l; ++m)
+    {
+      harmonics.set(l, m, {dis(gen), dis(gen)});
+    }
+  }
+  return harmonics;
+}
+
+/**
+ * Returns the value at (theta, psi) of the real function described by the coefficients, summed directly
+ */
+inline real_t get_direct_value(const SphericalHarmonics& harmonics, const real_t theta, const real_t psi)
+{
+  real_t value = 0;
+  for (natural_t l = 0; l <= harmonics.l_max(); ++l)
+  {
+    value += harmonics.get(l, 0).real() * LegendrePoly::get_spharm_normalized(l, 0, std::cos(theta));
+    for (natural_t m = 1; m <= l; ++m)
+    {
+      const complex_t ylm = LegendrePoly::get_spharm_normalized(l, static_cast<integer_t>(m), std::cos(theta)) *
+                            std::exp(complex_t(0, static_cast<real_t>(m) * psi));
+      value += 2.0 * (harmonics.get(l, m) * ylm).real();
+    }
+  }
+  return value;
+}
+
+}
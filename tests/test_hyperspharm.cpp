@@ -2,3 +2,288 @@
 // Created by silvos on 24.08.18.
 //
 
+#include <fstream>
+#include <random>
+#include "hyperspharm.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+namespace
+{
+
+/**
+ * Adds Re(Z_nlm) (m > 0) or Z_nl0 scaled by amplitude to the surface
+ */
+void add_hyperspharm(HyperSphericalSurface& surface, const natural_t n, const natural_t l, const natural_t m,
+                     const real_t amplitude)
+{
+  const auto betas = surface.thetas();
+  const auto thetas = surface.psis();
+  const auto phis = surface.phis();
+  for (natural_t beta_i = 0; beta_i < surface.theta_nb(); ++beta_i)
+  {
+    const real_t radial = std::pow(std::sin(betas[beta_i]), static_cast<real_t>(l)) *
+                          GegenbauerPoly::get_normalized(n - l, l + 1, std::cos(betas[beta_i]));
+    for (natural_t theta_i = 0; theta_i < surface.psi_nb(); ++theta_i)
+    {
+      const real_t plm = LegendrePoly::get_spharm_normalized(l, m, std::cos(thetas[theta_i]));
+      for (natural_t phi_i = 0; phi_i < surface.phi_nb(); ++phi_i)
+      {
+        surface.set(beta_i, theta_i, phi_i, surface.get(beta_i, theta_i, phi_i) +
+                                            amplitude * radial * plm * std::cos(static_cast<real_t>(m) * phis[phi_i]));
+      }
+    }
+  }
+}
+
+}
+
+TEST(HyperSpharm, Grids)
+{
+  const HyperSphericalSurface surface(7, 8, 16, GridType::GaussLegendre);
+  const auto betas = surface.thetas();
+  ASSERT_EQ(betas.size(), 7u);
+  for (natural_t beta_i = 0; beta_i < betas.size(); ++beta_i)
+  {
+    EXPECT_NEAR(betas[beta_i] + betas[betas.size() - 1 - beta_i], M_PI, 1e-12);
+  }
+  EXPECT_EQ(surface.psis().size(), 8u);
+  ASSERT_EQ(surface.phis().size(), 16u);
+  EXPECT_DOUBLE_EQ(surface.phis()[4], M_PI / 2.0);
+}
+
+TEST(HyperSpharm, SliceView)
+{
+  HyperSphericalSurface surface(3, 4, 8, 0.0, GridType::GaussLegendre);
+  surface.values()[surface.get_index(2, 1, 5)] = 3.0;
+  const auto slice = surface.slice(2);
+  EXPECT_EQ(slice.rows(), 4u);
+  EXPECT_EQ(slice.cols(), 8u);
+  EXPECT_EQ(slice.grid(), GridType::GaussLegendre);
+  EXPECT_EQ(slice.data(), surface.values().data() + surface.get_index(2, 0, 0));
+  EXPECT_EQ(slice.get(1, 5), 3.0);
+}
+
+TEST(HyperSpharm, ForwardTransform)
+{
+  const natural_t size = 12;
+  HyperSphericalSurface surface(size, 32, 32, 0.0);
+  add_hyperspharm(surface, 0, 0, 0, 1.0);
+  add_hyperspharm(surface, 3, 2, 1, 2.0);
+  add_hyperspharm(surface, 7, 4, 4, -1.0);
+  add_hyperspharm(surface, 11, 11, 3, 0.5);
+  add_hyperspharm(surface, 6, 1, 0, 1.5);
+
+  const auto result = HyperSpharm::transform(surface);
+  ASSERT_EQ(result.n_max(), size);
+  EXPECT_EQ(result.layout(), CoeffsLayout::Tetrahedral);
+  for (natural_t n = 0; n < size; ++n)
+  {
+    for (natural_t l = 0; l <= n; ++l)
+    {
+      for (natural_t m = 0; m <= l; ++m)
+      {
+        real_t expected = 0;
+        if ((n == 0) && (l == 0) && (m == 0)) { expected = 1.0; }
+        if ((n == 3) && (l == 2) && (m == 1)) { expected = 1.0; }
+        if ((n == 7) && (l == 4) && (m == 4)) { expected = -0.5; }
+        if ((n == 11) && (l == 11) && (m == 3)) { expected = 0.25; }
+        if ((n == 6) && (l == 1) && (m == 0)) { expected = 1.5; }
+        EXPECT_NEAR(result.get(n, l, m).real(), expected, 1e-10) << "n: " << n << ", l: " << l << ", m: " << m;
+        EXPECT_NEAR(result.get(n, l, m).imag(), 0.0, 1e-10) << "n: " << n << ", l: " << l << ", m: " << m;
+      }
+    }
+  }
+}
+
+TEST(HyperSpharm, InverseRoundTrip)
+{
+  const natural_t n_max = 10;
+  HyperSphericalCoeffs coeffs(n_max, n_max, n_max);
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<real_t> dis(-1.0, 1.0);
+  for (natural_t n = 0; n < n_max; ++n)
+  {
+    for (natural_t l = 0; l <= n; ++l)
+    {
+      coeffs.set(n, l, 0, {dis(gen), 0.0});
+      for (natural_t m = 1; m <= l; ++m)
+      {
+        coeffs.set(n, l, m, {dis(gen), dis(gen)});
+      }
+    }
+  }
+
+  const auto surface = HyperSpharm::transform(coeffs);
+  EXPECT_EQ(surface.theta_nb(), n_max);
+  EXPECT_EQ(surface.psi_nb(), 32u);
+  EXPECT_EQ(surface.phi_nb(), 32u);
+
+  const auto result = HyperSpharm::transform(surface);
+  for (natural_t n = 0; n < n_max; ++n)
+  {
+    for (natural_t l = 0; l <= n; ++l)
+    {
+      for (natural_t m = 0; m <= l; ++m)
+      {
+        EXPECT_NEAR(std::abs(result.get(n, l, m) - coeffs.get(n, l, m)), 0.0, 1e-10)
+          << "n: " << n << ", l: " << l << ", m: " << m;
+      }
+    }
+  }
+}
+
+TEST(HyperSpharm, Plan)
+{
+  const natural_t n_max = 9;
+  const HyperSpharmPlan plan(n_max, 16, 16, n_max, GridType::GaussLegendre);
+  EXPECT_EQ(plan.l_nb(), n_max);
+  EXPECT_EQ(plan.m_nb(), n_max);
+  ASSERT_EQ(plan.betas().size(), n_max);
+  ASSERT_EQ(plan.beta_weights().size(), n_max);
+  ASSERT_EQ(plan.half_theta_nb(), 5u);
+  for (natural_t l = 0; l < n_max; ++l)
+  {
+    for (natural_t n = l; n < n_max; ++n)
+    {
+      const real_t* gegenbauer = plan.gegenbauer(l, n);
+      for (natural_t beta_i = 0; beta_i < plan.half_theta_nb(); ++beta_i)
+      {
+        for (const auto mirror_i : {beta_i, n_max - 1 - beta_i})
+        {
+          const real_t beta = plan.betas()[mirror_i];
+          const real_t sign = (mirror_i == beta_i) ? 1.0 : minus_one_power(n - l);
+          EXPECT_NEAR(sign * gegenbauer[beta_i], std::pow(std::sin(beta), static_cast<real_t>(l)) *
+                                                 GegenbauerPoly::get_normalized(n - l, l + 1, std::cos(beta)), 1e-12);
+        }
+      }
+    }
+  }
+
+  // Transforms sharing the plan
+  HyperSphericalSurface surface(n_max, 16, 16, 0.0, GridType::GaussLegendre);
+  add_hyperspharm(surface, 5, 3, 2, 1.0);
+  for (natural_t i = 0; i < 2; ++i)
+  {
+    const auto coeffs = HyperSpharm::transform(plan, surface);
+    EXPECT_NEAR(coeffs.get(5, 3, 2).real(), 0.5, 1e-10);
+    const auto synthesis = HyperSpharm::transform(plan, coeffs);
+    for (natural_t index = 0; index < surface.values().size(); ++index)
+    {
+      EXPECT_NEAR(synthesis.values()[index], surface.values()[index], 1e-10);
+    }
+  }
+
+  const HyperSphericalSurface wrong_surface(n_max, 16, 16);
+  EXPECT_THROW(HyperSpharm::transform(plan, wrong_surface), std::invalid_argument);
+}
+
+TEST(HyperSpharm, OutOfCoreTransform)
+{
+  const natural_t n_max = 11;
+  const HyperSpharmPlan plan(n_max, 32, 32, n_max);
+  HyperSphericalSurface surface(n_max, 32, 32, 0.0);
+  add_hyperspharm(surface, 4, 2, 1, 1.0);
+  add_hyperspharm(surface, 10, 7, 5, -2.0);
+  add_hyperspharm(surface, 9, 0, 0, 0.5);
+
+  // Header of 64 bytes followed by the raw values
+  const std::string path = ::testing::TempDir() + "hyperspharm_out_of_core.bin";
+  const natural_t offset = 64;
+  {
+    std::ofstream stream(path, std::ios::binary);
+    const std::vector<char> header(offset, 0);
+    stream.write(header.data(), offset);
+    stream.write(reinterpret_cast<const char*>(surface.values().data()),
+                 surface.values().size() * sizeof(real_t));
+  }
+  const MappedFile file(path);
+  const auto expected = HyperSpharm::transform(plan, surface);
+  // Whole surface in one slab, then one slab per hyperangle
+  for (const natural_t memory_budget : {natural_t(1) << 30, natural_t(1)})
+  {
+    const auto result = HyperSpharm::transform(plan, file, offset, memory_budget);
+    for (auto it = expected.begin(); it != expected.end(); ++it)
+    {
+      EXPECT_NEAR(std::abs(result.get(it.n(), it.l(), it.m()) - *it), 0.0, 1e-12)
+        << "n: " << it.n() << ", l: " << it.l() << ", m: " << it.m();
+    }
+  }
+
+  EXPECT_THROW(HyperSpharm::transform(plan, file, offset + 8, 1), std::invalid_argument);
+  EXPECT_THROW(HyperSpharm::transform(plan, file, 4, 1), std::invalid_argument);
+  EXPECT_THROW(MappedFile(path + ".missing"), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST(HyperSpharm, Descriptors)
+{
+  const natural_t n_max = 8;
+  const HyperSpharmPlan plan(n_max, 16, 16, n_max);
+  ASSERT_EQ(HyperSpharm::descriptor_size(plan), (n_max * (n_max + 1)) / 2);
+
+  // More shapes than a descriptor block
+  std::vector<HyperSphericalSurface> surfaces(10, HyperSphericalSurface(n_max, 16, 16, 0.0));
+  for (natural_t shape_i = 0; shape_i < surfaces.size(); ++shape_i)
+  {
+    add_hyperspharm(surfaces[shape_i], 0, 0, 0, 1.0 + shape_i);
+    add_hyperspharm(surfaces[shape_i], 5, 3, shape_i % 4, 0.5);
+    add_hyperspharm(surfaces[shape_i], 7, 6, 0, -0.25 * shape_i);
+  }
+
+  const natural_t size = HyperSpharm::descriptor_size(plan);
+  std::vector<float> descriptors(surfaces.size() * size);
+  HyperSpharm::descriptors_batch(plan, surfaces.data(), surfaces.size(), descriptors.data());
+  for (natural_t shape_i = 0; shape_i < surfaces.size(); ++shape_i)
+  {
+    const auto coeffs = HyperSpharm::transform(plan, surfaces[shape_i]);
+    const auto single = HyperSpharm::descriptors(plan, surfaces[shape_i]);
+    for (natural_t n = 0; n < n_max; ++n)
+    {
+      for (natural_t l = 0; l <= n; ++l)
+      {
+        real_t energy = std::norm(coeffs.get(n, l, 0));
+        for (natural_t m = 1; m <= l; ++m)
+        {
+          energy += 2.0 * std::norm(coeffs.get(n, l, m));
+        }
+        const natural_t index = HyperSpharm::descriptor_index(n, l);
+        EXPECT_NEAR(descriptors[(shape_i * size) + index], energy, 1e-4 * (1.0 + energy))
+          << "shape: " << shape_i << ", n: " << n << ", l: " << l;
+        EXPECT_EQ(single[index], descriptors[(shape_i * size) + index]);
+      }
+    }
+  }
+
+  EXPECT_THROW(HyperSpharm::descriptors(plan, HyperSphericalSurface(n_max, 8, 16)), std::invalid_argument);
+}
+
+TEST(HyperSpharm, DescriptorsCoarsePsiGrid)
+{
+  // psi_nb < n_max: the degrees l >= plan.l_nb() are not computed and their energies are 0
+  const natural_t n_max = 16;
+  const HyperSpharmPlan plan(n_max, 8, 16, n_max);
+  ASSERT_LT(plan.l_nb(), n_max);
+  HyperSphericalSurface surface(n_max, 8, 16, 0.0);
+  add_hyperspharm(surface, 0, 0, 0, 1.0);
+  add_hyperspharm(surface, 6, 2, 1, 0.5);
+
+  const natural_t size = HyperSpharm::descriptor_size(plan);
+  std::vector<float> descriptors(size, -1.0f);
+  HyperSpharm::descriptors_batch(plan, &surface, 1, descriptors.data());
+  const auto coeffs = HyperSpharm::transform(plan, surface);
+  for (natural_t n = 0; n < n_max; ++n)
+  {
+    for (natural_t l = 0; l <= n; ++l)
+    {
+      real_t energy = std::norm(coeffs.get(n, l, 0));
+      for (natural_t m = 1; m <= l; ++m)
+      {
+        energy += 2.0 * std::norm(coeffs.get(n, l, m));
+      }
+      EXPECT_NEAR(descriptors[HyperSpharm::descriptor_index(n, l)], energy, 1e-4 * (1.0 + energy))
+        << "n: " << n << ", l: " << l;
+    }
+  }
+}
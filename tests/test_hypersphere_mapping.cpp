@@ -0,0 +1,87 @@
+#include <cmath>
+#include <vector>
+#include "hypersphere_mapping.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+TEST(HyperSphereMapping, TrilinearVolume)
+{
+  // Trilinear interpolation is exact for affine functions
+  const natural_t x_nb = 21, y_nb = 17, z_nb = 19;
+  std::vector<real_t> voxels(x_nb * y_nb * z_nb);
+  for (natural_t z = 0; z < z_nb; ++z)
+  {
+    for (natural_t y = 0; y < y_nb; ++y)
+    {
+      for (natural_t x = 0; x < x_nb; ++x)
+      {
+        voxels[(((z * y_nb) + y) * x_nb) + x] = 1.0 + (0.5 * x) - (0.25 * y) + (2.0 * z);
+      }
+    }
+  }
+  const VolumeView volume = {voxels.data(), x_nb, y_nb, z_nb};
+
+  HyperSphericalSurface surface(20, 12, 16, GridType::GaussLegendre);
+  HyperSphereMapping::map_volume(volume, surface);
+  const auto betas = surface.thetas();
+  const auto psis = surface.psis();
+  const auto phis = surface.phis();
+  const real_t radius = (y_nb - 1) / 2.0;
+  for (natural_t beta_i = 0; beta_i < surface.theta_nb(); ++beta_i)
+  {
+    const real_t r = radius * betas[beta_i] / M_PI;
+    for (natural_t psi_i = 0; psi_i < surface.psi_nb(); ++psi_i)
+    {
+      for (natural_t phi_i = 0; phi_i < surface.phi_nb(); ++phi_i)
+      {
+        const real_t x = ((x_nb - 1) / 2.0) + (r * std::sin(psis[psi_i]) * std::cos(phis[phi_i]));
+        const real_t y = ((y_nb - 1) / 2.0) + (r * std::sin(psis[psi_i]) * std::sin(phis[phi_i]));
+        const real_t z = ((z_nb - 1) / 2.0) + (r * std::cos(psis[psi_i]));
+        EXPECT_NEAR(surface.get(beta_i, psi_i, phi_i), 1.0 + (0.5 * x) - (0.25 * y) + (2.0 * z), 1e-10);
+      }
+    }
+  }
+
+  HyperSphereMapping::map_volume(volume, surface, Interpolation::Nearest);
+  EXPECT_EQ(surface.get(0, 0, 0), voxels[(((9 * y_nb) + 8) * x_nb) + 10]);
+
+  EXPECT_THROW(HyperSphereMapping::map_volume({voxels.data(), 0, y_nb, z_nb}, surface), std::invalid_argument);
+}
+
+TEST(HyperSphereMapping, PointBinning)
+{
+  HyperSphericalSurface surface(7, 8, 16, 0.0);
+  const auto betas = surface.thetas();
+  const auto psis = surface.psis();
+  const auto phis = surface.phis();
+  const real_t radius = 2.0;
+
+  // Points slightly off the samples (3, 2, 5) and (6, 7, 15), and one outside of the ball
+  std::vector<real_t> points;
+  const natural_t samples[3][3] = {{3, 2, 5}, {3, 2, 5}, {6, 7, 15}};
+  for (const auto& sample : samples)
+  {
+    const real_t r = radius * (betas[sample[0]] + 0.01) / M_PI;
+    const real_t psi = psis[sample[1]] - 0.01;
+    const real_t phi = phis[sample[2]] + 0.01;
+    points.push_back(r * std::sin(psi) * std::cos(phi));
+    points.push_back(r * std::sin(psi) * std::sin(phi));
+    points.push_back(r * std::cos(psi));
+  }
+  points.insert(points.end(), {0.0, 0.0, 2.5});
+
+  HyperSphereMapping::bin_points(points.data(), nullptr, 4, radius, surface);
+  EXPECT_EQ(surface.get(3, 2, 5), 2.0);
+  EXPECT_EQ(surface.get(6, 7, 15), 1.0);
+  real_t total = 0;
+  for (const auto value : surface.values()) { total += value; }
+  EXPECT_EQ(total, 3.0);
+
+  const std::vector<real_t> weights = {0.5, 0.25, 4.0, 1.0};
+  HyperSphereMapping::bin_points(points.data(), weights.data(), 4, radius, surface);
+  EXPECT_EQ(surface.get(3, 2, 5), 2.75);
+  EXPECT_EQ(surface.get(6, 7, 15), 5.0);
+
+  EXPECT_THROW(HyperSphereMapping::bin_points(points.data(), nullptr, 4, 0.0, surface), std::invalid_argument);
+}
@@ -85,3 +85,87 @@ TEST(HyperSphericalCoeffs, MapFuncRealNLMOldValue)
     }
   }
 }
+
+TEST(HyperSphericalCoeffs, TetrahedralLayout)
+{
+  const natural_t n_max = 17;
+  HyperSphericalCoeffs coeffs(n_max, CoeffsLayout::Tetrahedral);
+  EXPECT_EQ(coeffs.values().size(), (n_max * (n_max + 1) * (n_max + 2)) / 6);
+  EXPECT_EQ(coeffs.l_max(), n_max);
+  EXPECT_EQ(coeffs.m_max(), n_max);
+
+  // The iterators walk the packed storage in order
+  natural_t index = 0;
+  for (auto it = coeffs.begin(); it != coeffs.end(); ++it)
+  {
+    EXPECT_LE(it.l(), it.n());
+    EXPECT_LE(it.m(), it.l());
+    EXPECT_EQ(coeffs.get_index(it.n(), it.l(), it.m()), index);
+    *it = complex_t(static_cast<real_t>(it.n()), static_cast<real_t>((it.l() * n_max) + it.m()));
+    ++index;
+  }
+  EXPECT_EQ(index, coeffs.values().size());
+
+  for (natural_t n = 0; n < n_max; ++n)
+  {
+    for (natural_t l = 0; l < n_max; ++l)
+    {
+      for (natural_t m = 0; m < n_max; ++m)
+      {
+        const complex_t expected = ((l <= n) && (m <= l)) ?
+                                   complex_t(static_cast<real_t>(n), static_cast<real_t>((l * n_max) + m)) :
+                                   complex_t(0, 0);
+        EXPECT_EQ(expected, coeffs.get(n, l, m));
+      }
+    }
+  }
+  coeffs.set(2, 3, 1, {1.0, 1.0});
+  EXPECT_EQ(complex_t(0, 0), coeffs.get(2, 3, 1));
+}
+
+TEST(HyperSphericalCoeffs, TetrahedralMapFuncNLMOldValue)
+{
+  const natural_t n_max = 12;
+  HyperSphericalCoeffs coeffs(n_max, CoeffsLayout::Tetrahedral, complex_t(3.14, 1.7));
+  std::function<complex_t(natural_t, natural_t, natural_t, complex_t)> func =
+      [](natural_t ni, natural_t li, natural_t mi, complex_t old_val) {
+        return old_val * (ni * std::sqrt(li) / (mi + 1));
+      };
+  coeffs.map(func);
+  const HyperSphericalCoeffs& const_coeffs = coeffs;
+  natural_t count = 0;
+  for (auto it = const_coeffs.begin(); it != const_coeffs.end(); ++it)
+  {
+    EXPECT_EQ(complex_t(3.14, 1.7) * (it.n() * std::sqrt(it.l()) / (it.m() + 1)), *it);
+    ++count;
+  }
+  EXPECT_EQ(count, coeffs.values().size());
+}
+
+TEST(HyperSphericalCoeffs, ParallelMap)
+{
+  const natural_t n_max = 12;
+  const auto func = [](natural_t ni, natural_t li, natural_t mi, complex_t old_val) {
+    return old_val * (ni * std::sqrt(li) / (mi + 1));
+  };
+
+  HyperSphericalCoeffs tetrahedral(n_max, CoeffsLayout::Tetrahedral, complex_t(3.14, 1.7));
+  tetrahedral.parallel_map(func);
+  for (auto it = tetrahedral.begin(); it != tetrahedral.end(); ++it)
+  {
+    EXPECT_EQ(complex_t(3.14, 1.7) * (it.n() * std::sqrt(it.l()) / (it.m() + 1)), *it);
+  }
+
+  HyperSphericalCoeffs cube(n_max, 7, 5, complex_t(3.14, 1.7));
+  cube.parallel_map(func);
+  for (natural_t ni = 0; ni < cube.n_max(); ++ni)
+  {
+    for (natural_t li = 0; li < cube.l_max(); ++li)
+    {
+      for (natural_t mi = 0; mi < cube.m_max(); ++mi)
+      {
+        EXPECT_EQ(complex_t(3.14, 1.7) * (ni * std::sqrt(li) / (mi + 1)), cube.get(ni, li, mi));
+      }
+    }
+  }
+}
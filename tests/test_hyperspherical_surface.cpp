@@ -87,3 +87,24 @@ TEST(HyperSphericalSurface, MapFuncRealNLMOldValue)
   }
 }
 
+TEST(HyperSphericalSurface, ParallelMapAngles)
+{
+  HyperSphericalSurface surface(12, 16, 32, 2.0);
+  surface.parallel_map([](const real_t theta, const real_t psi, const real_t phi, const real_t old_val) {
+    return old_val * std::sin(theta) * std::cos(psi) * std::cos(phi);
+  });
+
+  const auto thetas = surface.thetas();
+  const auto psis = surface.psis();
+  const auto phis = surface.phis();
+  for (natural_t i = 0; i < surface.theta_nb(); ++i)
+  {
+    for (natural_t j = 0; j < surface.psi_nb(); ++j)
+    {
+      for (natural_t k = 0; k < surface.phi_nb(); ++k)
+      {
+        EXPECT_DOUBLE_EQ(surface.get(i, j, k), 2.0 * std::sin(thetas[i]) * std::cos(psis[j]) * std::cos(phis[k]));
+      }
+    }
+  }
+}
@@ -87,5 +87,24 @@ TEST(SpharmNormalizedAssociatedLegendreArray, NegativeX) // l!=m
 
   delete[] gsl_results;
 }
+
+TEST(SpharmNormalizedAssociatedLegendreArray, SingleOrder)
+{
+  // The values of a single order are the ones of the whole table
+  const hyperspharm::natural_t l_max = 200;
+  for (const hyperspharm::real_t x : {-0.7, 0.0, 0.3})
+  {
+    const auto array = LegendrePoly::get_sph_norm_array(l_max, x);
+    std::vector<hyperspharm::real_t> order(l_max + 1);
+    for (hyperspharm::natural_t m = 0; m <= l_max; ++m)
+    {
+      LegendrePoly::get_norm_order(LegendrePoly::SPHARM_NORM, l_max, m, x, order.data());
+      for (hyperspharm::natural_t l = m; l <= l_max; ++l)
+      {
+        EXPECT_EQ(order[l - m], array.unsafe_get(l, m));
+      }
+    }
+  }
+}
   
 }
@@ -0,0 +1,105 @@
+#include "quadrature.h"
+#include "legendre.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+namespace
+{
+
+/**
+ * Checks that the rule integrates P_l(cos(theta)) sin(theta) exactly for l <= l_max
+ */
+void check_legendre_integrals(const QuadratureRule& rule, const natural_t l_max)
+{
+  ASSERT_EQ(rule.thetas.size(), rule.weights.size());
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    real_t sum = 0;
+    for (natural_t k = 0; k < rule.thetas.size(); ++k)
+    {
+      sum += rule.weights[k] * LegendrePoly::get(l, std::cos(rule.thetas[k]));
+    }
+    EXPECT_NEAR(sum, (l == 0) ? 2.0 : 0.0, 1e-12) << "l: " << l;
+  }
+}
+
+}
+
+TEST(Quadrature, EquiangularExactness)
+{
+  check_legendre_integrals(Quadrature::equiangular(64), 63);
+  check_legendre_integrals(Quadrature::equiangular(48), 47);
+}
+
+TEST(Quadrature, EquiangularFastWeights)
+{
+  const natural_t n = 128;
+  const auto rule = Quadrature::equiangular(n);
+  for (natural_t k = 0; k < n; ++k)
+  {
+    const real_t theta = M_PI * static_cast<real_t>(k) / static_cast<real_t>(n);
+    real_t sum = 0;
+    for (natural_t l = 0; l < n / 2; ++l)
+    {
+      sum += std::sin((2.0 * l + 1.0) * theta) / (2.0 * l + 1.0);
+    }
+    EXPECT_NEAR(rule.thetas[k], theta, 1e-14);
+    EXPECT_NEAR(rule.weights[k], sum * 4.0 * std::sin(theta) / static_cast<real_t>(n), 1e-14);
+  }
+}
+
+TEST(Quadrature, ClenshawCurtisExactness)
+{
+  check_legendre_integrals(Quadrature::clenshaw_curtis(33), 32);
+  check_legendre_integrals(Quadrature::clenshaw_curtis(30), 29);
+  EXPECT_THROW(Quadrature::clenshaw_curtis(1), std::invalid_argument);
+}
+
+TEST(Quadrature, GaussLegendreExactness)
+{
+  check_legendre_integrals(Quadrature::gauss_legendre(1), 1);
+  check_legendre_integrals(Quadrature::gauss_legendre(20), 39);
+  check_legendre_integrals(Quadrature::gauss_legendre(33), 65);
+
+  const auto rule = Quadrature::gauss_legendre(33);
+  for (natural_t k = 1; k < rule.thetas.size(); ++k)
+  {
+    EXPECT_LT(rule.thetas[k - 1], rule.thetas[k]);
+  }
+  EXPECT_THROW(Quadrature::gauss_legendre(0), std::invalid_argument);
+}
+
+TEST(Quadrature, GaussChebyshevExactness)
+{
+  const natural_t n = 24;
+  const auto rule = Quadrature::gauss_chebyshev(n);
+  ASSERT_EQ(rule.thetas.size(), n);
+  // \int_0^\pi cos^j(beta) sin^2(beta) dbeta = pi * (j - 1)!! / (j + 2)!! for j even, 0 for j odd
+  real_t expected = M_PI / 2.0;
+  for (natural_t j = 0; j < 2 * n; ++j)
+  {
+    real_t sum = 0;
+    for (natural_t k = 0; k < n; ++k)
+    {
+      sum += rule.weights[k] * std::pow(std::cos(rule.thetas[k]), static_cast<real_t>(j));
+    }
+    EXPECT_NEAR(sum, is_even(j) ? expected : 0.0, 1e-12) << "j: " << j;
+    if (!is_even(j)) { expected *= static_cast<real_t>(j) / static_cast<real_t>(j + 3); }
+  }
+  EXPECT_THROW(Quadrature::gauss_chebyshev(0), std::invalid_argument);
+}
+
+TEST(Quadrature, GetThetas)
+{
+  for (auto type : {GridType::Equiangular, GridType::ClenshawCurtis, GridType::GaussLegendre})
+  {
+    const auto rule = Quadrature::get(type, 17);
+    const auto thetas = Quadrature::get_thetas(type, 17);
+    ASSERT_EQ(thetas.size(), rule.thetas.size());
+    for (natural_t k = 0; k < thetas.size(); ++k)
+    {
+      EXPECT_DOUBLE_EQ(thetas[k], rule.thetas[k]);
+    }
+  }
+}
@@ -0,0 +1,111 @@
+#include "rotation.h"
+#include "test_helpers.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+namespace
+{
+
+/** Angles of R^{-1} x with R = R_z(alpha) R_y(beta) R_z(gamma) */
+void rotate_back(const real_t alpha, const real_t beta, const real_t gamma, real_t& theta, real_t& psi)
+{
+  real_t x = std::sin(theta) * std::cos(psi);
+  real_t y = std::sin(theta) * std::sin(psi);
+  real_t z = std::cos(theta);
+  const auto rotate_z = [&](const real_t angle) {
+    const real_t rx = (std::cos(angle) * x) - (std::sin(angle) * y);
+    y = (std::sin(angle) * x) + (std::cos(angle) * y);
+    x = rx;
+  };
+  rotate_z(-alpha);
+  const real_t rz = (std::cos(beta) * z) + (std::sin(beta) * x);
+  x = (std::cos(beta) * x) - (std::sin(beta) * z);
+  z = rz;
+  rotate_z(-gamma);
+  theta = std::acos(std::max(-1.0, std::min(1.0, z)));
+  psi = std::atan2(y, x);
+}
+
+}
+
+TEST(WignerD, KnownValues)
+{
+  const real_t beta = 0.7;
+  const WignerD d(2, beta);
+  EXPECT_NEAR(d.get(0, 0, 0), 1.0, 1e-14);
+  EXPECT_NEAR(d.get(1, 0, 0), std::cos(beta), 1e-14);
+  EXPECT_NEAR(d.get(1, 1, 0), -std::sin(beta) / std::sqrt(2.0), 1e-14);
+  EXPECT_NEAR(d.get(1, 0, 1), std::sin(beta) / std::sqrt(2.0), 1e-14);
+  EXPECT_NEAR(d.get(1, 1, 1), (1 + std::cos(beta)) / 2.0, 1e-14);
+  EXPECT_NEAR(d.get(1, 1, -1), (1 - std::cos(beta)) / 2.0, 1e-14);
+  EXPECT_NEAR(d.get(2, 0, 0), ((3 * std::cos(beta) * std::cos(beta)) - 1) / 2.0, 1e-14);
+  EXPECT_NEAR(d.get(2, 2, 1), -std::sin(beta) * (1 + std::cos(beta)) / 2.0, 1e-14);
+}
+
+TEST(WignerD, Orthogonality)
+{
+  // The recurrence stays accurate at high degrees, including for beta close to the poles
+  for (const real_t beta : {1e-3, M_PI / 2.0, 2.5, M_PI})
+  {
+    const natural_t l_max = 128;
+    const auto d = WignerD::get(l_max, beta);
+    EXPECT_EQ(d, WignerD::get(l_max, beta));
+    for (const natural_t l : {natural_t(17), l_max})
+    {
+      const integer_t li = static_cast<integer_t>(l);
+      real_t max_error = 0;
+      for (integer_t m = -li; m <= li; m += 7)
+      {
+        for (integer_t m_prime = -li; m_prime <= li; m_prime += 5)
+        {
+          real_t product = 0;
+          for (integer_t k = -li; k <= li; ++k)
+          {
+            product += d->get(l, m, k) * d->get(l, m_prime, k);
+          }
+          max_error = std::max(max_error, std::abs(product - ((m == m_prime) ? 1.0 : 0.0)));
+        }
+      }
+      EXPECT_LT(max_error, 1e-10) << "beta " << beta << ", l " << l;
+    }
+  }
+}
+
+TEST(SpharmRotation, RotatedFunction)
+{
+  const natural_t l_max = 8;
+  const auto harmonics = get_random_harmonics(l_max, 11);
+  const real_t alpha = 0.4, beta = 1.1, gamma = -2.3;
+  for (const auto method : {RotationMethod::Direct, RotationMethod::QuarterTurns})
+  {
+    const auto rotated = SpharmRotation::rotate(harmonics, alpha, beta, gamma, method);
+    for (const real_t theta : {0.2, 1.0, 2.9})
+    {
+      for (const real_t psi : {0.0, 1.7, 4.0})
+      {
+        real_t back_theta = theta, back_psi = psi;
+        rotate_back(alpha, beta, gamma, back_theta, back_psi);
+        EXPECT_NEAR(get_direct_value(rotated, theta, psi), get_direct_value(harmonics, back_theta, back_psi), 1e-10);
+      }
+    }
+  }
+}
+
+TEST(SpharmRotation, Composition)
+{
+  const natural_t l_max = 20;
+  const auto harmonics = get_random_harmonics(l_max, 11);
+  // Rotations about z compose additively, and the inverse rotation restores the harmonics
+  const auto twice = SpharmRotation::rotate(SpharmRotation::rotate(harmonics, 0.3, 0.8, 0.0), 0.0, -0.8, -0.3,
+                                            RotationMethod::QuarterTurns);
+  const auto single = SpharmRotation::rotate(SphericalHarmonicsF(l_max), 1.0, 2.0, 3.0);
+  EXPECT_EQ(single.get(3, 2), std::complex<float>(0, 0));
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      EXPECT_NEAR(std::abs(twice.get(l, m) - harmonics.get(l, m)), 0.0, 1e-12);
+    }
+  }
+}
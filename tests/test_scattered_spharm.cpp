@@ -0,0 +1,181 @@
+#include <random>
+#include "scattered_spharm.h"
+#include "test_helpers.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+TEST(ScatteredSpharm, MatchesDirectSummation)
+{
+  const natural_t l_max = 24;
+  const auto harmonics = get_random_harmonics(l_max, 3);
+  std::mt19937 gen(4);
+  std::uniform_real_distribution<> theta_dis(0.0, M_PI);
+  std::uniform_real_distribution<> psi_dis(0.0, 2.0 * M_PI);
+  // Random points, points sharing latitudes and the poles
+  std::vector<real_t> thetas, psis;
+  for (natural_t i = 0; i < 100; ++i)
+  {
+    thetas.push_back(theta_dis(gen));
+    psis.push_back(psi_dis(gen));
+  }
+  for (const real_t theta : {0.0, 0.7, M_PI})
+  {
+    for (natural_t i = 0; i < 5; ++i)
+    {
+      thetas.push_back(theta);
+      psis.push_back(psi_dis(gen));
+    }
+  }
+
+  const auto values = ScatteredSpharm::evaluate(harmonics, thetas, psis);
+  ASSERT_EQ(values.size(), thetas.size());
+  for (natural_t i = 0; i < thetas.size(); ++i)
+  {
+    EXPECT_NEAR(values[i], get_direct_value(harmonics, thetas[i], psis[i]), 1e-10) << i;
+  }
+}
+
+TEST(ScatteredSpharm, PlanGroupsLatitudes)
+{
+  const std::vector<real_t> thetas = {2.0, 1.0, 2.0, 0.5, 1.0};
+  const std::vector<real_t> psis = {0.1, 0.2, 0.3, 0.4, 0.5};
+  const ScatteredSpharmPlan plan(thetas.data(), psis.data(), thetas.size(), 4);
+  ASSERT_EQ(plan.count(), 5u);
+  ASSERT_EQ(plan.latitude_nb(), 3u);
+  EXPECT_EQ(plan.latitude_begin(0), 0u);
+  EXPECT_EQ(plan.latitude_begin(1), 1u);
+  EXPECT_EQ(plan.latitude_begin(2), 3u);
+  EXPECT_EQ(plan.latitude_begin(3), 5u);
+  EXPECT_DOUBLE_EQ(plan.latitude_cos(1), std::cos(1.0));
+  for (natural_t sorted_i = 0; sorted_i < plan.count(); ++sorted_i)
+  {
+    EXPECT_DOUBLE_EQ(plan.psi(sorted_i), psis[plan.point_index(sorted_i)]);
+  }
+}
+
+TEST(ScatteredSpharm, PlanReusedForLowerDegrees)
+{
+  const auto harmonics = get_random_harmonics(5, 5);
+  const std::vector<real_t> thetas = {0.3, 1.2, 2.9};
+  const std::vector<real_t> psis = {4.0, 0.5, 2.2};
+  const ScatteredSpharmPlan plan(thetas.data(), psis.data(), thetas.size(), 10);
+  std::vector<real_t> values(thetas.size());
+  ScatteredSpharm::evaluate(plan, harmonics, values.data());
+  for (natural_t i = 0; i < thetas.size(); ++i)
+  {
+    EXPECT_NEAR(values[i], get_direct_value(harmonics, thetas[i], psis[i]), 1e-12);
+  }
+}
+
+TEST(ScatteredSpharm, MismatchedSizes)
+{
+  const auto harmonics = get_random_harmonics(2, 6);
+  EXPECT_THROW(ScatteredSpharm::evaluate(harmonics, {0.1, 0.2}, {0.3}), std::invalid_argument);
+}
+
+TEST(ScatteredSpharm, AdjointMatchesInnerProducts)
+{
+  const natural_t l_max = 12;
+  const auto harmonics = get_random_harmonics(l_max, 7);
+  std::mt19937 gen(8);
+  std::uniform_real_distribution<> theta_dis(0.0, M_PI);
+  std::uniform_real_distribution<> psi_dis(0.0, 2.0 * M_PI);
+  std::uniform_real_distribution<> value_dis(-1.0, 1.0);
+  std::vector<real_t> thetas, psis, values;
+  for (natural_t i = 0; i < 300; ++i)
+  {
+    // Every third point shares the latitude of the previous one
+    thetas.push_back(((i % 3) == 2) ? thetas.back() : theta_dis(gen));
+    psis.push_back(psi_dis(gen));
+    values.push_back(value_dis(gen));
+  }
+  const ScatteredSpharmPlan plan(thetas.data(), psis.data(), thetas.size(), l_max);
+
+  // <A f, v> = <f, A^T v> on the real parameters of f
+  std::vector<real_t> evaluated(plan.count());
+  ScatteredSpharm::evaluate(plan, harmonics, evaluated.data());
+  real_t samples_product = 0;
+  for (natural_t i = 0; i < values.size(); ++i) { samples_product += evaluated[i] * values[i]; }
+  const auto adjoint = ScatteredSpharm::adjoint(plan, values.data());
+  real_t coefficients_product = 0;
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    EXPECT_DOUBLE_EQ(adjoint.get(l, 0).imag(), 0.0);
+    coefficients_product += harmonics.get(l, 0).real() * adjoint.get(l, 0).real();
+    for (natural_t m = 1; m <= l; ++m)
+    {
+      coefficients_product += (harmonics.get(l, m) * std::conj(adjoint.get(l, m))).real();
+    }
+  }
+  EXPECT_NEAR(samples_product, coefficients_product, 1e-10 * std::abs(samples_product));
+}
+
+TEST(ScatteredSpharm, FitRecoversBandLimitedFunction)
+{
+  const natural_t l_max = 16;
+  const auto harmonics = get_random_harmonics(l_max, 9);
+  std::mt19937 gen(10);
+  std::uniform_real_distribution<> cos_dis(-1.0, 1.0);
+  std::uniform_real_distribution<> psi_dis(0.0, 2.0 * M_PI);
+  std::vector<real_t> thetas, psis;
+  for (natural_t i = 0; i < (4 * (l_max + 1) * (l_max + 1)); ++i)
+  {
+    thetas.push_back(std::acos(cos_dis(gen)));
+    psis.push_back(psi_dis(gen));
+  }
+  const auto values = ScatteredSpharm::evaluate(harmonics, thetas, psis);
+
+  const auto fitted = ScatteredSpharm::fit(thetas, psis, values, l_max);
+  ASSERT_EQ(fitted.l_max(), l_max);
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    EXPECT_NEAR(fitted.get(l, 0).real(), harmonics.get(l, 0).real(), 1e-7);
+    for (natural_t m = 1; m <= l; ++m)
+    {
+      EXPECT_NEAR(fitted.get(l, m).real(), harmonics.get(l, m).real(), 1e-7);
+      EXPECT_NEAR(fitted.get(l, m).imag(), harmonics.get(l, m).imag(), 1e-7);
+    }
+  }
+}
+
+TEST(ScatteredSpharm, FitRegularization)
+{
+  const natural_t l_max = 10;
+  const auto harmonics = get_random_harmonics(l_max, 11);
+  std::mt19937 gen(12);
+  std::uniform_real_distribution<> cos_dis(-1.0, 1.0);
+  std::uniform_real_distribution<> psi_dis(0.0, 2.0 * M_PI);
+  // Fewer samples than parameters: only the regularized problem has a unique solution
+  std::vector<real_t> thetas, psis;
+  for (natural_t i = 0; i < 60; ++i)
+  {
+    thetas.push_back(std::acos(cos_dis(gen)));
+    psis.push_back(psi_dis(gen));
+  }
+  const auto values = ScatteredSpharm::evaluate(harmonics, thetas, psis);
+  const ScatteredSpharmPlan plan(thetas.data(), psis.data(), thetas.size(), l_max);
+
+  const auto get_norm = [l_max](const SphericalHarmonics& f) {
+    real_t norm = 0;
+    for (natural_t l = 0; l <= l_max; ++l)
+    {
+      norm += std::norm(f.get(l, 0));
+      for (natural_t m = 1; m <= l; ++m) { norm += 2.0 * std::norm(f.get(l, m)); }
+    }
+    return norm;
+  };
+  const auto weak = ScatteredSpharm::fit(plan, values.data(), 1e-6);
+  const auto strong = ScatteredSpharm::fit(plan, values.data(), 1.0);
+  EXPECT_LT(get_norm(strong), get_norm(weak));
+
+  // The weakly regularized fit interpolates the samples
+  std::vector<real_t> evaluated(plan.count());
+  ScatteredSpharm::evaluate(plan, weak, evaluated.data());
+  for (natural_t i = 0; i < values.size(); ++i)
+  {
+    EXPECT_NEAR(evaluated[i], values[i], 1e-3);
+  }
+  EXPECT_THROW(ScatteredSpharm::fit(plan, values.data(), -1.0), std::invalid_argument);
+  EXPECT_THROW(ScatteredSpharm::fit(thetas, psis, {1.0}, l_max), std::invalid_argument);
+}
@@ -0,0 +1,152 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include "serialization.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+TEST(Serialization, SphericalSurface)
+{
+  const std::string path = ::testing::TempDir() + "serialization_surface.bin";
+  SphericalSurfaceF surface(8, 16, GridType::GaussLegendre);
+  surface.map([](const natural_t theta_n, const natural_t psi_m, const float) {
+    return static_cast<float>((100 * theta_n) + psi_m);
+  });
+  BinaryFile::save(path, surface);
+
+  const BinaryFile file(path);
+  EXPECT_EQ(file.type(), ContainerType::SphericalSurface);
+  EXPECT_EQ(file.scalar(), ScalarType::Float32);
+  EXPECT_EQ(file.file().size(), BinaryFile::HEADER_SIZE + (8 * 16 * sizeof(float)));
+  const auto view = file.spherical_surface<float>();
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(view.data()) % BinaryFile::PAYLOAD_ALIGNMENT, 0u);
+  EXPECT_EQ(view.rows(), 8u);
+  EXPECT_EQ(view.cols(), 16u);
+  EXPECT_EQ(view.grid(), GridType::GaussLegendre);
+  EXPECT_FLOAT_EQ(view.get(5, 11), 511.0f);
+
+  EXPECT_THROW(file.spherical_surface<double>(), std::runtime_error);
+  EXPECT_THROW(file.hyperspherical_surface(), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST(Serialization, SphericalHarmonics)
+{
+  const std::string path = ::testing::TempDir() + "serialization_harmonics.bin";
+  SphericalHarmonics harmonics(6);
+  for (natural_t l = 0; l <= 6; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      harmonics.set(l, m, {static_cast<real_t>(l), -static_cast<real_t>(m)});
+    }
+  }
+  BinaryFile::save(path, harmonics);
+
+  const BinaryFile file(path);
+  const auto view = file.spherical_harmonics<double>();
+  EXPECT_EQ(view.l_max(), 6u);
+  for (natural_t l = 0; l <= 6; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      EXPECT_EQ(view.get(l, m), harmonics.get(l, m));
+    }
+  }
+  EXPECT_EQ(view.get(7, 0), complex_t(0, 0));
+  std::remove(path.c_str());
+}
+
+TEST(Serialization, HyperSphericalSurface)
+{
+  const std::string path = ::testing::TempDir() + "serialization_hypersurface.bin";
+  const natural_t n_max = 6;
+  HyperSphericalSurface surface(n_max, 12, 16);
+  surface.parallel_map([](const real_t theta, const real_t psi, const real_t phi, const real_t) {
+    return std::cos(theta) + (std::sin(psi) * std::cos(phi));
+  });
+  BinaryFile::save(path, surface);
+
+  const BinaryFile file(path);
+  const auto view = file.hyperspherical_surface();
+  EXPECT_EQ(view.theta_nb(), n_max);
+  EXPECT_EQ(view.psi_nb(), 12u);
+  EXPECT_EQ(view.phi_nb(), 16u);
+  EXPECT_EQ(view.get(3, 7, 9), surface.get(3, 7, 9));
+  EXPECT_EQ(view.slice(4).get(2, 5), surface.get(4, 2, 5));
+
+  // The mapped values are transformed in place, in core or streamed
+  const HyperSpharmPlan plan(n_max, 12, 16, n_max);
+  const auto expected = HyperSpharm::transform(plan, surface);
+  const auto result = HyperSpharm::transform(plan, view);
+  const auto streamed = HyperSpharm::transform(plan, file.file(), file.payload_offset(), 1);
+  for (auto it = expected.begin(); it != expected.end(); ++it)
+  {
+    EXPECT_EQ(result.get(it.n(), it.l(), it.m()), *it);
+    EXPECT_NEAR(std::abs(streamed.get(it.n(), it.l(), it.m()) - *it), 0.0, 1e-12);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(Serialization, HyperSphericalCoeffs)
+{
+  const std::string path = ::testing::TempDir() + "serialization_coeffs.bin";
+  for (const auto layout : {CoeffsLayout::Tetrahedral, CoeffsLayout::Cube})
+  {
+    HyperSphericalCoeffs coeffs(5, layout);
+    coeffs.map([](const natural_t n, const natural_t l, const natural_t m, const complex_t) {
+      return complex_t(static_cast<real_t>(n), static_cast<real_t>((10 * l) + m));
+    });
+    BinaryFile::save(path, coeffs);
+
+    const BinaryFile file(path);
+    const auto view = file.hyperspherical_coeffs();
+    EXPECT_EQ(view.layout(), layout);
+    EXPECT_EQ(view.n_max(), 5u);
+    EXPECT_EQ(view.size(), coeffs.values().size());
+    for (auto it = coeffs.begin(); it != coeffs.end(); ++it)
+    {
+      EXPECT_EQ(view.get(it.n(), it.l(), it.m()), *it);
+    }
+  }
+  std::remove(path.c_str());
+}
+
+TEST(Serialization, InvalidFiles)
+{
+  const std::string path = ::testing::TempDir() + "serialization_invalid.bin";
+  EXPECT_THROW(BinaryFile(path + ".missing"), std::runtime_error);
+  {
+    std::ofstream stream(path, std::ios::binary);
+    stream << "not a binary file";
+  }
+  EXPECT_THROW(BinaryFile{path}, std::runtime_error);
+
+  // Truncated payload
+  BinaryFile::save(path, SphericalSurface(4, 4, 1.0));
+  {
+    std::ifstream input(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 8));
+  }
+  EXPECT_THROW(BinaryFile{path}, std::runtime_error);
+
+  // Dimensions whose product overflows: 2^22 x 2^21 x 2^21 values would wrap to an empty payload
+  BinaryFile::save(path, HyperSphericalSurface(2, 2, 2));
+  {
+    std::ifstream input(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    BinaryFile::store(bytes.data() + 16, natural_t(1) << 22, 8);
+    BinaryFile::store(bytes.data() + 24, natural_t(1) << 21, 8);
+    BinaryFile::store(bytes.data() + 32, natural_t(1) << 21, 8);
+    BinaryFile::store(bytes.data() + 48, 0, 8);
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  }
+  EXPECT_THROW(BinaryFile{path}, std::runtime_error);
+  std::remove(path.c_str());
+}
@@ -0,0 +1,49 @@
+#include "so3_correlation.h"
+#include "test_helpers.h"
+#include "gtest/gtest.h"
+
+using namespace hyperspharm;
+
+TEST(SO3Correlation, GridMatchesDirectCorrelation)
+{
+  const natural_t l_max = 6;
+  const auto f = get_random_harmonics(l_max, 1);
+  const auto g = get_random_harmonics(l_max, 2);
+  const natural_t size = SO3Correlation::get_grid_size(l_max);
+  EXPECT_EQ(size, 16u);
+  const auto grid = SO3Correlation::correlation_grid(f, g, l_max);
+  ASSERT_EQ(grid.size(), size * size * size);
+
+  const real_t step = (2.0 * M_PI) / static_cast<real_t>(size);
+  for (const natural_t a : {natural_t(0), natural_t(3), natural_t(11)})
+  {
+    for (const natural_t b : {natural_t(0), natural_t(5), natural_t(13)})
+    {
+      for (const natural_t c : {natural_t(2), natural_t(9)})
+      {
+        EXPECT_NEAR(grid[(((a * size) + b) * size) + c],
+                    SO3Correlation::correlation(f, g, step * a, step * b, step * c), 1e-10);
+      }
+    }
+  }
+}
+
+TEST(SO3Correlation, BestRotation)
+{
+  const natural_t l_max = 10;
+  const auto g = get_random_harmonics(l_max, 3);
+  const real_t alpha = 1.3, beta = 0.9, gamma = 4.2;
+  const auto f = SpharmRotation::rotate(g, alpha, beta, gamma);
+
+  const auto coarse = SO3Correlation::best_rotation(f, g, false);
+  const real_t step = (2.0 * M_PI) / static_cast<real_t>(SO3Correlation::get_grid_size(l_max));
+  EXPECT_NEAR(coarse.beta, beta, step);
+
+  const auto match = SO3Correlation::best_rotation(f, g);
+  EXPECT_NEAR(match.alpha, alpha, 1e-5);
+  EXPECT_NEAR(match.beta, beta, 1e-5);
+  EXPECT_NEAR(match.gamma, gamma, 1e-5);
+  EXPECT_GE(match.correlation, coarse.correlation);
+  // The aligned functions are equal: their correlation is the squared norm
+  EXPECT_NEAR(match.correlation, SO3Correlation::correlation(f, f, 0, 0, 0), 1e-8);
+}
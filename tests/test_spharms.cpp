@@ -1,4 +1,5 @@
 #include "spharms.h"
+#include "test_helpers.h"
 #include "gtest/gtest.h"
 
 using namespace hyperspharm;
@@ -20,3 +21,266 @@ TEST(Spharms, Order0)
   }
 }
 
+namespace
+{
+
+/**
+ * Fills the surface with Re(Y_l^m) (m > 0) or Y_l^0 scaled by amplitude and adds it to the previous values
+ */
+void add_spharm(SphericalSurface& surface, const natural_t l, const natural_t m, const real_t amplitude)
+{
+  const auto thetas = surface.thetas();
+  for (natural_t theta_n = 0; theta_n < surface.rows(); ++theta_n)
+  {
+    const real_t plm = LegendrePoly::get_spharm_normalized(l, m, std::cos(thetas[theta_n]));
+    for (natural_t psi_m = 0; psi_m < surface.cols(); ++psi_m)
+    {
+      const real_t psi = 2.0 * M_PI * static_cast<real_t>(psi_m) / static_cast<real_t>(surface.cols());
+      surface.set(theta_n, psi_m, surface.get(theta_n, psi_m) +
+                                  amplitude * plm * std::cos(static_cast<real_t>(m) * psi));
+    }
+  }
+}
+
+}
+
+TEST(Spharms, SingleHarmonics)
+{
+  const natural_t size = 64;
+  SphericalSurface surface(size, size, 0.0);
+  add_spharm(surface, 2, 1, 2.0);
+  add_spharm(surface, 4, 2, 1.0);
+  add_spharm(surface, 3, 0, 1.5);
+  auto result = Spharm::spharm_transform(surface);
+
+  for (natural_t l = 0; l < 16; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      complex_t expected = {0, 0};
+      if ((l == 2) && (m == 1)) { expected = 1.0; }
+      if ((l == 4) && (m == 2)) { expected = 0.5; }
+      if ((l == 3) && (m == 0)) { expected = 1.5; }
+      EXPECT_NEAR(result.get(l, m).real(), expected.real(), 1e-10) << "l: " << l << ", m: " << m;
+      EXPECT_NEAR(result.get(l, m).imag(), expected.imag(), 1e-10) << "l: " << l << ", m: " << m;
+    }
+  }
+}
+
+TEST(Spharms, BatchMatchesSingleTransforms)
+{
+  const natural_t size = 32;
+  const natural_t batch_size = 21;
+  std::vector<SphericalSurface> surfaces(batch_size, SphericalSurface(size, size, 0.0));
+  for (natural_t i = 0; i < batch_size; ++i)
+  {
+    add_spharm(surfaces[i], 2 + (i % 5), i % 3, 1.0 + static_cast<real_t>(i));
+    add_spharm(surfaces[i], 5, 4, 0.5);
+  }
+
+  std::vector<SphericalHarmonics> results(batch_size, SphericalHarmonics(0));
+  Spharm::spharm_transform_batch(surfaces.data(), batch_size, results.data());
+
+  for (natural_t i = 0; i < batch_size; ++i)
+  {
+    const auto expected = Spharm::spharm_transform(surfaces[i]);
+    ASSERT_EQ(expected.l_max(), results[i].l_max());
+    for (natural_t l = 0; l < expected.l_max(); ++l)
+    {
+      for (natural_t m = 0; m <= l; ++m)
+      {
+        EXPECT_NEAR(std::abs(expected.get(l, m) - results[i].get(l, m)), 0.0, 1e-12);
+      }
+    }
+  }
+}
+
+TEST(Spharms, BatchSizeMismatch)
+{
+  std::vector<SphericalSurface> surfaces = {SphericalSurface(16, 16), SphericalSurface(32, 32)};
+  std::vector<SphericalHarmonics> results(2, SphericalHarmonics(0));
+  EXPECT_THROW(Spharm::spharm_transform_batch(surfaces.data(), surfaces.size(), results.data()),
+               std::invalid_argument);
+}
+
+TEST(Spharms, InvalidColumns)
+{
+  // The fft along psi needs a power of two columns
+  EXPECT_THROW(SpharmPlan(16, 24), std::invalid_argument);
+  EXPECT_THROW(SpharmPlan(16, 0), std::invalid_argument);
+  EXPECT_THROW(Spharm::spharm_transform(SphericalSurface(16, 12, 1.0)), std::invalid_argument);
+}
+
+TEST(Spharms, BandLimitedTransform)
+{
+  const natural_t size = 64;
+  const natural_t l_max = 8;
+  const natural_t m_max = 3;
+  SphericalSurface surface(size, size, 0.0);
+  add_spharm(surface, 2, 1, 2.0);
+  add_spharm(surface, 7, 3, 1.0);
+  add_spharm(surface, 8, 5, 1.0);
+  add_spharm(surface, 12, 2, 1.0);
+  const auto full = Spharm::spharm_transform(surface);
+  const auto truncated = Spharm::spharm_transform(surface, l_max, m_max);
+
+  ASSERT_EQ(truncated.l_max(), l_max);
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      const complex_t expected = (m <= m_max) ? full.get(l, m) : complex_t(0, 0);
+      EXPECT_NEAR(std::abs(truncated.get(l, m) - expected), 0.0, 1e-12) << "l: " << l << ", m: " << m;
+    }
+  }
+  EXPECT_NEAR(truncated.get(7, 3).real(), 0.5, 1e-10);
+  EXPECT_EQ(truncated.get(12, 2), complex_t(0, 0));
+}
+
+TEST(Spharms, QuadratureGrids)
+{
+  const natural_t l_max = 10;
+  const std::vector<std::pair<GridType, natural_t>> grids = {
+      {GridType::Equiangular, 2 * (l_max + 1)},
+      {GridType::ClenshawCurtis, 2 * l_max + 1},
+      {GridType::GaussLegendre, l_max + 1}
+  };
+  for (const auto& grid : grids)
+  {
+    SphericalSurface surface(grid.second, 32, 0.0, grid.first);
+    add_spharm(surface, 10, 7, 2.0);
+    add_spharm(surface, 5, 0, 1.0);
+    add_spharm(surface, 3, 2, 1.0);
+    const auto result = Spharm::spharm_transform(surface, l_max);
+    for (natural_t l = 0; l <= l_max; ++l)
+    {
+      for (natural_t m = 0; m <= l; ++m)
+      {
+        real_t expected = 0;
+        if ((l == 10) && (m == 7)) { expected = 1.0; }
+        if ((l == 5) && (m == 0)) { expected = 1.0; }
+        if ((l == 3) && (m == 2)) { expected = 0.5; }
+        EXPECT_NEAR(std::abs(result.get(l, m) - expected), 0.0, 1e-10)
+            << "rows: " << grid.second << ", l: " << l << ", m: " << m;
+      }
+    }
+  }
+}
+
+TEST(Spharms, InverseRoundTrip)
+{
+  const natural_t l_max = 20;
+  const auto harmonics = get_random_harmonics(l_max, 42);
+  const auto surface = Spharm::ispharm_transform(harmonics);
+  EXPECT_EQ(surface.rows(), 64u);
+  EXPECT_EQ(surface.cols(), 64u);
+
+  const auto result = Spharm::spharm_transform(surface, l_max);
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      EXPECT_NEAR(std::abs(result.get(l, m) - harmonics.get(l, m)), 0.0, 1e-12) << "l: " << l << ", m: " << m;
+    }
+  }
+}
+
+TEST(Spharms, FastLegendreTransform)
+{
+  const natural_t l_max = 127;
+  const natural_t size = 256;
+  const auto harmonics = get_random_harmonics(l_max, 42);
+  const SpharmPlan direct_plan(size, size, l_max, l_max, GridType::Equiangular,
+                               {LegendreMethod::Direct, 1e-12, 0});
+  const SpharmPlan fast_plan(size, size, l_max, l_max, GridType::Equiangular,
+                             {LegendreMethod::Fast, 1e-12, 0});
+  EXPECT_EQ(direct_plan.compressed_plm(0, 0), nullptr);
+  ASSERT_NE(fast_plan.compressed_plm(0, 0), nullptr);
+
+  const auto direct_surface = Spharm::ispharm_transform(direct_plan, harmonics);
+  const auto fast_surface = Spharm::ispharm_transform(fast_plan, harmonics);
+  for (natural_t theta_n = 0; theta_n < size; ++theta_n)
+  {
+    for (natural_t psi_m = 0; psi_m < size; ++psi_m)
+    {
+      EXPECT_NEAR(direct_surface.get(theta_n, psi_m), fast_surface.get(theta_n, psi_m), 1e-9);
+    }
+  }
+
+  const auto result = Spharm::spharm_transform(fast_plan, direct_surface);
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      EXPECT_NEAR(std::abs(result.get(l, m) - harmonics.get(l, m)), 0.0, 1e-10) << "l: " << l << ", m: " << m;
+    }
+  }
+}
+
+TEST(Spharms, SinglePrecision)
+{
+  const natural_t l_max = 31;
+  const natural_t size = 64;
+  const auto harmonics = get_random_harmonics(l_max, 42);
+  const auto surface = Spharm::ispharm_transform(harmonics);
+
+  SphericalSurfaceF surface_f(size, size);
+  surface_f.map([&surface](const natural_t theta_n, const natural_t psi_m, const float)
+                {
+                  return static_cast<float>(surface.get(theta_n, psi_m));
+                });
+  const SpharmPlanF plan(size, size, l_max, l_max);
+  const auto result = SpharmF::spharm_transform(plan, surface_f);
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      EXPECT_NEAR(std::abs(complex_t(result.get(l, m)) - harmonics.get(l, m)), 0.0, 1e-4)
+        << "l: " << l << ", m: " << m;
+    }
+  }
+
+  const auto surface_round_trip = SpharmF::ispharm_transform(plan, result);
+  for (natural_t theta_n = 0; theta_n < size; ++theta_n)
+  {
+    for (natural_t psi_m = 0; psi_m < size; ++psi_m)
+    {
+      EXPECT_NEAR(surface_round_trip.get(theta_n, psi_m), surface.get(theta_n, psi_m), 1e-3);
+    }
+  }
+}
+
+TEST(Spharms, StridedView)
+{
+  const natural_t l_max = 15;
+  const natural_t size = 32;
+  const natural_t stride = size + 5;
+  const auto harmonics = get_random_harmonics(l_max, 42);
+  const SpharmPlan plan(size, size, l_max, l_max);
+  const auto surface = Spharm::ispharm_transform(plan, harmonics);
+
+  // Rows padded with garbage which must not be read
+  std::vector<real_t> values(size * stride, 1e6);
+  for (natural_t theta_n = 0; theta_n < size; ++theta_n)
+  {
+    for (natural_t psi_m = 0; psi_m < size; ++psi_m)
+    {
+      values[(theta_n * stride) + psi_m] = surface.get(theta_n, psi_m);
+    }
+  }
+  const SphericalSurfaceView view(values.data(), size, size, stride);
+  EXPECT_EQ(view.get(3, 4), surface.get(3, 4));
+
+  const auto result = Spharm::spharm_transform(plan, view);
+  const auto reference = Spharm::spharm_transform(plan, surface);
+  for (natural_t l = 0; l <= l_max; ++l)
+  {
+    for (natural_t m = 0; m <= l; ++m)
+    {
+      EXPECT_NEAR(std::abs(result.get(l, m) - reference.get(l, m)), 0.0, 1e-12) << "l: " << l << ", m: " << m;
+    }
+  }
+
+  EXPECT_THROW(Spharm::spharm_transform(plan, SphericalSurfaceView(values.data(), size / 2, size, stride)),
+               std::invalid_argument);
+}
@@ -69,4 +69,44 @@ TEST(SphericalSurface, MapFuncRealNMOldValue)
       EXPECT_FLOAT_EQ(surface.get(theta_n, psi_m), 2.0 * (theta_n * psi_m));
     }
   }
-}
\ No newline at end of file
+}
+
+TEST(SphericalSurface, ParallelMapAngles)
+{
+  const natural_t n = 64;
+  const natural_t m = 128;
+  SphericalSurface surface(n, m, 2.0, GridType::GaussLegendre);
+  surface.parallel_map([](const real_t theta, const real_t psi, const real_t old_val) {
+    return old_val * std::cos(theta) * std::sin(psi);
+  });
+
+  const auto thetas = surface.thetas();
+  const auto psis = surface.psis();
+  EXPECT_DOUBLE_EQ(psis[m / 4], M_PI / 2.0);
+  for (natural_t theta_n = 0; theta_n < surface.rows(); ++theta_n)
+  {
+    for (natural_t psi_m = 0; psi_m < surface.cols(); ++psi_m)
+    {
+      EXPECT_DOUBLE_EQ(surface.get(theta_n, psi_m), 2.0 * std::cos(thetas[theta_n]) * std::sin(psis[psi_m]));
+    }
+  }
+}
+
+TEST(SphericalSurface, RowAccess)
+{
+  SphericalSurface surface(4, 8);
+  surface.map([](const natural_t theta_n, const natural_t psi_m, const real_t) {
+    return static_cast<real_t>((10 * theta_n) + psi_m);
+  });
+
+  EXPECT_EQ(surface.values().size(), 32u);
+  EXPECT_EQ(surface.data(), surface.values().data());
+  EXPECT_EQ(surface.row(2), surface.data() + 16);
+  EXPECT_DOUBLE_EQ(surface.row(2)[3], 23.0);
+  surface.row(3)[1] = -1.0;
+  EXPECT_DOUBLE_EQ(surface.get(3, 1), -1.0);
+
+  const auto psi_array = surface.get_psi_array(1);
+  ASSERT_EQ(psi_array.size(), 8u);
+  EXPECT_DOUBLE_EQ(psi_array[5].real(), 15.0);
+}
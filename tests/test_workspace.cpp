@@ -0,0 +1,164 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "spharms.h"
+#include "hyperspharm.h"
+#include "workspace.h"
+#include "gtest/gtest.h"
+
+namespace
+{
+
+std::atomic<bool> count_allocations(false);
+std::atomic<unsigned long> allocation_count(0);
+
+}
+
+// The replacement is linked into the whole test binary: it only counts while count_allocations is set
+// by the measured calls below, and otherwise behaves as the default operator new
+void* operator new(std::size_t size)
+{
+  if (count_allocations) { ++allocation_count; }
+  void* pointer = std::malloc((size == 0) ? 1 : size);
+  if (pointer == nullptr) { throw std::bad_alloc(); }
+  return pointer;
+}
+
+// Not inlined: GCC would otherwise see new expressions paired with free (-Wmismatched-new-delete)
+__attribute__((noinline)) void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+__attribute__((noinline)) void operator delete(void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+using namespace hyperspharm;
+
+TEST(Workspace, BumpAllocation)
+{
+  Workspace workspace(1024);
+  EXPECT_EQ(workspace.capacity(), 1024u);
+  const auto first = workspace.allocate<char>(3);
+  const auto second = workspace.allocate<complex_t>(5);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first) % Workspace::ALIGNMENT, 0u);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(second) % Workspace::ALIGNMENT, 0u);
+  EXPECT_EQ(workspace.used(), Workspace::ALIGNMENT + Workspace::aligned_size(5 * sizeof(complex_t)));
+
+  const natural_t mark = workspace.used();
+  workspace.allocate<real_t>(10);
+  workspace.rewind(mark);
+  EXPECT_EQ(workspace.used(), mark);
+  EXPECT_THROW(workspace.allocate<char>(1024), std::invalid_argument);
+
+  workspace.reset();
+  EXPECT_EQ(workspace.used(), 0u);
+  EXPECT_EQ(workspace.allocate<char>(3), first);
+  workspace.reserve(4096);
+  EXPECT_EQ(workspace.capacity(), 4096u);
+  EXPECT_EQ(workspace.used(), 0u);
+}
+
+TEST(Workspace, SteadyStateTransformsDoNotAllocate)
+{
+  const natural_t l_max = 31;
+  const natural_t size = 64;
+  const LegendreOptions options[] = {{LegendreMethod::Direct, 1e-12, 0}, {LegendreMethod::Fast, 1e-12, 0}};
+  for (const auto& option : options)
+  {
+    const SpharmPlan plan(size, size, l_max, l_max, GridType::Equiangular, option);
+    SphericalHarmonics harmonics(l_max);
+    for (natural_t l = 0; l <= l_max; ++l)
+    {
+      for (natural_t m = 0; m <= l; ++m)
+      {
+        harmonics.set(l, m, {1.0 / (1.0 + l), (m == 0) ? 0.0 : 0.5 / (1.0 + m)});
+      }
+    }
+    const auto reference_surface = Spharm::ispharm_transform(plan, harmonics);
+    const auto reference = Spharm::spharm_transform(plan, reference_surface);
+
+    Workspace workspace(Spharm::required_bytes(plan));
+    // The workspace is not zero-filled: the transforms must not read what they did not write
+    std::memset(workspace.allocate<char>(workspace.capacity()), 0xFF, workspace.capacity());
+    workspace.reset();
+    SphericalSurface surface(size, size);
+    SphericalHarmonics result(l_max);
+    // Warm up (thread pool creation)
+    Spharm::ispharm_transform(plan, harmonics, surface, workspace);
+    Spharm::spharm_transform(plan, surface.view(), result, workspace);
+
+    allocation_count = 0;
+    count_allocations = true;
+    Spharm::ispharm_transform(plan, harmonics, surface, workspace);
+    Spharm::spharm_transform(plan, surface.view(), result, workspace);
+    count_allocations = false;
+    EXPECT_EQ(allocation_count, 0u);
+    EXPECT_EQ(workspace.used(), 0u);
+
+    for (natural_t theta_n = 0; theta_n < size; ++theta_n)
+    {
+      for (natural_t psi_m = 0; psi_m < size; ++psi_m)
+      {
+        EXPECT_EQ(surface.get(theta_n, psi_m), reference_surface.get(theta_n, psi_m));
+      }
+    }
+    for (natural_t l = 0; l <= l_max; ++l)
+    {
+      for (natural_t m = 0; m <= l; ++m)
+      {
+        EXPECT_EQ(result.get(l, m), reference.get(l, m));
+      }
+    }
+  }
+
+  const SpharmPlan plan(size, size, l_max, l_max);
+  Workspace small(Spharm::required_bytes(plan) / 2);
+  SphericalHarmonics result(l_max);
+  const SphericalSurface surface(size, size, 1.0);
+  EXPECT_THROW(Spharm::spharm_transform(plan, surface.view(), result, small), std::invalid_argument);
+}
+
+TEST(Workspace, SteadyStateHyperTransformsDoNotAllocate)
+{
+  const natural_t n_max = 8;
+  const HyperSpharmPlan plan(n_max, 2 * n_max, 2 * n_max, n_max);
+  HyperSphericalCoeffs coeffs(n_max, CoeffsLayout::Tetrahedral);
+  coeffs.map([](natural_t n, natural_t l, natural_t m, complex_t) {
+    return complex_t(1.0 / (1.0 + n + l), (m == 0) ? 0.0 : 0.5 / (1.0 + m));
+  });
+  const auto reference_surface = HyperSpharm::transform(plan, coeffs);
+  const auto reference = HyperSpharm::transform(plan, reference_surface);
+  const auto reference_descriptors = HyperSpharm::descriptors(plan, reference_surface);
+
+  Workspace workspace(HyperSpharm::required_bytes(plan));
+  std::memset(workspace.allocate<char>(workspace.capacity()), 0xFF, workspace.capacity());
+  workspace.reset();
+  HyperSphericalSurface surface(plan.theta_nb(), plan.psi_nb(), plan.phi_nb());
+  HyperSphericalCoeffs result(n_max, CoeffsLayout::Tetrahedral);
+  std::vector<float> descriptors(HyperSpharm::descriptor_size(plan));
+  // Warm up (thread pool creation)
+  HyperSpharm::transform(plan, coeffs, surface, workspace);
+  HyperSpharm::transform(plan, surface.view(), result, workspace);
+  HyperSpharm::descriptors_batch(plan, &surface, 1, descriptors.data(), workspace);
+
+  allocation_count = 0;
+  count_allocations = true;
+  HyperSpharm::transform(plan, coeffs, surface, workspace);
+  HyperSpharm::transform(plan, surface.view(), result, workspace);
+  HyperSpharm::descriptors_batch(plan, &surface, 1, descriptors.data(), workspace);
+  count_allocations = false;
+  EXPECT_EQ(allocation_count, 0u);
+  EXPECT_EQ(workspace.used(), 0u);
+
+  EXPECT_EQ(surface.values(), reference_surface.values());
+  EXPECT_EQ(result.values(), reference.values());
+  EXPECT_EQ(descriptors, reference_descriptors);
+
+  Workspace small(Workspace::ALIGNMENT);
+  EXPECT_THROW(HyperSpharm::transform(plan, surface.view(), result, small), std::invalid_argument);
+}